@@ -3,6 +3,8 @@
 
 #include "gtest/gtest.h"
 #include "common/BitConverter.h"
+#include "common/BitConverterT.h"
+#include <vector>
 
 using namespace common;
 
@@ -56,6 +58,72 @@ namespace
         testToMethods(_msbBc);
     }*/
 
+    static_assert(BigEndianConverter::convert(uint32_t(0x01020304)) == (LittleEndianConverter::SwapsBytes ? 0x01020304u : 0x04030201u),
+        "The conversion is evaluated at compile time.");
+    static_assert(detail::byteSwap64(0x0102030405060708ull) == 0x0807060504030201ull, "64-bit swap.");
+
+    TEST(BitConverterTTests, SingleValues_MatchRuntimeConverter)
+    {
+        BitConverter msb(BitConverter::MostSignificantByte);
+        char buffer[8];
+
+        BigEndianConverter::ToByteArray(int32_t(-123456789), buffer);
+        EXPECT_EQ(-123456789, msb.GetInt32(buffer));
+        EXPECT_EQ('\xF8', buffer[0]);
+        BigEndianConverter::ToByteArray(uint16_t(0xABCD), buffer);
+        EXPECT_EQ(0xABCD, msb.GetUInt16(buffer));
+        BigEndianConverter::ToByteArray(int64_t(-1234567890123ll), buffer);
+        EXPECT_EQ(-1234567890123ll, BigEndianConverter::GetInt64(buffer));
+        BigEndianConverter::ToByteArray(2.5, buffer);
+        EXPECT_EQ(2.5, msb.GetDouble(buffer));
+        LittleEndianConverter::ToByteArray(12345.678f, buffer);
+        EXPECT_EQ(12345.678f, LittleEndianConverter::GetFloat(buffer));
+        EXPECT_EQ(uint8_t(0x3C), BigEndianConverter::GetUInt8("\x3C"));
+    }
+
+    template<typename T>
+    void testArrays(T first)
+    {
+        // every length up to a few vectors, so that both the vector loop and the tail are covered
+        for (size_t count = 0; count < 37; count++)
+        {
+            std::vector<T> values;
+            for (size_t i = 0; i < count; i++)
+            {
+                values.push_back(static_cast<T>(first / static_cast<T>(i + 1)));
+            }
+            std::vector<char> bytes(count * sizeof(T) + 1);
+            BigEndianConverter::ToByteArray(values.data(), count, bytes.data() + 1);
+            std::vector<T> decoded(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                char single[sizeof(T)];
+                BigEndianConverter::ToByteArray(values[i], single);
+                ASSERT_EQ(0, memcmp(single, bytes.data() + 1 + i * sizeof(T), sizeof(T)));
+            }
+            BigEndianConverter::GetArray(bytes.data() + 1, decoded.data(), count);
+            ASSERT_EQ(values, decoded);
+
+            // in place
+            std::vector<T> inPlace(values);
+            BigEndianConverter::ToByteArray(inPlace.data(), count, reinterpret_cast<char*>(inPlace.data()));
+            BigEndianConverter::GetArray(reinterpret_cast<const char*>(inPlace.data()), inPlace.data(), count);
+            ASSERT_EQ(values, inPlace);
+        }
+    }
+
+    TEST(BitConverterTTests, Arrays_MatchSingleValues)
+    {
+        testArrays<int16_t>(-1234);
+        testArrays<uint16_t>(0xA1B2);
+        testArrays<int32_t>(-123456789);
+        testArrays<uint32_t>(0xA1B2C3D4u);
+        testArrays<int64_t>(-1234567890123ll);
+        testArrays<uint64_t>(0xA1B2C3D4E5F60718ull);
+        testArrays<float>(1234.5f);
+        testArrays<double>(-98765.4321);
+    }
+
     void testGetMethods(const BitConverter& bc)
     {
         // unsigned
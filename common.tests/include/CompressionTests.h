@@ -0,0 +1,56 @@
+#ifndef CompressionTests_h__
+#define CompressionTests_h__
+
+#include "gtest/gtest.h"
+#include "common/Compression.h"
+
+using namespace common;
+
+namespace
+{
+    TEST(CompressionTests, Crc32ShouldMatchReferenceValue)
+    {
+        ASSERT_EQ(0xCBF43926u, Compression::crc32("123456789", 9));
+    }
+
+    TEST(CompressionTests, DeflateShouldProduceZlibStream)
+    {
+        QByteArray data = QByteArray("{\"isRunning\":true,\"samplingIntervalMs\":200}").repeated(20);
+
+        auto compressed = Compression::deflate(data);
+
+        ASSERT_LT(compressed.size(), data.size());
+        ASSERT_EQ(0x78, static_cast<quint8>(compressed[0]));
+        // restore the size prefix expected by qUncompress
+        QByteArray prefixed;
+        prefixed.append(char(0)).append(char(0)).append(char(data.size() >> 8)).append(char(data.size() & 0xFF));
+        ASSERT_EQ(data, qUncompress(prefixed + compressed));
+    }
+
+    TEST(CompressionTests, GzipShouldWrapDeflateData)
+    {
+        QByteArray data = QByteArray("{\"isRunning\":true,\"samplingIntervalMs\":200}").repeated(20);
+
+        auto compressed = Compression::gzip(data);
+
+        ASSERT_LT(compressed.size(), data.size());
+        ASSERT_EQ(0x1f, static_cast<quint8>(compressed[0]));
+        ASSERT_EQ(0x8b, static_cast<quint8>(compressed[1]));
+        const uchar* trailer = reinterpret_cast<const uchar*>(compressed.constData() + compressed.size() - 8);
+        quint32 crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (quint32(trailer[3]) << 24);
+        quint32 size = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | (quint32(trailer[7]) << 24);
+        ASSERT_EQ(Compression::crc32(data.constData(), data.size()), crc);
+        ASSERT_EQ(quint32(data.size()), size);
+    }
+
+    TEST(CompressionTests, GzipFromDeflatedShouldMatchGzip)
+    {
+        QByteArray data = QByteArray("{\"isRunning\":true,\"samplingIntervalMs\":200}").repeated(20);
+
+        auto compressed = Compression::gzipFromDeflated(Compression::deflate(data), data);
+
+        ASSERT_EQ(Compression::gzip(data), compressed);
+    }
+}
+
+#endif // CompressionTests_h__
@@ -0,0 +1,77 @@
+#ifndef JsonWriterTests_h__
+#define JsonWriterTests_h__
+
+#include "gtest/gtest.h"
+#include "common/JsonWriter.h"
+#include <limits>
+
+using namespace common;
+
+namespace
+{
+    TEST(JsonWriterTests, ShouldSeparateNestedElements)
+    {
+        QByteArray buffer;
+        JsonWriter writer(buffer);
+
+        writer.beginObject()
+            .field("a", 1)
+            .key("b").beginArray().value(true).value(false).nullValue().beginObject().endObject().endArray()
+            .field("c", "x")
+            .endObject();
+
+        ASSERT_EQ(QByteArray("{\"a\":1,\"b\":[true,false,null,{}],\"c\":\"x\"}"), buffer);
+    }
+
+    TEST(JsonWriterTests, ShouldEscapeStrings)
+    {
+        QByteArray buffer;
+        JsonWriter writer(buffer);
+
+        writer.value("a\"b\\c\nd\te\x01");
+
+        ASSERT_EQ(QByteArray("\"a\\\"b\\\\c\\nd\\te\\u0001\""), buffer);
+    }
+
+    TEST(JsonWriterTests, ShouldWriteQStringAsUtf8)
+    {
+        QByteArray buffer;
+        JsonWriter writer(buffer);
+        QString text = QString::fromUtf8("\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe2\x82\xac \xf0\x9f\x98\x80");
+
+        writer.value(text);
+
+        ASSERT_EQ("\"" + text.toUtf8() + "\"", buffer);
+    }
+
+    TEST(JsonWriterTests, ShouldWriteIntegerLimits)
+    {
+        QByteArray buffer;
+        JsonWriter writer(buffer);
+
+        writer.beginArray()
+            .value(std::numeric_limits<long long>::min())
+            .value(std::numeric_limits<unsigned long long>::max())
+            .value(0)
+            .value(-42)
+            .endArray();
+
+        ASSERT_EQ(QByteArray("[-9223372036854775808,18446744073709551615,0,-42]"), buffer);
+    }
+
+    TEST(JsonWriterTests, ShouldWriteTimeWithMilliseconds)
+    {
+        QByteArray buffer;
+        JsonWriter writer(buffer);
+
+        writer.beginArray()
+            .timeValue(Q_INT64_C(1433425440123))
+            .timeValue(Q_INT64_C(-1))
+            .timeValue(QDateTime())
+            .endArray();
+
+        ASSERT_EQ(QByteArray("[\"2015-06-04T13:44:00.123Z\",\"1969-12-31T23:59:59.999Z\",\"\"]"), buffer);
+    }
+}
+
+#endif // JsonWriterTests_h__
@@ -0,0 +1,152 @@
+#ifndef LoggerTests_h__
+#define LoggerTests_h__
+
+#include "gtest/gtest.h"
+#include "common/Logger.h"
+#include <QtCore>
+#include <thread>
+#include <vector>
+
+using namespace common;
+
+namespace
+{
+    QByteArray readLogFile(const QString& fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    TEST(LoggerTests, Macros_SkipMessagesOfDisabledLevels)
+    {
+        Logger logger;
+        logger.initialize(Warn);
+        int built = 0;
+        auto message = [&built]()
+        {
+            built++;
+            return QString("message %1").arg(built);
+        };
+
+        LOG_TO(logger, ::common::Debug, message());
+        LOG_TO(logger, ::common::Info, message());
+        EXPECT_EQ(0, built);
+        LOG_TO(logger, ::common::Warn, message());
+        EXPECT_EQ(1, built);
+    }
+
+    TEST(LoggerTests, RateLimiter_LetsThroughBurstThenAverageRate)
+    {
+        LogRateLimiter limiter(1, 3);
+        uint64_t suppressed = 0;
+
+        EXPECT_TRUE(limiter.acquire(0, suppressed));
+        EXPECT_TRUE(limiter.acquire(0, suppressed));
+        EXPECT_TRUE(limiter.acquire(100, suppressed));
+        EXPECT_FALSE(limiter.acquire(200, suppressed));
+        EXPECT_FALSE(limiter.acquire(300, suppressed));
+        EXPECT_TRUE(limiter.acquire(1000000, suppressed));
+        EXPECT_EQ(2u, suppressed);
+        EXPECT_FALSE(limiter.acquire(1000001, suppressed));
+        EXPECT_EQ(QString("message (3 similar messages suppressed)"), LogRateLimiter::annotate("message", 3));
+    }
+
+    TEST(LoggerTests, RepeatCollapser_CountsRunsOfIdenticalMessages)
+    {
+        LogRepeatCollapser collapser;
+        LogRepeats repeats;
+
+        EXPECT_TRUE(collapser.add(Debug, "reading", 0, repeats));
+        EXPECT_EQ(0, repeats.count);
+        EXPECT_FALSE(collapser.add(Debug, "reading", 100, repeats));
+        EXPECT_FALSE(collapser.add(Debug, "reading", 200, repeats));
+        EXPECT_EQ(0, repeats.count);
+        EXPECT_TRUE(collapser.add(Info, "reading", 300, repeats));
+        EXPECT_EQ(2, repeats.count);
+        EXPECT_EQ(int(Debug), repeats.level);
+
+        // a long run is reported periodically
+        EXPECT_FALSE(collapser.add(Info, "reading", 300 + LogRepeatCollapser::ReportIntervalMs, repeats));
+        EXPECT_EQ(1, repeats.count);
+        EXPECT_FALSE(collapser.add(Info, "reading", 400 + LogRepeatCollapser::ReportIntervalMs, repeats));
+        EXPECT_EQ(0, repeats.count);
+        EXPECT_EQ(1, collapser.expire(500 + LogRepeatCollapser::ReportIntervalMs, true).count);
+        EXPECT_EQ(0, collapser.expire(600 + LogRepeatCollapser::ReportIntervalMs, true).count);
+    }
+
+    TEST(LoggerTests, Async_CollapsesRepeatedLines)
+    {
+        QTemporaryDir dir;
+        auto fileName = dir.path() + "/gem.log";
+        Logger logger;
+        logger.startAsync(fileName);
+        for (int i = 0; i < 5; i++)
+        {
+            logger.debug("EbDevice is reading pending response messages...");
+        }
+        logger.info("Done.");
+        logger.stopAsync();
+
+        EXPECT_EQ(QByteArray("DEBUG: EbDevice is reading pending response messages...\n"
+            "DEBUG: Last message repeated 4 times.\n"
+            "INFO: Done.\n"), readLogFile(fileName));
+    }
+
+    TEST(LoggerTests, Async_WritesQueuedLinesAndRotatesFile)
+    {
+        QTemporaryDir dir;
+        auto fileName = dir.path() + "/gem.log";
+        Logger logger;
+        logger.initialize(Info);
+        logger.startAsync(fileName, 1000, 2);
+        for (int i = 0; i < 100; i++)
+        {
+            logger.info(QString("message %1").arg(i));
+            if (i % 10 == 9)
+            {
+                logger.flush();
+            }
+        }
+        logger.debug("filtered out");
+        logger.stopAsync();
+
+        auto lines = readLogFile(fileName + ".2") + readLogFile(fileName + ".1") + readLogFile(fileName);
+        EXPECT_TRUE(QFile::exists(fileName + ".1"));
+        EXPECT_FALSE(QFile::exists(fileName + ".3"));
+        EXPECT_TRUE(lines.endsWith("INFO: message 98\nINFO: message 99\n"));
+        EXPECT_FALSE(lines.contains("filtered out"));
+    }
+
+    TEST(LoggerTests, Async_KeepsEveryLineFromConcurrentWriters)
+    {
+        QTemporaryDir dir;
+        auto fileName = dir.path() + "/gem.log";
+        Logger logger;
+        logger.startAsync(fileName);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&logger, t]()
+            {
+                for (int i = 0; i < 10000; i++)
+                {
+                    logger.info(QString("thread %1 line %2").arg(t).arg(i));
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        logger.flush();
+
+        EXPECT_EQ(40000, readLogFile(fileName).count('\n'));
+        logger.stopAsync();
+    }
+}
+
+#endif // LoggerTests_h__
@@ -0,0 +1,62 @@
+#ifndef MetricsTests_h__
+#define MetricsTests_h__
+
+#include "gtest/gtest.h"
+#include "common/Metrics.h"
+#include "common/InvalidOperationException.h"
+#include <string>
+
+using namespace common;
+
+namespace
+{
+    TEST(MetricsTests, HistogramBuckets_CoverValuesWithoutGaps)
+    {
+        for (uint64_t value = 0; value < 100000; value++)
+        {
+            int index = MetricHistogram::bucketIndex(value);
+            ASSERT_LT(value, MetricHistogram::bucketUpperBound(index));
+            if (index > 0)
+            {
+                ASSERT_GE(value, MetricHistogram::bucketUpperBound(index - 1));
+            }
+        }
+        EXPECT_EQ(MetricHistogram::BucketCount - 1, MetricHistogram::bucketIndex(uint64_t(1) << 60));
+    }
+
+    TEST(MetricsTests, HistogramQuantiles_WithinBucketPrecision)
+    {
+        MetricHistogram histogram;
+        for (uint64_t value = 1; value <= 10000; value++)
+        {
+            histogram.record(value);
+        }
+        EXPECT_EQ(10000u, histogram.count());
+        EXPECT_EQ(50005000u, histogram.sum());
+        EXPECT_NEAR(5000.0, double(histogram.quantile(0.5)), 5000 * 0.125);
+        EXPECT_NEAR(9900.0, double(histogram.quantile(0.99)), 9900 * 0.125);
+        EXPECT_EQ(1023u, histogram.countBelow(1024));
+    }
+
+    TEST(MetricsTests, Registry_RendersPrometheusText)
+    {
+        auto& counter = sMetrics.counter("gem_test_items_total", "Test items.");
+        EXPECT_EQ(&counter, &sMetrics.counter("gem_test_items_total", "Test items."));
+        counter.add(3);
+        sMetrics.gauge("gem_test_depth", "Test depth.", "queue=\"a\"").set(-2);
+        sMetrics.histogram("gem_test_duration_seconds", "Test duration.").record(1500);
+
+        QByteArray out;
+        sMetrics.writePrometheus(out);
+        std::string text(out.constData(), out.size());
+
+        EXPECT_NE(std::string::npos, text.find("# TYPE gem_test_items_total counter\ngem_test_items_total 3\n"));
+        EXPECT_NE(std::string::npos, text.find("gem_test_depth{queue=\"a\"} -2\n"));
+        EXPECT_NE(std::string::npos, text.find("gem_test_duration_seconds_bucket{le=\"0.001024\"} 0\n"));
+        EXPECT_NE(std::string::npos, text.find("gem_test_duration_seconds_bucket{le=\"0.004096\"} 1\n"));
+        EXPECT_NE(std::string::npos, text.find("gem_test_duration_seconds_count 1\n"));
+        EXPECT_THROW(sMetrics.gauge("gem_test_items_total", "Test items."), InvalidOperationException);
+    }
+}
+
+#endif // MetricsTests_h__
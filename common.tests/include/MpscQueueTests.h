@@ -0,0 +1,71 @@
+#ifndef MpscQueueTests_h__
+#define MpscQueueTests_h__
+
+#include "gtest/gtest.h"
+#include "common/MpscQueue.h"
+#include <thread>
+#include <vector>
+
+using namespace common;
+
+namespace
+{
+    TEST(MpscQueueTests, SingleThread_PreservesOrder)
+    {
+        MpscQueue<int> queue;
+        int value = 0;
+        EXPECT_TRUE(queue.empty());
+        EXPECT_FALSE(queue.tryDequeue(value));
+        for (int i = 0; i < 10; i++)
+        {
+            queue.enqueue(i);
+        }
+        EXPECT_EQ(10u, queue.size());
+        for (int i = 0; i < 10; i++)
+        {
+            ASSERT_TRUE(queue.tryDequeue(value));
+            EXPECT_EQ(i, value);
+        }
+        EXPECT_FALSE(queue.tryDequeue(value));
+        EXPECT_TRUE(queue.empty());
+    }
+
+    TEST(MpscQueueTests, MultipleProducers_AllItemsDelivered)
+    {
+        const int producersCount = 4;
+        const int itemsPerProducer = 10000;
+        MpscQueue<std::pair<int, int>> queue;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producersCount; p++)
+        {
+            producers.emplace_back([&queue, p]()
+            {
+                for (int i = 0; i < itemsPerProducer; i++)
+                {
+                    queue.enqueue(std::make_pair(p, i));
+                }
+            });
+        }
+
+        // items of each producer must keep their relative order
+        std::vector<int> expectedNext(producersCount, 0);
+        int received = 0;
+        std::pair<int, int> item;
+        while (received < producersCount * itemsPerProducer)
+        {
+            if (queue.tryDequeue(item))
+            {
+                ASSERT_EQ(expectedNext[item.first], item.second);
+                expectedNext[item.first]++;
+                received++;
+            }
+        }
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+        EXPECT_TRUE(queue.empty());
+    }
+}
+
+#endif // MpscQueueTests_h__
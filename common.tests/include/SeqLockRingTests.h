@@ -0,0 +1,156 @@
+#ifndef SeqLockRingTests_h__
+#define SeqLockRingTests_h__
+
+#include "gtest/gtest.h"
+#include "common/SeqLockRing.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+
+using namespace common;
+
+namespace
+{
+    struct RingItem
+    {
+        uint64_t value;
+        uint64_t check;
+    };
+
+    RingItem makeRingItem(uint64_t value)
+    {
+        RingItem item;
+        item.value = value;
+        item.check = ~value;
+        return item;
+    }
+
+    TEST(SeqLockRingTests, ReadSince_ReturnsItemsAfterCursor)
+    {
+        SeqLockRing<RingItem> ring(8);
+        EXPECT_EQ(0u, ring.lastId());
+        for (uint64_t i = 1; i <= 5; i++)
+        {
+            EXPECT_EQ(i, ring.push(makeRingItem(i * 10)));
+        }
+
+        std::vector<uint64_t> ids;
+        auto cursor = ring.readSince(2, [&ids](uint64_t id, const RingItem& item)
+        {
+            EXPECT_EQ(id * 10, item.value);
+            ids.push_back(id);
+        });
+        EXPECT_EQ(5u, cursor);
+        ASSERT_EQ(3u, ids.size());
+        EXPECT_EQ(3u, ids[0]);
+        EXPECT_EQ(5u, ids[2]);
+
+        // nothing new
+        int calls = 0;
+        EXPECT_EQ(5u, ring.readSince(cursor, [&calls](uint64_t, const RingItem&) { calls++; }));
+        EXPECT_EQ(0, calls);
+    }
+
+    TEST(SeqLockRingTests, ReadSince_OverwrittenItemsAreSkipped)
+    {
+        SeqLockRing<RingItem> ring(4);
+        for (uint64_t i = 1; i <= 10; i++)
+        {
+            ring.push(makeRingItem(i));
+        }
+
+        std::vector<uint64_t> ids;
+        auto cursor = ring.readSince(0, [&ids](uint64_t id, const RingItem&) { ids.push_back(id); });
+        EXPECT_EQ(10u, cursor);
+        ASSERT_EQ(4u, ids.size());
+        EXPECT_EQ(7u, ids.front());
+        EXPECT_EQ(10u, ids.back());
+    }
+
+    TEST(SeqLockRingTests, ConcurrentWriters_ReaderSeesEveryItemOnce)
+    {
+        const int writersCount = 4;
+        const int itemsPerWriter = 50000;
+        // nothing is overwritten, so every id must reach the reader however the writes interleave with the reads
+        SeqLockRing<RingItem> ring(writersCount * itemsPerWriter);
+        std::atomic<bool> done(false);
+        std::vector<std::thread> writers;
+        for (int w = 0; w < writersCount; w++)
+        {
+            writers.emplace_back([&ring]()
+            {
+                for (int i = 0; i < itemsPerWriter; i++)
+                {
+                    ring.push(makeRingItem(i));
+                }
+            });
+        }
+
+        uint64_t cursor = 0;
+        uint64_t lastSeenId = 0;
+        uint64_t deliveredCount = 0;
+        bool consistent = true;
+        bool contiguous = true;
+        auto consumer = [&](uint64_t id, const RingItem& item)
+        {
+            consistent = consistent && item.check == ~item.value;
+            contiguous = contiguous && id == lastSeenId + 1;
+            lastSeenId = id;
+            deliveredCount++;
+        };
+        while (!done)
+        {
+            cursor = ring.readSince(cursor, consumer);
+            done = cursor == uint64_t(writersCount * itemsPerWriter);
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        EXPECT_TRUE(consistent);
+        EXPECT_TRUE(contiguous);
+        EXPECT_EQ(uint64_t(writersCount * itemsPerWriter), deliveredCount);
+        EXPECT_EQ(uint64_t(writersCount * itemsPerWriter), ring.lastId());
+    }
+
+    TEST(SeqLockRingTests, ConcurrentWriters_LappedReaderSeesConsistentItems)
+    {
+        const int writersCount = 4;
+        const int itemsPerWriter = 50000;
+        SeqLockRing<RingItem> ring(1024);
+        std::vector<std::thread> writers;
+        for (int w = 0; w < writersCount; w++)
+        {
+            writers.emplace_back([&ring]()
+            {
+                for (int i = 0; i < itemsPerWriter; i++)
+                {
+                    ring.push(makeRingItem(i));
+                }
+            });
+        }
+
+        uint64_t cursor = 0;
+        uint64_t lastSeenId = 0;
+        bool consistent = true;
+        bool ordered = true;
+        auto consumer = [&](uint64_t id, const RingItem& item)
+        {
+            consistent = consistent && item.check == ~item.value;
+            ordered = ordered && id > lastSeenId;
+            lastSeenId = id;
+        };
+        while (cursor != uint64_t(writersCount * itemsPerWriter))
+        {
+            cursor = ring.readSince(cursor, consumer);
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        EXPECT_TRUE(consistent);
+        EXPECT_TRUE(ordered);
+    }
+}
+
+#endif // SeqLockRingTests_h__
@@ -0,0 +1,59 @@
+#ifndef TracerTests_h__
+#define TracerTests_h__
+
+#include "gtest/gtest.h"
+#include "common/Tracer.h"
+#include <string>
+#include <thread>
+
+using namespace common;
+
+namespace
+{
+    TEST(TracerTests, Spans_DumpedAsChromeTraceEvents)
+    {
+        std::thread thread([]()
+        {
+            sTracer.threadName("tracer test");
+            TraceSpan outer("TracerTests outer");
+            TraceSpan inner("TracerTests inner");
+        });
+        thread.join();
+
+        QByteArray out;
+        sTracer.writeChromeTrace(out);
+        std::string trace(out.constData(), out.size());
+
+        EXPECT_EQ(0u, trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+        EXPECT_NE(std::string::npos, trace.find("{\"name\":\"thread_name\",\"ph\":\"M\""));
+        EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"tracer test\"}"));
+        // the inner span ends first
+        auto inner = trace.find("{\"name\":\"TracerTests inner\",\"cat\":\"gem\",\"ph\":\"X\",\"ts\":");
+        auto outer = trace.find("{\"name\":\"TracerTests outer\",\"cat\":\"gem\",\"ph\":\"X\",\"ts\":");
+        ASSERT_NE(std::string::npos, inner);
+        ASSERT_NE(std::string::npos, outer);
+        EXPECT_LT(inner, outer);
+        EXPECT_EQ("]}", trace.substr(trace.size() - 2));
+    }
+
+    TEST(TracerTests, ThreadRing_KeepsLatestSpans)
+    {
+        std::thread thread([]()
+        {
+            for (size_t i = 0; i < Tracer::ThreadCapacity + 10; i++)
+            {
+                sTracer.record(i == 0 ? "TracerTests first" : "TracerTests next", i, 1);
+            }
+        });
+        thread.join();
+
+        QByteArray out;
+        sTracer.writeChromeTrace(out);
+        std::string trace(out.constData(), out.size());
+
+        EXPECT_EQ(std::string::npos, trace.find("TracerTests first"));
+        EXPECT_NE(std::string::npos, trace.find("{\"name\":\"TracerTests next\",\"cat\":\"gem\",\"ph\":\"X\",\"ts\":16393,\"dur\":1,"));
+    }
+}
+
+#endif // TracerTests_h__
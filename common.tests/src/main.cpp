@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "BitConverterTests.h"
+#include "CompressionTests.h"
+#include "JsonWriterTests.h"
+#include "LoggerTests.h"
+#include "MetricsTests.h"
+#include "MpscQueueTests.h"
+#include "SeqLockRingTests.h"
+#include "TracerTests.h"
 #include "common/Connection.h"
 
 #include <QtCore>
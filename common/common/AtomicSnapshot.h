@@ -0,0 +1,48 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   AtomicSnapshot.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // RCU-style holder of an immutable value: writers publish a new instance with an atomic pointer swap,
+    // readers get a reference-counted pointer to whichever instance was current and never block the writer.
+    // The old instance is released when the last reader drops it.
+    template<typename T>
+    class AtomicSnapshot : boost::noncopyable
+    {
+    public:
+        typedef std::shared_ptr<const T> Ptr_t;
+
+        AtomicSnapshot() : _value(std::make_shared<T>())
+        {
+        }
+
+        explicit AtomicSnapshot(Ptr_t initial) : _value(initial)
+        {
+        }
+
+        Ptr_t load() const
+        {
+            return std::atomic_load(&_value);
+        }
+
+        void store(Ptr_t value)
+        {
+            std::atomic_store(&_value, value);
+        }
+
+    private:
+        Ptr_t _value;
+    };
+}
@@ -0,0 +1,165 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   BitConverterT.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "BitConverter.h"
+#include <cstddef>
+#include <cstring>
+
+namespace common
+{
+    namespace detail
+    {
+        constexpr uint16_t byteSwap16(uint16_t x)
+        {
+            return static_cast<uint16_t>(x >> 8 | x << 8);
+        }
+
+        constexpr uint32_t byteSwap32(uint32_t x)
+        {
+            return x >> 24 | (x << 8 & 0x00FF0000u) | (x >> 8 & 0x0000FF00u) | x << 24;
+        }
+
+        constexpr uint64_t byteSwap64(uint64_t x)
+        {
+            return static_cast<uint64_t>(byteSwap32(static_cast<uint32_t>(x))) << 32 | byteSwap32(static_cast<uint32_t>(x >> 32));
+        }
+
+        // Copy count elements with the bytes of each one reversed, 16 bytes at a time with SSE2.
+        // src and dst are either the same buffer or do not overlap, no alignment is required.
+        void byteSwapArray16(const void* src, void* dst, size_t count);
+        void byteSwapArray32(const void* src, void* dst, size_t count);
+        void byteSwapArray64(const void* src, void* dst, size_t count);
+    }
+
+    // Compile-time counterpart of BitConverter for data in the given byte order: whether the bytes are swapped is
+    // known at compile time, the single-value conversions are constexpr and the values are read and written with
+    // memcpy, so there are neither alignment nor aliasing issues. The array methods convert a whole buffer in one pass.
+    template<BitConverter::EByteOrder ByteOrder>
+    class BitConverterT
+    {
+    public:
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        static const BitConverter::EByteOrder MachineByteOrder = BitConverter::MostSignificantByte;
+#else
+        static const BitConverter::EByteOrder MachineByteOrder = BitConverter::LeastSignificantByte;
+#endif
+        static const bool SwapsBytes = ByteOrder != MachineByteOrder;
+
+        // Machine order <-> ByteOrder, the conversion is symmetric.
+        static constexpr uint8_t convert(uint8_t value) { return value; }
+        static constexpr int8_t convert(int8_t value) { return value; }
+        static constexpr uint16_t convert(uint16_t value) { return SwapsBytes ? detail::byteSwap16(value) : value; }
+        static constexpr uint32_t convert(uint32_t value) { return SwapsBytes ? detail::byteSwap32(value) : value; }
+        static constexpr uint64_t convert(uint64_t value) { return SwapsBytes ? detail::byteSwap64(value) : value; }
+        static constexpr int16_t convert(int16_t value) { return static_cast<int16_t>(convert(static_cast<uint16_t>(value))); }
+        static constexpr int32_t convert(int32_t value) { return static_cast<int32_t>(convert(static_cast<uint32_t>(value))); }
+        static constexpr int64_t convert(int64_t value) { return static_cast<int64_t>(convert(static_cast<uint64_t>(value))); }
+
+        static uint8_t GetUInt8(const char* data) { return get<uint8_t>(data); }
+        static uint16_t GetUInt16(const char* data) { return get<uint16_t>(data); }
+        static uint32_t GetUInt32(const char* data) { return get<uint32_t>(data); }
+        static uint64_t GetUInt64(const char* data) { return get<uint64_t>(data); }
+        static int8_t GetInt8(const char* data) { return get<int8_t>(data); }
+        static int16_t GetInt16(const char* data) { return get<int16_t>(data); }
+        static int32_t GetInt32(const char* data) { return get<int32_t>(data); }
+        static int64_t GetInt64(const char* data) { return get<int64_t>(data); }
+
+        static float GetFloat(const char* data)
+        {
+            uint32_t bits = get<uint32_t>(data);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        static double GetDouble(const char* data)
+        {
+            uint64_t bits = get<uint64_t>(data);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        static void ToByteArray(uint8_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(uint16_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(uint32_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(uint64_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(int8_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(int16_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(int32_t value, char* dst) { put(value, dst); }
+        static void ToByteArray(int64_t value, char* dst) { put(value, dst); }
+
+        static void ToByteArray(float value, char* dst)
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            put(bits, dst);
+        }
+
+        static void ToByteArray(double value, char* dst)
+        {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            put(bits, dst);
+        }
+
+        // count values from data into values. data and values are either the same buffer or do not overlap.
+        static void GetArray(const char* data, uint16_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray16); }
+        static void GetArray(const char* data, int16_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray16); }
+        static void GetArray(const char* data, uint32_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void GetArray(const char* data, int32_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void GetArray(const char* data, float* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void GetArray(const char* data, uint64_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray64); }
+        static void GetArray(const char* data, int64_t* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray64); }
+        static void GetArray(const char* data, double* values, size_t count) { copyArray(data, values, count, sizeof(*values), &detail::byteSwapArray64); }
+
+        // count values into dst, same overlap rules.
+        static void ToByteArray(const uint16_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray16); }
+        static void ToByteArray(const int16_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray16); }
+        static void ToByteArray(const uint32_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void ToByteArray(const int32_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void ToByteArray(const float* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray32); }
+        static void ToByteArray(const uint64_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray64); }
+        static void ToByteArray(const int64_t* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray64); }
+        static void ToByteArray(const double* values, size_t count, char* dst) { copyArray(values, dst, count, sizeof(*values), &detail::byteSwapArray64); }
+    private:
+        template<typename T>
+        static T get(const char* data)
+        {
+            T value;
+            memcpy(&value, data, sizeof(value));
+            return convert(value);
+        }
+
+        template<typename T>
+        static void put(T value, char* dst)
+        {
+            value = convert(value);
+            memcpy(dst, &value, sizeof(value));
+        }
+
+        static void copyArray(const void* src, void* dst, size_t count, size_t size, void (*byteSwapArray)(const void*, void*, size_t))
+        {
+            if (SwapsBytes)
+            {
+                byteSwapArray(src, dst, count);
+            }
+            else if (src != dst)
+            {
+                memcpy(dst, src, count * size);
+            }
+        }
+    };
+
+    // Network order, e.g. the GSM-19 serial protocol
+    typedef BitConverterT<BitConverter::MostSignificantByte> BigEndianConverter;
+    typedef BitConverterT<BitConverter::LeastSignificantByte> LittleEndianConverter;
+}
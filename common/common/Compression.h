@@ -0,0 +1,29 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   Compression.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <QtCore/QByteArray>
+
+namespace common
+{
+    // HTTP content codings on top of the zlib bundled with Qt (qCompress).
+    class Compression
+    {
+    public:
+        // zlib stream (RFC 1950), which is what HTTP calls "deflate".
+        static QByteArray deflate(const QByteArray& data, int level = 6);
+        // Single gzip member (RFC 1952).
+        static QByteArray gzip(const QByteArray& data, int level = 6);
+        // The same gzip member built from deflate(data) computed before, without compressing data again.
+        static QByteArray gzipFromDeflated(const QByteArray& deflated, const QByteArray& data);
+
+        static quint32 crc32(const char* data, int size, quint32 crc = 0);
+    };
+}
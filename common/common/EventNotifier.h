@@ -0,0 +1,49 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   EventNotifier.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <boost/utility.hpp>
+#ifndef __linux__
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace common
+{
+    // Level-triggered cross-thread wakeup. On Linux it is backed by an eventfd so that
+    // the consumer can multiplex it with other descriptors via poll(); elsewhere fd() is -1
+    // and the consumer must use wait().
+    class EventNotifier : boost::noncopyable
+    {
+    public:
+        EventNotifier();
+        ~EventNotifier();
+
+        // Any thread. Cheap and never blocks.
+        void notify();
+        // Consumer thread. Clears the pending notification.
+        void reset();
+        // Consumer thread. Returns true if notified before the timeout expired (timeoutMs < 0 waits forever).
+        bool wait(int timeoutMs);
+
+        int fd() const
+        {
+            return _fd;
+        }
+
+    private:
+        int _fd;
+#ifndef __linux__
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _signaled;
+#endif
+    };
+}
@@ -0,0 +1,76 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   JsonWriter.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+#include <boost/utility.hpp>
+#include <cstdint>
+
+namespace common
+{
+    // Streaming writer of compact JSON, appends to the given buffer without building an intermediate tree.
+    // Commas are inserted automatically; nesting is limited to 64 levels. Reusing the same buffer (cleared with
+    // resize(0) after reserve()) keeps the hot paths free of allocations.
+    class JsonWriter : boost::noncopyable
+    {
+    public:
+        explicit JsonWriter(QByteArray& buffer);
+
+        JsonWriter& beginObject();
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& endArray();
+
+        // Keys are expected to be ASCII literals and are written without escaping.
+        JsonWriter& key(const char* name);
+
+        JsonWriter& value(bool value);
+        JsonWriter& value(int value);
+        JsonWriter& value(unsigned int value);
+        JsonWriter& value(long value);
+        JsonWriter& value(unsigned long value);
+        JsonWriter& value(long long value);
+        JsonWriter& value(unsigned long long value);
+        JsonWriter& value(double value);
+        // UTF-8
+        JsonWriter& value(const char* value);
+        JsonWriter& value(const char* value, int size);
+        JsonWriter& value(const QString& value);
+        JsonWriter& nullValue();
+
+        // ISO 8601 in UTC with milliseconds, e.g. "2015-06-04T13:44:00.123Z".
+        JsonWriter& timeValue(qint64 msSinceEpoch);
+        // Same as Helpers::toISODateWithMilliseconds() for UTC times, an empty string for an invalid time.
+        JsonWriter& timeValue(const QDateTime& time);
+
+        template<typename T>
+        JsonWriter& field(const char* name, const T& fieldValue)
+        {
+            key(name);
+            return value(fieldValue);
+        }
+
+        QByteArray& buffer() { return _buffer; }
+    private:
+        void separate();
+        void begin(char bracket);
+        void end(char bracket);
+        void writeUnsigned(unsigned long long value, bool negative);
+        void writeEscaped(const char* value, int size);
+
+        QByteArray& _buffer;
+        // bit N is set when the container at depth N already has an element
+        uint64_t _hasElements;
+        int _depth;
+        bool _afterKey;
+    };
+}
@@ -0,0 +1,72 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   LogRateLimiter.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <QtCore/QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // Token bucket of one log call site (see LOG_LIMITED_TO): lets through burst messages at once and perSecond
+    // on average. Kept as the theoretical arrival time of the next message (GCRA), so acquire() is a single CAS.
+    class LogRateLimiter : boost::noncopyable
+    {
+    public:
+        LogRateLimiter(double perSecond, int burst)
+            : _intervalUs(static_cast<int64_t>(1000000 / perSecond)), _toleranceUs(_intervalUs * (burst > 1 ? burst - 1 : 0)),
+            _nextUs(0), _suppressed(0)
+        {
+        }
+
+        // True if the message may be written, suppressed then receives the count of the messages dropped since the last one.
+        bool acquire(uint64_t& suppressed)
+        {
+            return acquire(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(),
+                suppressed);
+        }
+
+        bool acquire(int64_t nowUs, uint64_t& suppressed)
+        {
+            int64_t next = _nextUs.load(std::memory_order_relaxed);
+            while (true)
+            {
+                int64_t base = next > nowUs ? next : nowUs;
+                if (base - nowUs > _toleranceUs)
+                {
+                    _suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                if (_nextUs.compare_exchange_weak(next, base + _intervalUs, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        static QString annotate(const QString& message, uint64_t suppressed)
+        {
+            if (suppressed == 0)
+            {
+                return message;
+            }
+            return QString("%1 (%2 similar messages suppressed)").arg(message).arg(suppressed);
+        }
+    private:
+        const int64_t _intervalUs;
+        const int64_t _toleranceUs;
+        std::atomic<int64_t> _nextUs;
+        std::atomic<uint64_t> _suppressed;
+    };
+}
@@ -0,0 +1,55 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   LogRepeatCollapser.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace common
+{
+    struct LogRepeats
+    {
+        // 0 - nothing to report
+        int count;
+        // level of the repeated message
+        int level;
+    };
+
+    // Collapses runs of identical messages, like syslog: the first message is written, its repeats are only
+    // counted and reported as "Last message repeated N times." once a different message comes, or every
+    // ReportIntervalMs while the run goes on. Not thread-safe.
+    class LogRepeatCollapser
+    {
+    public:
+        static const qint64 ReportIntervalMs = 30000;
+
+        LogRepeatCollapser() : _lastLevel(-1), _count(0), _reportedMs(0)
+        {
+        }
+
+        // True if the message has to be written. repeats receives the repeats to report before it.
+        bool add(int level, const QByteArray& message, qint64 nowMs, LogRepeats& repeats);
+
+        // The repeats of a run that has not been reported for ReportIntervalMs (of any run if force is set).
+        LogRepeats expire(qint64 nowMs, bool force = false);
+
+        static QString repeatedMessage(int count)
+        {
+            return QString("Last message repeated %1 times.").arg(count);
+        }
+    private:
+        LogRepeats take(qint64 nowMs);
+
+        int _lastLevel;
+        QByteArray _lastMessage;
+        int _count;
+        qint64 _reportedMs;
+    };
+}
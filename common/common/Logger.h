@@ -2,10 +2,20 @@
 #define Logger_h__
 
 #include "Singleton.h"
+#include "MpscQueue.h"
+#include "EventNotifier.h"
+#include "LogRateLimiter.h"
+#include "LogRepeatCollapser.h"
 #include <boost/utility.hpp>
 //#include <log4cxx/logger.h>
 //#include <log4cxx/log4cxx.h>
 #include <QtCore/QString>
+#include <QtCore/QByteArray>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
 namespace common
 {
@@ -19,6 +29,10 @@ namespace common
         Fatal = 0
     };
 
+    // Writes "LEVEL: message" lines to stderr. Synchronous until startAsync() is called: then the callers only
+    // format the line and push it into a lock-free queue, and a background thread writes the queued lines in
+    // batches, at least every FlushIntervalMs, right away for errors or once BatchSize lines are queued.
+    // Runs of identical lines are collapsed into "Last message repeated N times." (LogRepeatCollapser).
     class Logger : boost::noncopyable
     {
         SINGLETON_BLOCK(Logger)
@@ -27,12 +41,28 @@ namespace common
 
         int logLevel;
     public:
-        Logger()
+        static const int FlushIntervalMs = 100;
+        static const size_t BatchSize = 256;
+        // lines above it are dropped (and counted) rather than growing the queue without bound
+        static const size_t MaxQueuedEntries = 100000;
+
+        Logger();
+        ~Logger();
+
+        void initialize(LogLevel logLevel);
+
+        bool enabled(LogLevel logLevel) const
         {
-            logLevel = LogLevel::Debug;
+            return this->logLevel >= logLevel;
         }
 
-        void initialize(LogLevel logLevel);
+        // Starts the writer thread. An empty fileName writes to stderr, otherwise the lines are appended to the file,
+        // which is rotated to fileName.1 ... fileName.<maxFiles> once it exceeds maxFileSize bytes (0 - never).
+        void startAsync(const QString& fileName = QString(), qint64 maxFileSize = 0, int maxFiles = 0);
+        // Writes what is queued and stops the writer thread, the logger is synchronous again.
+        void stopAsync();
+        // Blocks until the lines written so far have reached the output.
+        void flush();
 
         void debug(const QString& message);
         void trace(const QString& message);
@@ -41,9 +71,92 @@ namespace common
         void error(const QString& message);
         void fatal(const QString& message);
         void write(LogLevel logLevel, const QString& message);
+
+        static const char* levelName(LogLevel logLevel);
+    private:
+        struct Entry
+        {
+            int level;
+            QByteArray line;
+        };
+
+        void run();
+        void collapse(const Entry& entry, qint64 nowMs, QByteArray& batch);
+        void appendRepeats(const LogRepeats& repeats, QByteArray& batch);
+        void writeBatch(const QByteArray& batch);
+        void openFile();
+        void rotateFile();
+
+        std::atomic<bool> _async;
+        // callers between reading _async set and having queued their line, stopAsync() waits for them
+        std::atomic<int> _queueingWriters;
+        std::atomic<bool> _stopping;
+        std::atomic<bool> _wakeupPending;
+        std::atomic<uint64_t> _enqueuedCount;
+        std::atomic<uint64_t> _droppedCount;
+        MpscQueue<Entry> _queue;
+        EventNotifier _wakeup;
+        std::thread _thread;
+
+        // always under _syncMutex: the callers writing synchronously can overlap the writer thread or the last drain
+        // while the logger is switched between synchronous and asynchronous
+        LogRepeatCollapser _repeats;
+        std::mutex _syncMutex;
+
+        // written by the writer thread
+        std::mutex _writtenMutex;
+        std::condition_variable _written;
+        uint64_t _writtenCount;
+
+        // owned by the writer thread while it runs
+        QString _fileName;
+        qint64 _maxFileSize;
+        int _maxFiles;
+        std::FILE* _file;
+        qint64 _fileSize;
     };
 }
 
 #define sLogger SINGLETON_INSTANCE(::common::Logger)
 
+// Least severe level (a common::LogLevel value) the logging macros are compiled in for. Release builds set it to Info
+// (see GEM_LOG_MIN_LEVEL in CMakeLists.txt), which removes the trace and debug calls along with their arguments.
+#ifndef GEM_LOG_MIN_LEVEL
+#define GEM_LOG_MIN_LEVEL 5
+#endif
+
+#define LOG_COMPILED(level) ((level) <= GEM_LOG_MIN_LEVEL)
+
+// The message expression is evaluated only if the level is compiled in and the logger takes it at runtime.
+// logger is anything with enabled(level) and write(level, message).
+#define LOG_TO(logger, level, message) \
+    do { if (LOG_COMPILED(level) && (logger).enabled(level)) { (logger).write((level), (message)); } } while (false)
+
+#define LOG_DEBUG(message) LOG_TO(sLogger, ::common::Debug, message)
+#define LOG_TRACE(message) LOG_TO(sLogger, ::common::Trace, message)
+#define LOG_INFO(message) LOG_TO(sLogger, ::common::Info, message)
+#define LOG_WARN(message) LOG_TO(sLogger, ::common::Warn, message)
+#define LOG_ERROR(message) LOG_TO(sLogger, ::common::Error, message)
+#define LOG_FATAL(message) LOG_TO(sLogger, ::common::Fatal, message)
+
+// Same inside the member functions of a class with logEnabled(level) and log(level, message).
+#define LOG_MEMBER(level, message) \
+    do { if (LOG_COMPILED(level) && logEnabled(level)) { log((level), (message)); } } while (false)
+
+// Rate-limited variants for the messages of the acquisition loop: each call site lets through burst messages
+// at once and perSecond on average, the next message that passes tells how many have been suppressed.
+#define LOG_LIMITED_TO(logger, level, perSecond, burst, message) \
+    do { if (LOG_COMPILED(level) && (logger).enabled(level)) { \
+        static ::common::LogRateLimiter logRateLimiter_((perSecond), (burst)); \
+        uint64_t logSuppressed_; \
+        if (logRateLimiter_.acquire(logSuppressed_)) { (logger).write((level), ::common::LogRateLimiter::annotate((message), logSuppressed_)); } \
+    } } while (false)
+
+#define LOG_MEMBER_LIMITED(level, perSecond, burst, message) \
+    do { if (LOG_COMPILED(level) && logEnabled(level)) { \
+        static ::common::LogRateLimiter logRateLimiter_((perSecond), (burst)); \
+        uint64_t logSuppressed_; \
+        if (logRateLimiter_.acquire(logSuppressed_)) { log((level), ::common::LogRateLimiter::annotate((message), logSuppressed_)); } \
+    } } while (false)
+
 #endif // Logger_h__
@@ -0,0 +1,173 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   Metrics.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "Singleton.h"
+#include <QtCore/QByteArray>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // Monotonic count, updated lock-free from any thread.
+    class MetricCounter : boost::noncopyable
+    {
+    public:
+        MetricCounter() : _value(0)
+        {
+        }
+
+        void add(uint64_t count = 1)
+        {
+            _value.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+    private:
+        std::atomic<uint64_t> _value;
+    };
+
+    // Current level (queue depth, cache size), updated lock-free from any thread.
+    class MetricGauge : boost::noncopyable
+    {
+    public:
+        MetricGauge() : _value(0)
+        {
+        }
+
+        void set(int64_t value)
+        {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        void add(int64_t delta)
+        {
+            _value.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        int64_t value() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+    private:
+        std::atomic<int64_t> _value;
+    };
+
+    // Distribution of non-negative integer values (microseconds by default) in HDR-style log-linear buckets:
+    // values below 8 are counted exactly, every further power of two is split into 8 buckets, so a quantile is
+    // off by at most 12.5%. Values above 2^40 fall into the last bucket. record() is lock-free, a snapshot taken
+    // while values are recorded may be off by the values in flight.
+    class MetricHistogram : boost::noncopyable
+    {
+    public:
+        static const int SubBucketBits = 3;
+        static const int SubBucketCount = 1 << SubBucketBits;
+        static const int MaxValueBits = 40;
+        static const int BucketCount = (MaxValueBits - SubBucketBits + 2) * SubBucketCount;
+
+        // unit converts a recorded value to the exported one, e.g. 1e-6 for microseconds exported as seconds.
+        explicit MetricHistogram(double unit = 1e-6);
+
+        void record(uint64_t value)
+        {
+            _buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        uint64_t count() const
+        {
+            return _count.load(std::memory_order_relaxed);
+        }
+
+        uint64_t sum() const
+        {
+            return _sum.load(std::memory_order_relaxed);
+        }
+
+        double unit() const
+        {
+            return _unit;
+        }
+
+        // Upper bound (in recorded units) of the bucket that holds the q-th quantile, 0 if nothing is recorded.
+        uint64_t quantile(double q) const;
+
+        // Recorded values < bound, exact when bound is a power of two.
+        uint64_t countBelow(uint64_t bound) const;
+
+        static int bucketIndex(uint64_t value);
+        // Exclusive upper bound of the values counted in the bucket.
+        static uint64_t bucketUpperBound(int index);
+    private:
+        double _unit;
+        std::atomic<uint64_t> _count;
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _buckets[BucketCount];
+    };
+
+    // Process-wide registry of the metrics, rendered in the Prometheus text format (version 0.0.4).
+    // Metrics are looked up once (usually into a function-local static reference) and never removed,
+    // the hot paths only touch the atomics. Names follow the Prometheus conventions (gem_..._total, ..._seconds),
+    // labels are given preformatted: route="GET api/status".
+    class Metrics : boost::noncopyable
+    {
+        SINGLETON_BLOCK(Metrics)
+    public:
+        Metrics()
+        {
+        }
+
+        // Thread-safe, returns the same metric for the same name and labels.
+        MetricCounter& counter(const char* name, const char* help, const std::string& labels = std::string());
+        MetricGauge& gauge(const char* name, const char* help, const std::string& labels = std::string());
+        MetricHistogram& histogram(const char* name, const char* help, const std::string& labels = std::string(), double unit = 1e-6);
+
+        void writePrometheus(QByteArray& out) const;
+    private:
+        enum Type
+        {
+            CounterType,
+            GaugeType,
+            HistogramType
+        };
+
+        struct Series
+        {
+            std::string labels;
+            std::unique_ptr<MetricCounter> counter;
+            std::unique_ptr<MetricGauge> gauge;
+            std::unique_ptr<MetricHistogram> histogram;
+        };
+
+        struct Family
+        {
+            Type type;
+            std::string help;
+            std::vector<std::unique_ptr<Series>> series;
+        };
+
+        Series& series(const char* name, const char* help, Type type, const std::string& labels, double unit);
+
+        mutable std::mutex _mutex;
+        std::map<std::string, Family> _families;
+    };
+}
+
+#define sMetrics SINGLETON_INSTANCE(::common::Metrics)
@@ -0,0 +1,94 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   MpscQueue.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // Unbounded lock-free multi-producer single-consumer queue (D. Vyukov's algorithm).
+    // enqueue() may be called from any thread, tryDequeue() only from the owning consumer thread.
+    template<typename T>
+    class MpscQueue : boost::noncopyable
+    {
+    public:
+        MpscQueue() : _head(new Node()), _size(0)
+        {
+            _tail = _head.load(std::memory_order_relaxed);
+        }
+
+        ~MpscQueue()
+        {
+            while (_tail)
+            {
+                Node* next = _tail->next.load(std::memory_order_relaxed);
+                delete _tail;
+                _tail = next;
+            }
+        }
+
+        void enqueue(T value)
+        {
+            Node* node = new Node(std::move(value));
+            _size.fetch_add(1, std::memory_order_relaxed);
+            Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        bool tryDequeue(T& value)
+        {
+            Node* tail = _tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+            {
+                return false;
+            }
+            value = std::move(next->value);
+            next->value = T();
+            _tail = next;
+            delete tail;
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Approximate while producers are active.
+        size_t size() const
+        {
+            return _size.load(std::memory_order_relaxed);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+        struct Node
+        {
+            Node() : value(), next(nullptr)
+            {
+            }
+
+            explicit Node(T&& v) : value(std::move(v)), next(nullptr)
+            {
+            }
+
+            T value;
+            std::atomic<Node*> next;
+        };
+
+        std::atomic<Node*> _head;
+        Node* _tail;
+        std::atomic<size_t> _size;
+    };
+}
@@ -0,0 +1,133 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SeqLockRing.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // Fixed-capacity preallocated ring for any number of writers and readers.
+    // Every pushed item gets a monotonically increasing id (starting from 1), the slot for id is (id % capacity).
+    // Each slot is guarded by its own sequence counter (seqlock): readers copy the slot and then verify that
+    // the sequence did not change, so they never block writers. Items overwritten while being read are skipped.
+    template<typename T>
+    class SeqLockRing : boost::noncopyable
+    {
+        static_assert(std::is_trivial<T>::value, "SeqLockRing items are copied as raw memory.");
+    public:
+        explicit SeqLockRing(size_t capacity) : _slots(capacity), _nextId(1)
+        {
+            for (auto& slot : _slots)
+            {
+                slot.sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        size_t capacity() const
+        {
+            return _slots.size();
+        }
+
+        // Id of the last item that has been started to be written (0 if none).
+        uint64_t lastId() const
+        {
+            return _nextId.load(std::memory_order_acquire) - 1;
+        }
+
+        uint64_t push(const T& value)
+        {
+            uint64_t id = _nextId.fetch_add(1, std::memory_order_acq_rel);
+            Slot& slot = _slots[id % _slots.size()];
+            // sequence == 2 * id when the slot holds a complete item, 2 * id + 1 while the item is being written.
+            uint64_t current = slot.sequence.load(std::memory_order_relaxed);
+            while (true)
+            {
+                if (current & 1)
+                {
+                    // A lapped writer is still copying into this slot: wait for it, it is a short memcpy.
+                    current = slot.sequence.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (current / 2 > id)
+                {
+                    // A newer item has already taken the slot, ours is lost as if it had been overwritten.
+                    return id;
+                }
+                if (slot.sequence.compare_exchange_weak(current, 2 * id + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&slot.value, &value, sizeof(T));
+            slot.sequence.store(2 * id, std::memory_order_release);
+            return id;
+        }
+
+        // Calls consumer(id, item) for every available item with id > afterId, oldest first.
+        // Stops before the first item that is not written yet or still being written, the next call starts from it.
+        // Returns the cursor for the next call.
+        template<typename Consumer>
+        uint64_t readSince(uint64_t afterId, Consumer consumer) const
+        {
+            uint64_t last = lastId();
+            uint64_t id = afterId + 1;
+            if (last >= _slots.size() && id <= last - _slots.size())
+            {
+                id = last - _slots.size() + 1;
+            }
+            uint64_t cursor = afterId;
+            T copy;
+            for (; id <= last; id++)
+            {
+                const Slot& slot = _slots[id % _slots.size()];
+                uint64_t before = slot.sequence.load(std::memory_order_acquire);
+                if (before == 2 * id)
+                {
+                    std::memcpy(&copy, &slot.value, sizeof(T));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+                    if (after == before)
+                    {
+                        consumer(id, copy);
+                        cursor = id;
+                        continue;
+                    }
+                    // torn copy: only a newer item replaces a complete one, the slot is looked at again
+                    before = slot.sequence.load(std::memory_order_acquire);
+                }
+                if (before >= 2 * (id + _slots.size()))
+                {
+                    // overwritten (or being overwritten) by a newer item
+                    cursor = id;
+                    continue;
+                }
+                // not written yet (an older sequence) or being written right now (2 * id + 1)
+                break;
+            }
+            return cursor;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> sequence;
+            T value;
+        };
+
+        std::vector<Slot> _slots;
+        std::atomic<uint64_t> _nextId;
+    };
+}
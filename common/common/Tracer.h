@@ -0,0 +1,109 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   Tracer.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "SeqLockRing.h"
+#include <QtCore/QByteArray>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/utility.hpp>
+
+namespace common
+{
+    // One finished span, times in microseconds since the tracer has been created.
+    struct TraceEvent
+    {
+        // string literal, never copied
+        const char* name;
+        uint64_t startUs;
+        uint64_t durationUs;
+    };
+
+    // Process-wide collector of the scoped spans (TRACE_SPAN). Every thread records into its own preallocated
+    // ring of the last ThreadCapacity spans, so recording takes no locks and older spans are simply overwritten.
+    // The rings are dumped on demand in the Chrome trace-event format (chrome://tracing, Perfetto).
+    class Tracer : boost::noncopyable
+    {
+    public:
+        static const size_t ThreadCapacity = 16384;
+
+        // Created on the first use from whichever thread records first.
+        static Tracer& instance();
+
+        uint64_t now() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _started).count();
+        }
+
+        void record(const char* name, uint64_t startUs, uint64_t durationUs);
+
+        // Names the calling thread in the dumps.
+        void threadName(const char* name);
+
+        // {"traceEvents":[...]} with a complete ("X") event per span and the thread names as metadata.
+        void writeChromeTrace(QByteArray& out) const;
+    private:
+        struct ThreadBuffer
+        {
+            explicit ThreadBuffer(int id) : id(id), events(ThreadCapacity)
+            {
+            }
+
+            int id;
+            std::string name;
+            SeqLockRing<TraceEvent> events;
+        };
+
+        Tracer();
+
+        ThreadBuffer& threadBuffer();
+
+        std::chrono::steady_clock::time_point _started;
+        mutable std::mutex _mutex;
+        // buffers outlive their threads, so spans of finished threads are still dumped
+        std::vector<std::shared_ptr<ThreadBuffer>> _threads;
+    };
+
+    // Records the time from its construction until the end of the scope.
+    class TraceSpan : boost::noncopyable
+    {
+    public:
+        explicit TraceSpan(const char* name) : _tracer(Tracer::instance()), _name(name), _startUs(_tracer.now())
+        {
+        }
+
+        ~TraceSpan()
+        {
+            _tracer.record(_name, _startUs, _tracer.now() - _startUs);
+        }
+    private:
+        Tracer& _tracer;
+        const char* _name;
+        uint64_t _startUs;
+    };
+}
+
+#define sTracer ::common::Tracer::instance()
+
+// The spans are compiled in only with GEM_ENABLE_TRACING (cmake -DGEM_ENABLE_TRACING=ON), otherwise
+// the macros expand to nothing. name must be a string literal.
+#ifdef GEM_ENABLE_TRACING
+#define TRACE_SPAN_CONCAT_(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_(a, b)
+#define TRACE_SPAN(name) ::common::TraceSpan TRACE_SPAN_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) sTracer.threadName(name)
+#else
+#define TRACE_SPAN(name)
+#define TRACE_THREAD_NAME(name)
+#endif
@@ -1,4 +1,10 @@
 #include "BitConverter.h"
+#include "BitConverterT.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GEM_BYTE_SWAP_SSE2
+#endif
 
 namespace common
 {
@@ -10,4 +16,77 @@ namespace common
         *((unsigned int*)test) = 0x1;
         _machineByteOrder = test[0] == 0x1 ? LeastSignificantByte : MostSignificantByte;
     }
+
+    namespace
+    {
+#ifdef GEM_BYTE_SWAP_SSE2
+        // swaps the bytes of every 16-bit lane
+        inline __m128i byteSwapLanes16(__m128i v)
+        {
+            return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+#endif
+
+        // Swaps the remaining elements one by one.
+        template<typename T, T (*Swap)(T)>
+        void byteSwapTail(const char* src, char* dst, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                T value;
+                memcpy(&value, src + i * sizeof(T), sizeof(T));
+                value = Swap(value);
+                memcpy(dst + i * sizeof(T), &value, sizeof(T));
+            }
+        }
+    }
+
+    void detail::byteSwapArray16(const void* src, void* dst, size_t count)
+    {
+        auto in = static_cast<const char*>(src);
+        auto out = static_cast<char*>(dst);
+        size_t i = 0;
+#ifdef GEM_BYTE_SWAP_SSE2
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), byteSwapLanes16(v));
+        }
+#endif
+        byteSwapTail<uint16_t, &byteSwap16>(in + i * 2, out + i * 2, count - i);
+    }
+
+    void detail::byteSwapArray32(const void* src, void* dst, size_t count)
+    {
+        auto in = static_cast<const char*>(src);
+        auto out = static_cast<char*>(dst);
+        size_t i = 0;
+#ifdef GEM_BYTE_SWAP_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 4));
+            // swap the 16-bit halves, then the bytes inside them
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), byteSwapLanes16(v));
+        }
+#endif
+        byteSwapTail<uint32_t, &byteSwap32>(in + i * 4, out + i * 4, count - i);
+    }
+
+    void detail::byteSwapArray64(const void* src, void* dst, size_t count)
+    {
+        auto in = static_cast<const char*>(src);
+        auto out = static_cast<char*>(dst);
+        size_t i = 0;
+#ifdef GEM_BYTE_SWAP_SSE2
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 8));
+            // reverse the four 16-bit words of each half, then the bytes inside them
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 8), byteSwapLanes16(v));
+        }
+#endif
+        byteSwapTail<uint64_t, &byteSwap64>(in + i * 8, out + i * 8, count - i);
+    }
 }
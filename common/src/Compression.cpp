@@ -0,0 +1,60 @@
+#include "Compression.h"
+
+QByteArray common::Compression::deflate(const QByteArray& data, int level)
+{
+    // qCompress prepends the uncompressed size (4 bytes, big-endian) to the zlib stream
+    return qCompress(data, level).mid(4);
+}
+
+QByteArray common::Compression::gzip(const QByteArray& data, int level)
+{
+    return gzipFromDeflated(deflate(data, level), data);
+}
+
+QByteArray common::Compression::gzipFromDeflated(const QByteArray& deflated, const QByteArray& data)
+{
+    // the raw deflate data is the zlib stream without its 2-byte header and the 4-byte Adler-32 trailer
+    const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+
+    QByteArray result;
+    result.reserve(sizeof(header) + deflated.size() + 2);
+    result.append(header, sizeof(header));
+    result.append(deflated.constData() + 2, deflated.size() - 6);
+    quint32 trailer[2] = { crc32(data.constData(), data.size()), quint32(data.size()) };
+    for (auto value : trailer)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            result.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+    return result;
+}
+
+quint32 common::Compression::crc32(const char* data, int size, quint32 crc)
+{
+    static const struct Table
+    {
+        quint32 values[256];
+
+        Table()
+        {
+            for (quint32 i = 0; i < 256; i++)
+            {
+                quint32 value = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                }
+                values[i] = value;
+            }
+        }
+    } table;
+
+    crc = ~crc;
+    for (int i = 0; i < size; i++)
+    {
+        crc = table.values[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
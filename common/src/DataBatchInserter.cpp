@@ -89,9 +89,9 @@ namespace common
 
             if (_tableName.isEmpty() || _tableName.isNull())
             {
-                sLogger.trace(QString("%1 records has been added.").arg(_rowsAdded));
+                LOG_TRACE(QString("%1 records has been added.").arg(_rowsAdded));
             } else {
-                sLogger.trace(QString("%1 records has been added into `%2`.").arg(_rowsAdded).arg(_tableName));
+                LOG_TRACE(QString("%1 records has been added into `%2`.").arg(_rowsAdded).arg(_tableName));
             }
             _rowsAdded = 0;
             int size = _boundValues.size();
@@ -0,0 +1,101 @@
+#include "EventNotifier.h"
+#include "Exception.h"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#else
+#include <chrono>
+#endif
+
+#ifdef __linux__
+
+common::EventNotifier::EventNotifier()
+{
+    _fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_fd < 0)
+    {
+        throw common::Exception(QString("Failed to create eventfd, errno = %1.").arg(errno));
+    }
+}
+
+common::EventNotifier::~EventNotifier()
+{
+    ::close(_fd);
+}
+
+void common::EventNotifier::notify()
+{
+    uint64_t one = 1;
+    // EAGAIN means the counter is saturated, i.e. already signaled.
+    ssize_t result;
+    do
+    {
+        result = ::write(_fd, &one, sizeof(one));
+    } while (result < 0 && errno == EINTR);
+}
+
+void common::EventNotifier::reset()
+{
+    uint64_t value;
+    ssize_t result;
+    do
+    {
+        result = ::read(_fd, &value, sizeof(value));
+    } while (result < 0 && errno == EINTR);
+}
+
+bool common::EventNotifier::wait(int timeoutMs)
+{
+    pollfd pfd;
+    pfd.fd = _fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int result;
+    do
+    {
+        result = ::poll(&pfd, 1, timeoutMs);
+    } while (result < 0 && errno == EINTR);
+    return result > 0;
+}
+
+#else
+
+common::EventNotifier::EventNotifier() : _fd(-1), _signaled(false)
+{
+}
+
+common::EventNotifier::~EventNotifier()
+{
+}
+
+void common::EventNotifier::notify()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _signaled = true;
+    }
+    _condition.notify_one();
+}
+
+void common::EventNotifier::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _signaled = false;
+}
+
+bool common::EventNotifier::wait(int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (timeoutMs < 0)
+    {
+        _condition.wait(lock, [this] { return _signaled; });
+        return true;
+    }
+    return _condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return _signaled; });
+}
+
+#endif
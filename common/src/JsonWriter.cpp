@@ -0,0 +1,341 @@
+#include "JsonWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const char HexDigits[] = "0123456789abcdef";
+
+    // Days since 1970-01-01 to the proleptic Gregorian date (H. Hinnant's civil_from_days)
+    void civilFromDays(int64_t days, int& year, int& month, int& day)
+    {
+        days += 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        int64_t dayOfEra = days - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+        day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+        year = static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    }
+
+    char* writeDigits(char* out, int value, int width)
+    {
+        for (int i = width - 1; i >= 0; i--)
+        {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return out + width;
+    }
+}
+
+common::JsonWriter::JsonWriter(QByteArray& buffer) : _buffer(buffer), _hasElements(0), _depth(0), _afterKey(false)
+{
+}
+
+void common::JsonWriter::separate()
+{
+    if (_afterKey)
+    {
+        _afterKey = false;
+        return;
+    }
+    uint64_t bit = uint64_t(1) << (_depth & 63);
+    if (_hasElements & bit)
+    {
+        _buffer.append(',');
+    }
+    _hasElements |= bit;
+}
+
+void common::JsonWriter::begin(char bracket)
+{
+    separate();
+    _buffer.append(bracket);
+    _depth++;
+    _hasElements &= ~(uint64_t(1) << (_depth & 63));
+}
+
+void common::JsonWriter::end(char bracket)
+{
+    _depth--;
+    _buffer.append(bracket);
+}
+
+common::JsonWriter& common::JsonWriter::beginObject()
+{
+    begin('{');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::endObject()
+{
+    end('}');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::beginArray()
+{
+    begin('[');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::endArray()
+{
+    end(']');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::key(const char* name)
+{
+    separate();
+    _buffer.append('"').append(name).append("\":", 2);
+    _afterKey = true;
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::value(bool value)
+{
+    separate();
+    if (value)
+    {
+        _buffer.append("true", 4);
+    }
+    else
+    {
+        _buffer.append("false", 5);
+    }
+    return *this;
+}
+
+void common::JsonWriter::writeUnsigned(unsigned long long value, bool negative)
+{
+    char digits[21];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    do
+    {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative)
+    {
+        *--begin = '-';
+    }
+    _buffer.append(begin, static_cast<int>(end - begin));
+}
+
+common::JsonWriter& common::JsonWriter::value(int value)
+{
+    return this->value(static_cast<long long>(value));
+}
+
+common::JsonWriter& common::JsonWriter::value(unsigned int value)
+{
+    return this->value(static_cast<unsigned long long>(value));
+}
+
+common::JsonWriter& common::JsonWriter::value(long value)
+{
+    return this->value(static_cast<long long>(value));
+}
+
+common::JsonWriter& common::JsonWriter::value(unsigned long value)
+{
+    return this->value(static_cast<unsigned long long>(value));
+}
+
+common::JsonWriter& common::JsonWriter::value(long long value)
+{
+    separate();
+    // negating via unsigned keeps LLONG_MIN intact
+    writeUnsigned(value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value), value < 0);
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::value(unsigned long long value)
+{
+    separate();
+    writeUnsigned(value, false);
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::value(double value)
+{
+    separate();
+    if (!std::isfinite(value))
+    {
+        // not representable in JSON
+        _buffer.append("null", 4);
+        return *this;
+    }
+    // the shortest of the usual precisions that reads back as the same value
+    char text[32];
+    int size = snprintf(text, sizeof(text), "%.15g", value);
+    if (strtod(text, nullptr) != value)
+    {
+        size = snprintf(text, sizeof(text), "%.17g", value);
+    }
+    _buffer.append(text, size);
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::value(const char* value)
+{
+    return this->value(value, static_cast<int>(strlen(value)));
+}
+
+common::JsonWriter& common::JsonWriter::value(const char* value, int size)
+{
+    separate();
+    _buffer.append('"');
+    writeEscaped(value, size);
+    _buffer.append('"');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::value(const QString& value)
+{
+    separate();
+    _buffer.append('"');
+    // UTF-16 to UTF-8 straight into the buffer
+    const QChar* chars = value.constData();
+    int size = value.size();
+    char encoded[4];
+    for (int i = 0; i < size; i++)
+    {
+        uint code = chars[i].unicode();
+        if (code < 0x80)
+        {
+            char c = static_cast<char>(code);
+            writeEscaped(&c, 1);
+            continue;
+        }
+        if (chars[i].isHighSurrogate() && i + 1 < size && chars[i + 1].isLowSurrogate())
+        {
+            code = QChar::surrogateToUcs4(chars[i], chars[i + 1]);
+            i++;
+        }
+        else if (chars[i].isSurrogate())
+        {
+            code = 0xFFFD;
+        }
+        int length;
+        if (code < 0x800)
+        {
+            encoded[0] = static_cast<char>(0xC0 | (code >> 6));
+            encoded[1] = static_cast<char>(0x80 | (code & 0x3F));
+            length = 2;
+        }
+        else if (code < 0x10000)
+        {
+            encoded[0] = static_cast<char>(0xE0 | (code >> 12));
+            encoded[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            encoded[2] = static_cast<char>(0x80 | (code & 0x3F));
+            length = 3;
+        }
+        else
+        {
+            encoded[0] = static_cast<char>(0xF0 | (code >> 18));
+            encoded[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            encoded[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            encoded[3] = static_cast<char>(0x80 | (code & 0x3F));
+            length = 4;
+        }
+        _buffer.append(encoded, length);
+    }
+    _buffer.append('"');
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::nullValue()
+{
+    separate();
+    _buffer.append("null", 4);
+    return *this;
+}
+
+void common::JsonWriter::writeEscaped(const char* value, int size)
+{
+    int plainStart = 0;
+    for (int i = 0; i < size; i++)
+    {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        _buffer.append(value + plainStart, i - plainStart);
+        plainStart = i + 1;
+        switch (c)
+        {
+        case '"':
+            _buffer.append("\\\"", 2);
+            break;
+        case '\\':
+            _buffer.append("\\\\", 2);
+            break;
+        case '\n':
+            _buffer.append("\\n", 2);
+            break;
+        case '\r':
+            _buffer.append("\\r", 2);
+            break;
+        case '\t':
+            _buffer.append("\\t", 2);
+            break;
+        default:
+            {
+                char escaped[6] = { '\\', 'u', '0', '0', HexDigits[c >> 4], HexDigits[c & 0xF] };
+                _buffer.append(escaped, sizeof(escaped));
+            }
+            break;
+        }
+    }
+    _buffer.append(value + plainStart, size - plainStart);
+}
+
+common::JsonWriter& common::JsonWriter::timeValue(qint64 msSinceEpoch)
+{
+    separate();
+    int64_t days = msSinceEpoch >= 0 ? msSinceEpoch / 86400000 : (msSinceEpoch - 86399999) / 86400000;
+    int64_t msOfDay = msSinceEpoch - days * 86400000;
+    int year;
+    int month;
+    int day;
+    civilFromDays(days, year, month, day);
+
+    char text[32];
+    char* out = text;
+    *out++ = '"';
+    out = writeDigits(out, year, 4);
+    *out++ = '-';
+    out = writeDigits(out, month, 2);
+    *out++ = '-';
+    out = writeDigits(out, day, 2);
+    *out++ = 'T';
+    out = writeDigits(out, static_cast<int>(msOfDay / 3600000), 2);
+    *out++ = ':';
+    out = writeDigits(out, static_cast<int>(msOfDay / 60000 % 60), 2);
+    *out++ = ':';
+    out = writeDigits(out, static_cast<int>(msOfDay / 1000 % 60), 2);
+    *out++ = '.';
+    out = writeDigits(out, static_cast<int>(msOfDay % 1000), 3);
+    *out++ = 'Z';
+    *out++ = '"';
+    _buffer.append(text, static_cast<int>(out - text));
+    return *this;
+}
+
+common::JsonWriter& common::JsonWriter::timeValue(const QDateTime& time)
+{
+    if (!time.isValid())
+    {
+        return value("", 0);
+    }
+    return timeValue(time.toMSecsSinceEpoch());
+}
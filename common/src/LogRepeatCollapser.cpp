@@ -0,0 +1,37 @@
+#include "LogRepeatCollapser.h"
+
+common::LogRepeats common::LogRepeatCollapser::take(qint64 nowMs)
+{
+    LogRepeats repeats;
+    repeats.count = _count;
+    repeats.level = _lastLevel;
+    _count = 0;
+    _reportedMs = nowMs;
+    return repeats;
+}
+
+bool common::LogRepeatCollapser::add(int level, const QByteArray& message, qint64 nowMs, LogRepeats& repeats)
+{
+    if (level == _lastLevel && message == _lastMessage)
+    {
+        _count++;
+        repeats = expire(nowMs);
+        return false;
+    }
+    repeats = take(nowMs);
+    _lastLevel = level;
+    _lastMessage = message;
+    return true;
+}
+
+common::LogRepeats common::LogRepeatCollapser::expire(qint64 nowMs, bool force)
+{
+    if (_count > 0 && (force || nowMs - _reportedMs >= ReportIntervalMs))
+    {
+        return take(nowMs);
+    }
+    LogRepeats repeats;
+    repeats.count = 0;
+    repeats.level = _lastLevel;
+    return repeats;
+}
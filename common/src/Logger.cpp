@@ -1,9 +1,36 @@
 #include "Logger.h"
+#include "Exception.h"
 
-#include <iostream>
+#include <QtCore/QFile>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    qint64 steadyNowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
 
 namespace common
 {
+    Logger::Logger() : logLevel(LogLevel::Debug), _async(false), _queueingWriters(0), _stopping(false), _wakeupPending(false), _enqueuedCount(0),
+        _droppedCount(0), _writtenCount(0), _maxFileSize(0), _maxFiles(0), _file(stderr), _fileSize(0)
+    {
+    }
+
+    Logger::~Logger()
+    {
+        stopAsync();
+        QByteArray batch;
+        {
+            std::lock_guard<std::mutex> lock(_syncMutex);
+            appendRepeats(_repeats.expire(steadyNowMs(), true), batch);
+        }
+        writeBatch(batch);
+    }
+
     void Logger::initialize(LogLevel logLevel)
     {
         if (logLevel < 0)
@@ -13,6 +40,73 @@ namespace common
         this->logLevel = logLevel;
     }
 
+    void Logger::startAsync(const QString& fileName, qint64 maxFileSize, int maxFiles)
+    {
+        if (_async)
+        {
+            return;
+        }
+        _fileName = fileName;
+        _maxFileSize = maxFileSize;
+        _maxFiles = maxFiles;
+        if (!_fileName.isEmpty())
+        {
+            openFile();
+        }
+        _stopping = false;
+        _thread = std::thread([this]() { run(); });
+        _async = true;
+    }
+
+    void Logger::stopAsync()
+    {
+        if (!_async)
+        {
+            return;
+        }
+        _async = false;
+        _stopping = true;
+        _wakeup.notify();
+        _thread.join();
+
+        // lines queued by the callers that have not seen _async cleared yet: once none of them is left,
+        // every later caller writes synchronously
+        while (_queueingWriters.load() > 0)
+        {
+            std::this_thread::yield();
+        }
+        Entry entry;
+        QByteArray batch;
+        {
+            std::lock_guard<std::mutex> lock(_syncMutex);
+            qint64 nowMs = steadyNowMs();
+            while (_queue.tryDequeue(entry))
+            {
+                collapse(entry, nowMs, batch);
+            }
+            appendRepeats(_repeats.expire(nowMs, true), batch);
+        }
+        writeBatch(batch);
+        if (_file != stderr)
+        {
+            std::fclose(_file);
+            _file = stderr;
+        }
+    }
+
+    void Logger::flush()
+    {
+        if (!_async)
+        {
+            std::fflush(stderr);
+            return;
+        }
+        uint64_t target = _enqueuedCount.load();
+        _wakeup.notify();
+        std::unique_lock<std::mutex> lock(_writtenMutex);
+        _written.wait(lock, [this, target]() { return _writtenCount >= target || !_async; });
+    }
+
     void Logger::debug(const QString& message)
     {
         write(Debug, message);
@@ -43,35 +137,188 @@ namespace common
         write(Fatal, message);
     }
 
+    const char* Logger::levelName(LogLevel logLevel)
+    {
+        switch (logLevel)
+        {
+        case Debug:
+            return "DEBUG";
+        case Trace:
+            return "TRACE";
+        case Info:
+            return "INFO";
+        case Warn:
+            return "WARN";
+        case Error:
+            return "ERROR";
+        case Fatal:
+            return "FATAL";
+        default:
+            return "";
+        }
+    }
+
     void Logger::write(LogLevel logLevel, const QString& message)
     {
-        if (this->logLevel >= logLevel)
+        if (this->logLevel < logLevel)
+        {
+            return;
+        }
+        Entry entry;
+        entry.level = logLevel;
+        entry.line.append(levelName(logLevel)).append(": ").append(message.toUtf8()).append('\n');
+        // counted before _async is read (both sequentially consistent): stopAsync() either sees this caller
+        // and waits for its line to be queued, or this caller sees _async cleared
+        _queueingWriters.fetch_add(1);
+        if (!_async)
+        {
+            _queueingWriters.fetch_sub(1);
+            std::lock_guard<std::mutex> lock(_syncMutex);
+            QByteArray batch;
+            collapse(entry, steadyNowMs(), batch);
+            std::fwrite(batch.constData(), 1, batch.size(), stderr);
+            return;
+        }
+        if (_queue.size() >= MaxQueuedEntries)
+        {
+            _droppedCount++;
+        }
+        else
+        {
+            _enqueuedCount++;
+            _queue.enqueue(std::move(entry));
+            // the writer wakes up by itself every FlushIntervalMs, a wakeup costs a syscall
+            if ((logLevel <= Error || _queue.size() >= BatchSize) && !_wakeupPending.exchange(true))
+            {
+                _wakeup.notify();
+            }
+        }
+        _queueingWriters.fetch_sub(1);
+    }
+
+    void Logger::collapse(const Entry& entry, qint64 nowMs, QByteArray& batch)
+    {
+        LogRepeats repeats;
+        bool write = _repeats.add(entry.level, entry.line, nowMs, repeats);
+        appendRepeats(repeats, batch);
+        if (write)
+        {
+            batch.append(entry.line);
+        }
+    }
+
+    void Logger::appendRepeats(const LogRepeats& repeats, QByteArray& batch)
+    {
+        if (repeats.count > 0)
+        {
+            batch.append(levelName(static_cast<LogLevel>(repeats.level))).append(": ")
+                .append(LogRepeatCollapser::repeatedMessage(repeats.count).toUtf8()).append('\n');
+        }
+    }
+
+    void Logger::run()
+    {
+        QByteArray batch;
+        Entry entry;
+        while (true)
+        {
+            _wakeup.wait(FlushIntervalMs);
+            _wakeup.reset();
+            // cleared before draining, so that lines queued meanwhile request another wakeup
+            _wakeupPending = false;
+            bool stopping = _stopping;
+
+            uint64_t count = 0;
+            {
+                // uncontended unless a caller still writes synchronously while the logger starts
+                std::lock_guard<std::mutex> lock(_syncMutex);
+                qint64 nowMs = steadyNowMs();
+                while (_queue.tryDequeue(entry))
+                {
+                    collapse(entry, nowMs, batch);
+                    count++;
+                }
+                appendRepeats(_repeats.expire(nowMs), batch);
+            }
+            uint64_t dropped = _droppedCount.exchange(0);
+            if (dropped > 0)
+            {
+                batch.append(QString("WARN: %1 log messages have been dropped, the log output could not keep up.\n").arg(dropped).toUtf8());
+            }
+            if (!batch.isEmpty())
+            {
+                writeBatch(batch);
+                batch.resize(0);
+            }
+            {
+                std::lock_guard<std::mutex> lock(_writtenMutex);
+                _writtenCount += count;
+            }
+            _written.notify_all();
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    void Logger::writeBatch(const QByteArray& batch)
+    {
+        if (batch.isEmpty())
+        {
+            return;
+        }
+        std::fwrite(batch.constData(), 1, batch.size(), _file);
+        std::fflush(_file);
+        if (_file == stderr)
+        {
+            return;
+        }
+        _fileSize += batch.size();
+        if (_maxFileSize > 0 && _fileSize >= _maxFileSize)
+        {
+            rotateFile();
+        }
+    }
+
+    void Logger::openFile()
+    {
+        _file = std::fopen(QFile::encodeName(_fileName).constData(), "ab");
+        if (_file == nullptr)
+        {
+            _file = stderr;
+            throw Exception(QString("Failed to open the log file `%1`.").arg(_fileName));
+        }
+        std::fseek(_file, 0, SEEK_END);
+        _fileSize = std::ftell(_file);
+    }
+
+    void Logger::rotateFile()
+    {
+        std::fclose(_file);
+        _file = stderr;
+        if (_maxFiles > 0)
         {
-            QString levelMsg;
-            switch (logLevel)
+            QFile::remove(QString("%1.%2").arg(_fileName).arg(_maxFiles));
+            for (int i = _maxFiles - 1; i >= 1; i--)
             {
-            case Debug:
-                levelMsg = "DEBUG";
-                break;
-            case Trace:
-                levelMsg = "TRACE";
-                break;
-            case Info:
-                levelMsg = "INFO";
-                break;
-            case Warn:
-                levelMsg = "WARN";
-                break;
-            case Error:
-                levelMsg = "ERROR";
-                break;
-            case Fatal:
-                levelMsg = "FATAL";
-                break;
-            default:
-                break;
+                QFile::rename(QString("%1.%2").arg(_fileName).arg(i), QString("%1.%2").arg(_fileName).arg(i + 1));
             }
-            std::cerr << levelMsg.toStdString() << ": " << message.toStdString() << std::endl;
+            QFile::rename(_fileName, _fileName + ".1");
+        }
+        else
+        {
+            QFile::remove(_fileName);
+        }
+        try
+        {
+            openFile();
+        }
+        catch (Exception& ex)
+        {
+            // keep logging to stderr
+            std::fprintf(stderr, "ERROR: %s\n", ex.what().toUtf8().constData());
         }
     }
 }
@@ -0,0 +1,215 @@
+#include "Metrics.h"
+#include "InvalidOperationException.h"
+#include <cstdio>
+
+namespace
+{
+    int highestBit(uint64_t value)
+    {
+        int bit = 0;
+        while (value >>= 1)
+        {
+            bit++;
+        }
+        return bit;
+    }
+
+    void appendNumber(QByteArray& out, double value)
+    {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out.append(buffer, length);
+    }
+
+    void appendSeriesName(QByteArray& out, const std::string& name, const char* suffix, const std::string& labels, const char* extraLabel = nullptr)
+    {
+        out.append(name.data(), int(name.size())).append(suffix);
+        if (labels.empty() && extraLabel == nullptr)
+        {
+            return;
+        }
+        out.append('{').append(labels.data(), int(labels.size()));
+        if (extraLabel != nullptr)
+        {
+            if (!labels.empty())
+            {
+                out.append(',');
+            }
+            out.append(extraLabel);
+        }
+        out.append('}');
+    }
+}
+
+common::MetricHistogram::MetricHistogram(double unit) : _unit(unit), _count(0), _sum(0)
+{
+    for (auto& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+int common::MetricHistogram::bucketIndex(uint64_t value)
+{
+    if (value < SubBucketCount)
+    {
+        return static_cast<int>(value);
+    }
+    int bit = highestBit(value);
+    if (bit > MaxValueBits)
+    {
+        return BucketCount - 1;
+    }
+    int shift = bit - SubBucketBits;
+    return (bit - SubBucketBits + 1) * SubBucketCount + static_cast<int>((value >> shift) & (SubBucketCount - 1));
+}
+
+uint64_t common::MetricHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBucketCount)
+    {
+        return static_cast<uint64_t>(index) + 1;
+    }
+    int group = index / SubBucketCount;
+    int subBucket = index % SubBucketCount;
+    return static_cast<uint64_t>(SubBucketCount + subBucket + 1) << (group - 1);
+}
+
+uint64_t common::MetricHistogram::quantile(double q) const
+{
+    uint64_t total = count();
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+    rank = rank < 1 ? 1 : rank > total ? total : rank;
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(BucketCount - 1);
+}
+
+uint64_t common::MetricHistogram::countBelow(uint64_t bound) const
+{
+    uint64_t result = 0;
+    for (int i = 0; i < BucketCount && bucketUpperBound(i) <= bound; i++)
+    {
+        result += _buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+common::Metrics::Series& common::Metrics::series(const char* name, const char* help, Type type, const std::string& labels, double unit)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _families.find(name);
+    if (found == _families.end())
+    {
+        Family family;
+        family.type = type;
+        family.help = help;
+        found = _families.insert(std::make_pair(std::string(name), std::move(family))).first;
+    }
+    else if (found->second.type != type)
+    {
+        throw InvalidOperationException(QString("Metric `%1` is already registered with another type.").arg(name));
+    }
+    for (auto& series : found->second.series)
+    {
+        if (series->labels == labels)
+        {
+            return *series;
+        }
+    }
+    std::unique_ptr<Series> series(new Series());
+    series->labels = labels;
+    switch (type)
+    {
+    case CounterType:
+        series->counter.reset(new MetricCounter());
+        break;
+    case GaugeType:
+        series->gauge.reset(new MetricGauge());
+        break;
+    case HistogramType:
+        series->histogram.reset(new MetricHistogram(unit));
+        break;
+    }
+    found->second.series.push_back(std::move(series));
+    return *found->second.series.back();
+}
+
+common::MetricCounter& common::Metrics::counter(const char* name, const char* help, const std::string& labels)
+{
+    return *series(name, help, CounterType, labels, 1).counter;
+}
+
+common::MetricGauge& common::Metrics::gauge(const char* name, const char* help, const std::string& labels)
+{
+    return *series(name, help, GaugeType, labels, 1).gauge;
+}
+
+common::MetricHistogram& common::Metrics::histogram(const char* name, const char* help, const std::string& labels, double unit)
+{
+    return *series(name, help, HistogramType, labels, unit).histogram;
+}
+
+void common::Metrics::writePrometheus(QByteArray& out) const
+{
+    static const char* TypeNames[] = { "counter", "gauge", "histogram" };
+    // every 4x from 16 to 2^34 recorded units (16 us to 4.8 h for microseconds), exact bucket boundaries
+    static const int FirstBoundBit = 4;
+    static const int LastBoundBit = 34;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& entry : _families)
+    {
+        auto& name = entry.first;
+        auto& family = entry.second;
+        out.append("# HELP ").append(name.data(), int(name.size())).append(' ').append(family.help.data(), int(family.help.size())).append('\n');
+        out.append("# TYPE ").append(name.data(), int(name.size())).append(' ').append(TypeNames[family.type]).append('\n');
+        for (auto& series : family.series)
+        {
+            if (series->counter)
+            {
+                appendSeriesName(out, name, "", series->labels);
+                out.append(' ').append(QByteArray::number(qulonglong(series->counter->value()))).append('\n');
+            }
+            else if (series->gauge)
+            {
+                appendSeriesName(out, name, "", series->labels);
+                out.append(' ').append(QByteArray::number(qlonglong(series->gauge->value()))).append('\n');
+            }
+            else if (series->histogram)
+            {
+                auto& histogram = *series->histogram;
+                // read the total first, so that the buckets never exceed it
+                uint64_t total = histogram.count();
+                uint64_t sum = histogram.sum();
+                char bound[48];
+                for (int bit = FirstBoundBit; bit <= LastBoundBit; bit += 2)
+                {
+                    uint64_t below = histogram.countBelow(uint64_t(1) << bit);
+                    std::snprintf(bound, sizeof(bound), "le=\"%.9g\"", double(uint64_t(1) << bit) * histogram.unit());
+                    appendSeriesName(out, name, "_bucket", series->labels, bound);
+                    out.append(' ').append(QByteArray::number(qulonglong(below < total ? below : total))).append('\n');
+                }
+                appendSeriesName(out, name, "_bucket", series->labels, "le=\"+Inf\"");
+                out.append(' ').append(QByteArray::number(qulonglong(total))).append('\n');
+                appendSeriesName(out, name, "_sum", series->labels);
+                out.append(' ');
+                appendNumber(out, double(sum) * histogram.unit());
+                out.append('\n');
+                appendSeriesName(out, name, "_count", series->labels);
+                out.append(' ').append(QByteArray::number(qulonglong(total))).append('\n');
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include "Tracer.h"
+#include "JsonWriter.h"
+
+common::Tracer& common::Tracer::instance()
+{
+    // thread-safe initialization, unlike Singleton<T>: the first span may start on any thread
+    static Tracer tracer;
+    return tracer;
+}
+
+common::Tracer::Tracer() : _started(std::chrono::steady_clock::now())
+{
+}
+
+common::Tracer::ThreadBuffer& common::Tracer::threadBuffer()
+{
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(std::make_shared<ThreadBuffer>(int(_threads.size()) + 1));
+        buffer = _threads.back().get();
+    }
+    return *buffer;
+}
+
+void common::Tracer::record(const char* name, uint64_t startUs, uint64_t durationUs)
+{
+    TraceEvent event;
+    event.name = name;
+    event.startUs = startUs;
+    event.durationUs = durationUs;
+    threadBuffer().events.push(event);
+}
+
+void common::Tracer::threadName(const char* name)
+{
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(_mutex);
+    buffer.name = name;
+}
+
+void common::Tracer::writeChromeTrace(QByteArray& out) const
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        threads = _threads;
+        for (auto& thread : threads)
+        {
+            names.push_back(thread->name);
+        }
+    }
+
+    JsonWriter writer(out);
+    writer.beginObject().field("displayTimeUnit", "ms").key("traceEvents").beginArray();
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        int tid = threads[i]->id;
+        if (!names[i].empty())
+        {
+            writer.beginObject().field("name", "thread_name").field("ph", "M").field("pid", 1).field("tid", tid)
+                .key("args").beginObject().field("name", names[i].c_str()).endObject()
+                .endObject();
+        }
+        threads[i]->events.readSince(0, [&writer, tid](uint64_t, const TraceEvent& event)
+        {
+            writer.beginObject().field("name", event.name).field("cat", "gem").field("ph", "X")
+                .field("ts", static_cast<unsigned long long>(event.startUs))
+                .field("dur", static_cast<unsigned long long>(event.durationUs))
+                .field("pid", 1).field("tid", tid)
+                .endObject();
+        });
+    }
+    writer.endArray().endObject();
+}
@@ -0,0 +1,154 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   AggregatePyramidTests.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <core/AggregatePyramid.h>
+#include <core/RunnerActionHandler.h>
+#include <atomic>
+#include <thread>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class AggregatePyramidTests : public BaseTest
+        {
+        };
+
+        TEST_F(AggregatePyramidTests, ShouldAggregateEveryLevel)
+        {
+            // Arrange
+            AggregatePyramid pyramid;
+            const int64_t startMs = 1420070400000LL;
+
+            // Act: two hours at 5 Hz
+            for (int i = 0; i < 5 * 60 * 60 * 2; i++)
+            {
+                pyramid.add(startMs + i * 200, i % 1000);
+            }
+
+            // Assert
+            ASSERT_EQ(2u * 60 * 60 - 1, pyramid.lastId(AggregatePyramid::Seconds));
+            ASSERT_EQ(2u * 60 - 1, pyramid.lastId(AggregatePyramid::Minutes));
+            ASSERT_EQ(1u, pyramid.lastId(AggregatePyramid::Hours));
+
+            std::vector<SampleAggregate> minutes;
+            pyramid.readSince(AggregatePyramid::Minutes, 0, [&minutes](uint64_t, const SampleAggregate& bucket)
+            {
+                minutes.push_back(bucket);
+            });
+            ASSERT_EQ(119u, minutes.size());
+            ASSERT_EQ(startMs, minutes[0].startMs);
+            ASSERT_EQ(300, minutes[0].count);
+            ASSERT_EQ(0, minutes[0].min);
+            ASSERT_EQ(299, minutes[0].max);
+            ASSERT_EQ(startMs + 60 * 1000, minutes[1].startMs);
+
+            auto currentHour = pyramid.current(AggregatePyramid::Hours);
+            ASSERT_EQ(5 * 60 * 60, currentHour.count);
+            ASSERT_EQ(startMs + 60 * 60 * 1000, currentHour.startMs);
+        }
+
+        TEST_F(AggregatePyramidTests, ShouldKeepOnlyTheCapacityOfCompletedBuckets)
+        {
+            // Arrange
+            AggregatePyramid pyramid;
+
+            // Act: 2 hours of 1 Hz samples, the seconds ring keeps one hour
+            for (int i = 0; i <= 2 * 60 * 60; i++)
+            {
+                pyramid.add(int64_t(i) * 1000, i);
+            }
+
+            // Assert
+            int count = 0;
+            int64_t firstStartMs = -1;
+            pyramid.readSince(AggregatePyramid::Seconds, 0, [&](uint64_t, const SampleAggregate& bucket)
+            {
+                if (count++ == 0)
+                {
+                    firstStartMs = bucket.startMs;
+                }
+            });
+            ASSERT_EQ(int(AggregatePyramid::capacity(AggregatePyramid::Seconds)), count);
+            ASSERT_EQ(int64_t(60 * 60) * 1000, firstStartMs);
+        }
+
+        TEST_F(AggregatePyramidTests, ShouldReadAConsistentCurrentBucketWhileSamplesAreAdded)
+        {
+            // Arrange: a sample every millisecond with the value of its time, so a bucket is consistent
+            // if its min is its start and its max, count and sum follow from it
+            const int samplesCount = 2000000;
+            AggregatePyramid pyramid;
+            pyramid.add(0, 0);
+            std::atomic<bool> done(false);
+            std::thread runner([&pyramid, &done]()
+            {
+                for (int i = 1; i < samplesCount; i++)
+                {
+                    pyramid.add(i, i);
+                }
+                done = true;
+            });
+
+            // Act
+            int readsCount = 0;
+            int inconsistentCount = 0;
+            while (!done)
+            {
+                auto current = pyramid.current(AggregatePyramid::Seconds);
+                bool consistent = current.count > 0 && current.min == current.startMs && current.max == current.min + current.count - 1
+                    && current.sum == int64_t(current.count) * (current.min + current.max) / 2;
+                inconsistentCount += consistent ? 0 : 1;
+                readsCount++;
+            }
+            runner.join();
+
+            // Assert
+            ASSERT_LT(0, readsCount);
+            ASSERT_EQ(0, inconsistentCount);
+        }
+
+        TEST_F(AggregatePyramidTests, ShouldWriteCompletedAndCurrentBucketsAsJson)
+        {
+            // Arrange: two complete seconds at 5 Hz and the first sample of the third
+            AggregatePyramid pyramid;
+            const int64_t startMs = 1420070400000LL;
+            for (int i = 0; i < 11; i++)
+            {
+                pyramid.add(startMs + i * 200, i);
+            }
+
+            // Act
+            QByteArray buffer;
+            RunnerActionHandler::writeAggregatesJson(buffer, pyramid, AggregatePyramid::Seconds, 0, startMs + 1000);
+
+            // Assert
+            auto root = QJsonDocument::fromJson(buffer).object();
+            ASSERT_EQ(QString("1s"), root["level"].toString());
+            auto buckets = root["buckets"].toArray();
+            ASSERT_EQ(1, buckets.size());
+            auto bucket = buckets[0].toArray();
+            ASSERT_EQ(double(startMs + 1000), bucket[0].toDouble());
+            ASSERT_EQ(5, bucket[1].toInt());
+            ASSERT_EQ(9, bucket[2].toInt());
+            ASSERT_EQ(7.0, bucket[3].toDouble());
+            ASSERT_EQ(5, bucket[4].toInt());
+            ASSERT_EQ(double(pyramid.lastId(AggregatePyramid::Seconds)), root["cursor"].toDouble());
+            auto current = root["current"].toArray();
+            ASSERT_EQ(double(startMs + 2000), current[0].toDouble());
+            ASSERT_EQ(1, current[4].toInt());
+        }
+    }
+}
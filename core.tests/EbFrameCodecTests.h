@@ -0,0 +1,154 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <EbFrameCodec.h>
+#include <random>
+
+namespace core
+{
+    namespace tests
+    {
+        class EbFrameCodecTests : public BaseTest
+        {
+        protected:
+            QByteArray escape(const QByteArray& data)
+            {
+                QByteArray result(EbFrameCodec::maxEscapedSize(data.size()), Qt::Uninitialized);
+                result.resize(EbFrameCodec::escape(data.constData(), data.size(), result.data()));
+                return result;
+            }
+
+            QByteArray unescape(const QByteArray& data, int& errors)
+            {
+                QByteArray result(data.size(), Qt::Uninitialized);
+                result.resize(EbFrameCodec::unescape(data.constData(), data.size(), result.data(), errors));
+                return result;
+            }
+
+            // byte at a time, as the device protocol describes it
+            QByteArray referenceEscape(const QByteArray& data)
+            {
+                QByteArray result;
+                for (int i = 0; i < data.size(); i++)
+                {
+                    uint8_t c = data.at(i);
+                    if (c < 0x20)
+                    {
+                        result.append(0x1A);
+                        result.append(c + 0x80);
+                    }
+                    else
+                    {
+                        result.append(c);
+                    }
+                }
+                return result;
+            }
+
+            QByteArray randomData(std::mt19937& random, int size, int specialPercent)
+            {
+                QByteArray result(size, Qt::Uninitialized);
+                for (int i = 0; i < size; i++)
+                {
+                    uint8_t c = static_cast<uint8_t>(random());
+                    if (int(random() % 100) < specialPercent)
+                    {
+                        c = c % 0x20;
+                    }
+                    else if (c < 0x20)
+                    {
+                        c += 0x20;
+                    }
+                    result[i] = c;
+                }
+                return result;
+            }
+        };
+
+        TEST_F(EbFrameCodecTests, ShouldCopyDataWithoutSpecialBytes)
+        {
+            // Arrange
+            QByteArray data;
+            for (int i = 0; i < 100; i++)
+            {
+                data.append(char(0x20 + i));
+            }
+            int errors = 0;
+
+            // Act
+            auto escaped = escape(data);
+            auto unescaped = unescape(escaped, errors);
+
+            // Assert
+            ASSERT_EQ(data, escaped);
+            ASSERT_EQ(data, unescaped);
+            ASSERT_EQ(0, errors);
+        }
+
+        TEST_F(EbFrameCodecTests, ShouldEscapeSpecialBytesAtEveryBlockPosition)
+        {
+            for (int size = 1; size <= 70; size++)
+            {
+                for (int position = 0; position < size; position++)
+                {
+                    // Arrange
+                    QByteArray data(size, 'A');
+                    data[position] = position % 2 == 0 ? 0x1A : 0x03;
+                    int errors = 0;
+
+                    // Act
+                    auto escaped = escape(data);
+                    auto unescaped = unescape(escaped, errors);
+
+                    // Assert
+                    ASSERT_EQ(referenceEscape(data), escaped);
+                    ASSERT_EQ(data, unescaped);
+                    ASSERT_EQ(0, errors);
+                }
+            }
+        }
+
+        TEST_F(EbFrameCodecTests, ShouldMatchByteWiseCodecOnRandomData)
+        {
+            std::mt19937 random(42);
+            for (int i = 0; i < 500; i++)
+            {
+                // Arrange
+                auto data = randomData(random, int(random() % 300), i % 4 * 10);
+                int errors = 0;
+
+                // Act
+                auto escaped = escape(data);
+                auto unescaped = unescape(escaped, errors);
+
+                // Assert
+                ASSERT_EQ(referenceEscape(data), escaped);
+                ASSERT_EQ(data, unescaped);
+                ASSERT_EQ(0, errors);
+            }
+        }
+
+        TEST_F(EbFrameCodecTests, ShouldCountDamagedEscapeSequences)
+        {
+            // Arrange
+            QByteArray data(40, 'B');
+            data[3] = 0x1A;
+            data[4] = 0x1A;
+            data[5] = char(0x8D);
+            data[20] = 0x1A;
+            data[21] = 0x41;
+            data[39] = 0x1A;
+            int errors = 0;
+
+            // Act
+            auto unescaped = unescape(data, errors);
+
+            // Assert
+            ASSERT_EQ(36, unescaped.size());
+            ASSERT_EQ(char(0x0D), unescaped[3]);
+            ASSERT_EQ(char(0x41 - 0x80), unescaped[18]);
+            ASSERT_EQ(1, errors);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   HistoryDownsamplerTests.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <core/HistoryDownsampler.h>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class HistoryDownsamplerTests : public BaseTest
+        {
+        protected:
+            std::vector<HistoryPoint> downsample(HistoryDownsampler::Mode mode, int count, int maxPoints)
+            {
+                std::vector<HistoryPoint> result;
+                HistoryDownsampler downsampler(mode, 0, count * 200 - 1, maxPoints, [&result](const HistoryPoint& point)
+                {
+                    result.push_back(point);
+                });
+                for (int i = 0; i < count; i++)
+                {
+                    // 5 Hz saw-tooth with a single spike in the middle
+                    downsampler.add(i * 200, i == count / 2 ? 100000 : (i * 37) % 101);
+                }
+                downsampler.finish();
+                return result;
+            }
+
+            static bool hasValue(const std::vector<HistoryPoint>& points, int32_t value)
+            {
+                for (auto& point : points)
+                {
+                    if (point.value == value)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        TEST_F(HistoryDownsamplerTests, ShouldBoundMinMaxOutputAndKeepSpikes)
+        {
+            // Act
+            auto points = downsample(HistoryDownsampler::MinMax, 100000, 500);
+
+            // Assert
+            ASSERT_LE(points.size(), 500u);
+            ASSERT_GE(points.size(), 250u);
+            ASSERT_TRUE(hasValue(points, 100000));
+            for (size_t i = 1; i < points.size(); i++)
+            {
+                ASSERT_LT(points[i - 1].timeMs, points[i].timeMs);
+            }
+        }
+
+        TEST_F(HistoryDownsamplerTests, ShouldKeepEndsAndSpikesWithLttb)
+        {
+            // Act
+            auto points = downsample(HistoryDownsampler::Lttb, 100000, 500);
+
+            // Assert
+            ASSERT_EQ(500u, points.size());
+            ASSERT_EQ(0, points.front().timeMs);
+            ASSERT_EQ((100000 - 1) * 200, points.back().timeMs);
+            ASSERT_TRUE(hasValue(points, 100000));
+        }
+
+        TEST_F(HistoryDownsamplerTests, ShouldPassThroughSparseData)
+        {
+            // Act
+            auto points = downsample(HistoryDownsampler::Lttb, 10, 500);
+
+            // Assert
+            ASSERT_EQ(10u, points.size());
+        }
+    }
+}
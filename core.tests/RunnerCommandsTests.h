@@ -0,0 +1,57 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <RunnerCommands.h>
+#include <thread>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class RunnerCommandsTests : public BaseTest
+        {
+        };
+
+        TEST_F(RunnerCommandsTests, ShouldReleaseWaitersWhenCommandCompletes)
+        {
+            // Arrange
+            auto command = std::make_shared<UpdateStatusRunnerCommand>();
+            ASSERT_FALSE(command->waitFinished(10));
+            std::thread runner([command]()
+            {
+                command->started();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                command->completed();
+            });
+
+            // Act
+            bool finished = command->waitFinished(5000);
+            runner.join();
+
+            // Assert
+            ASSERT_TRUE(finished);
+            ASSERT_EQ(CommandCompleted, command->state());
+            ASSERT_TRUE(command->error().isEmpty());
+        }
+
+        TEST_F(RunnerCommandsTests, ShouldKeepFirstResultOfCommand)
+        {
+            // Arrange
+            auto command = std::make_shared<StopRunnerCommand>();
+            command->started();
+
+            // Act
+            command->failed("Device does not respond.");
+            command->completed();
+            command->failed("The command has been interrupted.");
+
+            // Assert
+            ASSERT_TRUE(command->waitFinished(0));
+            ASSERT_EQ(CommandFailed, command->state());
+            ASSERT_EQ(QString("Device does not respond."), command->error());
+        }
+    }
+}
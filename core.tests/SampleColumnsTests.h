@@ -0,0 +1,102 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SampleColumnsTests.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <core/SampleColumns.h>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class SampleColumnsTests : public BaseTest
+        {
+        protected:
+            QVector<EbDevice::Sample> createSamples(int count)
+            {
+                QVector<EbDevice::Sample> samples;
+                QDateTime startTime(QDate(2015, 6, 4), QTime(13, 44), Qt::UTC);
+                for (int i = 0; i < count; i++)
+                {
+                    EbDevice::Sample sample;
+                    sample.field = i % 3 == 2 ? -50000 - i : 50000 + i * 7;
+                    sample.qmc = static_cast<uint16_t>(i);
+                    sample.state = EbDevice::Valid;
+                    sample.time = startTime.addMSecs(i * 200);
+                    samples.push_back(sample);
+                }
+                return samples;
+            }
+        };
+
+        TEST_F(SampleColumnsTests, ShouldEncodeLittleEndianColumns)
+        {
+            // Arrange
+            auto samples = createSamples(2);
+            BitConverter converter(BitConverter::LeastSignificantByte);
+
+            // Act
+            auto data = SampleColumns::encode(samples.constData(), samples.size(), 42);
+
+            // Assert
+            ASSERT_EQ(SampleColumns::encodedSize(2), data.size());
+            ASSERT_TRUE(data.startsWith("GEMS"));
+            ASSERT_EQ(2u, converter.GetUInt32(data.constData() + 8));
+            ASSERT_EQ(42u, converter.GetUInt64(data.constData() + 16));
+            const char* columns = data.constData() + SampleColumns::HeaderSize;
+            ASSERT_EQ(samples[1].time.toMSecsSinceEpoch(), converter.GetInt64(columns + 8));
+            ASSERT_EQ(samples[1].field, converter.GetInt32(columns + 2 * 8 + 4));
+            ASSERT_EQ(samples[1].qmc, converter.GetUInt16(columns + 2 * 12 + 2));
+            ASSERT_EQ(uint8_t(EbDevice::Valid), converter.GetUInt8(columns + 2 * 14 + 1));
+        }
+
+        TEST_F(SampleColumnsTests, ShouldDecodeDeltaEncodedSamples)
+        {
+            // Arrange
+            auto samples = createSamples(100);
+
+            // Act
+            auto data = SampleColumns::encode(samples.constData(), samples.size(), 100, SampleColumns::DeltaEncoded);
+            QVector<EbDevice::Sample> decoded;
+            quint64 cursor = 0;
+            bool result = SampleColumns::decode(data, decoded, cursor);
+
+            // Assert
+            ASSERT_TRUE(result);
+            ASSERT_EQ(100u, cursor);
+            ASSERT_EQ(samples.size(), decoded.size());
+            for (int i = 0; i < samples.size(); i++)
+            {
+                ASSERT_EQ(samples[i].field, decoded[i].field);
+                ASSERT_EQ(samples[i].qmc, decoded[i].qmc);
+                ASSERT_EQ(samples[i].state, decoded[i].state);
+                ASSERT_TRUE(samples[i].time == decoded[i].time);
+            }
+        }
+
+        TEST_F(SampleColumnsTests, ShouldRejectTruncatedData)
+        {
+            // Arrange
+            auto samples = createSamples(10);
+            auto data = SampleColumns::encode(samples.constData(), samples.size(), 10);
+
+            // Act
+            QVector<EbDevice::Sample> decoded;
+            quint64 cursor = 0;
+            bool result = SampleColumns::decode(data.left(data.size() - 1), decoded, cursor);
+
+            // Assert
+            ASSERT_FALSE(result);
+        }
+    }
+}
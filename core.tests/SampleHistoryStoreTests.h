@@ -0,0 +1,150 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SampleHistoryStoreTests.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <core/SampleHistoryStore.h>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class SampleHistoryStoreTests : public BaseTest
+        {
+        protected:
+            static const int64_t StartMs = 1420070400000LL;
+
+            static HistorySample createSample(int i)
+            {
+                // 5 Hz with a bit of jitter, noisy field with rare jumps, slowly changing quality
+                HistorySample sample;
+                sample.timeMs = StartMs + int64_t(i) * 200 + (i % 50 == 0 ? 3 : 0);
+                sample.field = 50000 + (i % 7) - 3 + (i % 1000 == 0 ? -2000000 : 0);
+                sample.qmc = static_cast<uint16_t>(i / 100 % 3);
+                sample.state = 0x80;
+                return sample;
+            }
+        };
+
+        TEST_F(SampleHistoryStoreTests, ShouldScanPublishedSamplesOnly)
+        {
+            // Arrange
+            SampleHistoryStore store;
+            for (int i = 0; i < 10000; i++)
+            {
+                store.append(createSample(i));
+            }
+            store.publish();
+            store.append(createSample(10000));
+
+            // Act
+            std::vector<HistorySample> samples;
+            store.scan(INT64_MIN, INT64_MAX, [&samples](const HistorySample& sample)
+            {
+                samples.push_back(sample);
+            });
+
+            // Assert
+            ASSERT_EQ(10000u, samples.size());
+            for (int i = 0; i < 10000; i++)
+            {
+                auto expected = createSample(i);
+                ASSERT_EQ(expected.timeMs, samples[i].timeMs);
+                ASSERT_EQ(expected.field, samples[i].field);
+                ASSERT_EQ(expected.qmc, samples[i].qmc);
+                ASSERT_EQ(expected.state, samples[i].state);
+            }
+        }
+
+        TEST_F(SampleHistoryStoreTests, ShouldScanTimeRange)
+        {
+            // Arrange
+            SampleHistoryStore store;
+            for (int i = 0; i < 100000; i++)
+            {
+                store.append(createSample(i));
+            }
+            store.publish();
+
+            // Act
+            int count = 0;
+            int64_t firstTimeMs = 0;
+            store.scan(StartMs + 60 * 1000, StartMs + 2 * 60 * 1000 - 1, [&](const HistorySample& sample)
+            {
+                if (count++ == 0)
+                {
+                    firstTimeMs = sample.timeMs;
+                }
+            });
+
+            // Assert
+            ASSERT_EQ(5 * 60, count);
+            ASSERT_EQ(createSample(5 * 60).timeMs, firstTimeMs);
+        }
+
+        TEST_F(SampleHistoryStoreTests, ShouldCompressAndDropExpiredBlocks)
+        {
+            // Arrange
+            SampleHistoryStore store(1);
+
+            // Act: two days at 5 Hz
+            const int count = 2 * 24 * 60 * 60 * 5;
+            for (int i = 0; i < count; i++)
+            {
+                store.append(createSample(i));
+            }
+            store.publish();
+            auto stats = store.stats();
+
+            // Assert
+            ASSERT_LT(stats.sizeBytes, stats.samplesCount * 2);
+            ASSERT_LT(stats.samplesCount, size_t(count));
+            ASSERT_GE(stats.samplesCount, size_t(count / 2));
+            ASSERT_EQ(createSample(count - 1).timeMs, stats.lastTimeMs);
+            ASSERT_LE(stats.firstTimeMs, stats.lastTimeMs - 24 * 60 * 60 * 1000);
+        }
+
+        TEST_F(SampleHistoryStoreTests, ShouldDropOldestBlocksBeyondSizeLimit)
+        {
+            // Arrange
+            const size_t maxSizeBytes = 64 * 1024;
+            SampleHistoryStore store(7, maxSizeBytes);
+
+            // Act: a day at 5 Hz, far more than the limit
+            const int count = 24 * 60 * 60 * 5;
+            for (int i = 0; i < count; i++)
+            {
+                store.append(createSample(i));
+            }
+            store.publish();
+            auto stats = store.stats();
+            int scanned = 0;
+            int64_t previousTimeMs = 0;
+            bool ordered = true;
+            store.scan(0, INT64_MAX, [&](const HistorySample& sample)
+            {
+                ordered = ordered && sample.timeMs > previousTimeMs;
+                previousTimeMs = sample.timeMs;
+                scanned++;
+            });
+
+            // Assert: the sealed blocks within the limit and the open one
+            ASSERT_LE(stats.sizeBytes, maxSizeBytes + SampleHistoryStore::BlockSize);
+            ASSERT_GT(stats.blocksCount, 1u);
+            ASSERT_EQ(createSample(count - 1).timeMs, stats.lastTimeMs);
+            ASSERT_EQ(stats.samplesCount, size_t(scanned));
+            ASSERT_TRUE(ordered);
+            ASSERT_EQ(stats.lastTimeMs, previousTimeMs);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <SyntheticDevice.h>
+#include <common/InvalidOperationException.h>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class SyntheticDeviceTests : public BaseTest
+        {
+        protected:
+            std::chrono::steady_clock::time_point after(int milliseconds)
+            {
+                return std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+            }
+        };
+
+        TEST_F(SyntheticDeviceTests, ShouldGenerateSamplesAtConfiguredRate)
+        {
+            // Arrange
+            SyntheticDeviceSettings settings;
+            settings.rateHz = 1000;
+            settings.amplitude = 0;
+            settings.noise = 0;
+            settings.invalidShare = 0;
+            SyntheticDevice device(settings);
+            device.sendAuto(-5);
+
+            // Act
+            auto samples = device.readSamplesDue(after(1000));
+
+            // Assert
+            ASSERT_EQ(1000, device.samplingRateHz());
+            ASSERT_NEAR(1001, samples.size(), 2);
+            ASSERT_EQ(500, samples[500].time.toMSecsSinceEpoch() - samples[0].time.toMSecsSinceEpoch());
+            for (auto& sample : samples)
+            {
+                ASSERT_EQ(settings.field, sample.field);
+                ASSERT_TRUE(device.validateSample(sample));
+            }
+        }
+
+        TEST_F(SyntheticDeviceTests, ShouldFollowRunCommandRateIfNotConfigured)
+        {
+            // Arrange
+            SyntheticDevice device((SyntheticDeviceSettings()));
+
+            // Act
+            device.sendAuto(-5);
+            double fastRateHz = device.samplingRateHz();
+            device.sendAuto(2);
+            double slowRateHz = device.samplingRateHz();
+
+            // Assert
+            ASSERT_EQ(5, fastRateHz);
+            ASSERT_EQ(0.5, slowRateHz);
+        }
+
+        TEST_F(SyntheticDeviceTests, ShouldGenerateInvalidSamplesAndGaps)
+        {
+            // Arrange
+            SyntheticDeviceSettings invalidSettings;
+            invalidSettings.rateHz = 100;
+            invalidSettings.invalidShare = 1;
+            SyntheticDevice invalidDevice(invalidSettings);
+            invalidDevice.sendAuto(-1);
+            SyntheticDeviceSettings gapSettings;
+            gapSettings.rateHz = 100;
+            gapSettings.gapsPerHour = 3600;
+            gapSettings.gapSeconds = 0.5;
+            SyntheticDevice gapDevice(gapSettings);
+            gapDevice.sendAuto(-1);
+
+            // Act
+            auto invalidSamples = invalidDevice.readSamplesDue(after(10000));
+            auto gapSamples = gapDevice.readSamplesDue(after(100000));
+
+            // Assert
+            ASSERT_FALSE(invalidSamples.isEmpty());
+            for (auto& sample : invalidSamples)
+            {
+                ASSERT_FALSE(invalidDevice.validateSample(sample));
+            }
+            // a gap of 50 samples starts about every 100 samples
+            ASSERT_GT(gapSamples.size(), 5000);
+            ASSERT_LT(gapSamples.size(), 9000);
+        }
+
+        TEST_F(SyntheticDeviceTests, ShouldStopOnEnqAndRejectInvalidRate)
+        {
+            // Arrange
+            SyntheticDeviceSettings settings;
+            settings.rateHz = 10000;
+            SyntheticDevice device(settings);
+            device.sendAuto(-5);
+
+            // Act
+            device.sendEnq();
+
+            // Assert
+            ASSERT_FALSE(device.hasPendingInput());
+            ASSERT_TRUE(device.readSamplesDue(after(1000)).isEmpty());
+            settings.rateHz = 20000;
+            ASSERT_THROW(SyntheticDevice tooFast(settings), InvalidOperationException);
+            settings.rateHz = 10000;
+            settings.periodSeconds = 0;
+            ASSERT_THROW(SyntheticDevice noPeriod(settings), InvalidOperationException);
+        }
+    }
+}
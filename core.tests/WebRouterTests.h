@@ -0,0 +1,85 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include "BaseTest.h"
+#include <WebRouter.h>
+#include <common/InvalidOperationException.h>
+
+using namespace common;
+
+namespace core
+{
+    namespace tests
+    {
+        class WebRouterTests : public BaseTest
+        {
+        };
+
+        TEST_F(WebRouterTests, ShouldMatchLiteralRoutesByMethod)
+        {
+            // Arrange
+            WebRouter router;
+            QString executed;
+            router.add("GET", "api/data", nullptr, [&executed]() { executed = "data"; });
+            router.add("GET", "api/data/binary", nullptr, [&executed]() { executed = "binary"; });
+            router.add("POST", "api/command", nullptr, [&executed]() { executed = "command"; });
+            WebRouter::Parameters parameters;
+
+            // Act
+            auto data = router.match("GET", "/api/data", parameters);
+            auto binary = router.match("GET", "/api/data/binary/", parameters);
+            auto wrongMethod = router.match("GET", "/api/command", parameters);
+            auto unknown = router.match("GET", "/api/data/other", parameters);
+
+            // Assert
+            ASSERT_TRUE(data != nullptr);
+            ASSERT_TRUE(binary != nullptr);
+            ASSERT_TRUE(wrongMethod == nullptr);
+            ASSERT_TRUE(unknown == nullptr);
+            binary->action();
+            ASSERT_EQ(QString("binary"), executed);
+            ASSERT_TRUE(parameters.isEmpty());
+        }
+
+        TEST_F(WebRouterTests, ShouldExtractParametersAndPreferLiterals)
+        {
+            // Arrange
+            WebRouter router;
+            router.add("GET", "api/command/{id}", nullptr, []() {});
+            router.add("GET", "api/command/latest", nullptr, []() {});
+            router.add("GET", "files/{path*}", nullptr, []() {});
+            WebRouter::Parameters commandParameters;
+            WebRouter::Parameters latestParameters;
+            WebRouter::Parameters fileParameters;
+
+            // Act
+            auto command = router.match("GET", "/api/command/42", commandParameters);
+            auto latest = router.match("GET", "/api/command/latest", latestParameters);
+            auto file = router.match("GET", "/files/js/app.js", fileParameters);
+
+            // Assert
+            ASSERT_EQ(QByteArray("api/command/{id}"), command->pattern);
+            ASSERT_EQ(1, commandParameters.size());
+            ASSERT_EQ(QByteArray("id"), commandParameters[0].first);
+            ASSERT_EQ(QByteArray("42"), commandParameters[0].second);
+            ASSERT_EQ(QByteArray("api/command/latest"), latest->pattern);
+            ASSERT_TRUE(latestParameters.isEmpty());
+            ASSERT_EQ(QByteArray("files/{path*}"), file->pattern);
+            ASSERT_EQ(QByteArray("js/app.js"), fileParameters[0].second);
+        }
+
+        TEST_F(WebRouterTests, ShouldRejectDuplicateAndMalformedRoutes)
+        {
+            // Arrange
+            WebRouter router;
+            router.add("GET", "api/status", nullptr, []() {});
+
+            // Act, Assert
+            ASSERT_THROW(router.add("GET", "/api/status/", nullptr, []() {}), InvalidOperationException);
+            ASSERT_THROW(router.add("GET", "api/{id", nullptr, []() {}), InvalidOperationException);
+            ASSERT_THROW(router.add("GET", "api/{rest*}/more", nullptr, []() {}), InvalidOperationException);
+            router.add("POST", "api/status", nullptr, []() {});
+            ASSERT_EQ(2, router.size());
+        }
+    }
+}
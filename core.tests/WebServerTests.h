@@ -3,8 +3,14 @@
 #include <gtest/gtest.h>
 #include "BaseTest.h"
 #include <WebServer.h>
+#include <StaticFilesActionHandler.h>
 #include <Helpers.h>
 #include <mongoose/mongoose.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <QTemporaryDir>
 
 using namespace common;
 
@@ -27,7 +33,7 @@ namespace core
 
             void execute() override
             {
-                mg_printf_data(connection(), "{ \"result\": \"Some Test Data\" }");
+                response().write("{ \"result\": \"Some Test Data\" }");
             }
         };
 
@@ -46,13 +52,86 @@ namespace core
 
             void execute() override
             {
-                QString content(QByteArray(connection()->content, connection()->content_len));
+                QString content(request().content());
                 qDebug() << content;
                 
-                mg_printf_data(connection(), content.toLatin1());
+                response().write(content.toLatin1());
             }
         };
 
+        class SlowTestActionHandler : public WebServerActionHandler
+        {
+        public:
+            SlowTestActionHandler() : _entered(false), _released(false)
+            {
+            }
+
+            QString name() const override
+            {
+                return "SlowTestActionHandler";
+            }
+
+            bool match() override
+            {
+                return this->exactMatch("api/slow");
+            }
+
+            void execute() override
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _entered = true;
+                _enteredCondition.notify_all();
+                _releasedCondition.wait_for(lock, std::chrono::seconds(10), [this]() { return _released; });
+                response().write(_released ? "released" : "timeout");
+            }
+
+            // Returns true once a request is being executed (and waits for the release).
+            bool waitEntered(int timeoutMs)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                return _enteredCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return _entered; });
+            }
+
+            void release()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _released = true;
+                _releasedCondition.notify_all();
+            }
+        private:
+            std::mutex _mutex;
+            std::condition_variable _enteredCondition;
+            std::condition_variable _releasedCondition;
+            bool _entered;
+            bool _released;
+        };
+
+        class ReleaseTestActionHandler : public WebServerActionHandler
+        {
+        public:
+            explicit ReleaseTestActionHandler(std::shared_ptr<SlowTestActionHandler> slowHandler) : _slowHandler(slowHandler)
+            {
+            }
+
+            QString name() const override
+            {
+                return "ReleaseTestActionHandler";
+            }
+
+            bool match() override
+            {
+                return this->exactMatch("api/release");
+            }
+
+            void execute() override
+            {
+                _slowHandler->release();
+                response().write("released");
+            }
+        private:
+            std::shared_ptr<SlowTestActionHandler> _slowHandler;
+        };
+
         class WebServerTests : public BaseTest
         {
         };
@@ -88,5 +167,84 @@ namespace core
             qDebug() << "200, data: " << responseText;
             ASSERT_TRUE(responseText == "{ \"command\": \"FIRE\" }");
         }
+
+        TEST_F(WebServerTests, ShouldServeRequestsWhileAnotherRequestIsRunning)
+        {
+            // Arrange
+            auto server = std::make_shared<WebServer>();
+            server->port(8002);
+            auto slowHandler = std::make_shared<SlowTestActionHandler>();
+            server->addActionHandler(slowHandler);
+            server->addActionHandler(std::make_shared<ReleaseTestActionHandler>(slowHandler));
+            server->addActionHandler(std::make_shared<TestActionHandler>());
+            server->runAsync();
+            QString slowResponseText;
+            std::atomic<bool> slowResponded(false);
+            std::thread slowClient([&slowResponseText, &slowResponded]()
+            {
+                slowResponseText = sHelpers.getResponse("http://localhost:8002/api/slow");
+                slowResponded = true;
+            });
+
+            // Act: the fast request is sent only once the slow one holds its worker
+            bool slowEntered = slowHandler->waitEntered(5000);
+            auto fastResponseText = sHelpers.getResponse("http://localhost:8002/api/test");
+            bool slowPendingAfterFastResponse = !slowResponded;
+            auto releaseResponseText = sHelpers.getResponse("http://localhost:8002/api/release");
+            slowClient.join();
+
+            // Assert
+            ASSERT_TRUE(slowEntered);
+            ASSERT_EQ(QString("{ \"result\": \"Some Test Data\" }"), fastResponseText);
+            ASSERT_TRUE(slowPendingAfterFastResponse);
+            ASSERT_EQ(QString("released"), releaseResponseText);
+            ASSERT_EQ(QString("released"), slowResponseText);
+        }
+
+        TEST_F(WebServerTests, ShouldServeStaticFilesFromPublicDirectory)
+        {
+            // Arrange
+            QTemporaryDir publicDir;
+            ASSERT_TRUE(publicDir.isValid());
+            QFile indexFile(publicDir.path() + "/index.html");
+            ASSERT_TRUE(indexFile.open(QIODevice::WriteOnly));
+            indexFile.write("<html>gemlogd</html>");
+            indexFile.close();
+            auto server = std::make_shared<WebServer>();
+            server->port(8003);
+            server->addActionHandler(std::make_shared<TestActionHandler>());
+            server->addActionHandler(std::make_shared<StaticFilesActionHandler>(publicDir.path(), 60));
+            server->runAsync();
+
+            // Act
+            auto indexText = sHelpers.getResponse("http://localhost:8003/");
+            auto apiText = sHelpers.getResponse("http://localhost:8003/api/test");
+
+            // Assert
+            ASSERT_EQ(QString("<html>gemlogd</html>"), indexText);
+            ASSERT_EQ(QString("{ \"result\": \"Some Test Data\" }"), apiText);
+        }
+
+        TEST_F(WebServerTests, ShouldStopServerThreadAndReleasePortWhenDestroyed)
+        {
+            // Arrange
+            auto server = std::make_shared<WebServer>();
+            server->port(8004);
+            server->addActionHandler(std::make_shared<TestActionHandler>());
+            server->runAsync();
+            auto firstText = sHelpers.getResponse("http://localhost:8004/api/test");
+
+            // Act: the server thread is joined and the listening socket closed
+            server.reset();
+            auto secondServer = std::make_shared<WebServer>();
+            secondServer->port(8004);
+            secondServer->addActionHandler(std::make_shared<TestActionHandler>());
+            secondServer->runAsync();
+            auto secondText = sHelpers.getResponse("http://localhost:8004/api/test");
+
+            // Assert
+            ASSERT_EQ(QString("{ \"result\": \"Some Test Data\" }"), firstText);
+            ASSERT_EQ(QString("{ \"result\": \"Some Test Data\" }"), secondText);
+        }
     }
 }
@@ -4,8 +4,16 @@
 
 #pragma once
 
+#include "AggregatePyramidTests.h"
 #include "EbDeviceTests.h"
+#include "EbFrameCodecTests.h"
 #include "EnvironmentTests.h"
+#include "HistoryDownsamplerTests.h"
 #include "JsonTests.h"
 #include "MSeedWriterTests.h"
+#include "RunnerCommandsTests.h"
+#include "SampleColumnsTests.h"
+#include "SampleHistoryStoreTests.h"
+#include "SyntheticDeviceTests.h"
+#include "WebRouterTests.h"
 #include "WebServerTests.h"
@@ -0,0 +1,94 @@
+#include "AggregatePyramid.h"
+#include <cstring>
+#include <thread>
+
+core::AggregatePyramid::AggregatePyramid()
+: _seconds(capacity(Seconds)), _minutes(capacity(Minutes)), _hours(capacity(Hours)), _openSequence(0)
+{
+    memset(&_open, 0, sizeof(_open));
+    memset(&_openPublished, 0, sizeof(_openPublished));
+}
+
+int64_t core::AggregatePyramid::bucketWidthMs(Level level)
+{
+    switch (level)
+    {
+    case Seconds:
+        return 1000;
+    case Minutes:
+        return 60 * 1000;
+    default:
+        return 60 * 60 * 1000;
+    }
+}
+
+size_t core::AggregatePyramid::capacity(Level level)
+{
+    switch (level)
+    {
+    case Seconds:
+        return 60 * 60;
+    case Minutes:
+        return 7 * 24 * 60;
+    default:
+        return 365 * 24;
+    }
+}
+
+void core::AggregatePyramid::add(int64_t timeMs, int32_t value)
+{
+    for (int i = 0; i < LevelsCount; i++)
+    {
+        auto level = static_cast<Level>(i);
+        auto& bucket = _open.buckets[i];
+        int64_t width = bucketWidthMs(level);
+        int64_t startMs = timeMs - ((timeMs % width) + width) % width;
+        if (bucket.count > 0 && bucket.startMs != startMs)
+        {
+            ring(level).push(bucket);
+            bucket.count = 0;
+        }
+        if (bucket.count == 0)
+        {
+            bucket.startMs = startMs;
+            bucket.sum = 0;
+            bucket.min = value;
+            bucket.max = value;
+        }
+        bucket.sum += value;
+        bucket.count++;
+        if (value < bucket.min)
+        {
+            bucket.min = value;
+        }
+        if (value > bucket.max)
+        {
+            bucket.max = value;
+        }
+    }
+    uint64_t sequence = _openSequence.load(std::memory_order_relaxed);
+    _openSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&_openPublished, &_open, sizeof(_open));
+    _openSequence.store(sequence + 2, std::memory_order_release);
+}
+
+core::SampleAggregate core::AggregatePyramid::current(Level level) const
+{
+    OpenBuckets copy;
+    while (true)
+    {
+        uint64_t before = _openSequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            std::memcpy(&copy, &_openPublished, sizeof(copy));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_openSequence.load(std::memory_order_relaxed) == before)
+            {
+                return copy.buckets[level];
+            }
+        }
+        // the runner is copying a few dozen bytes, the next attempt succeeds shortly
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,91 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   AggregatePyramid.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SeqLockRing.h>
+#include <atomic>
+#include <cstdint>
+
+namespace core
+{
+    // Ring slot, copied as raw memory
+    struct SampleAggregate
+    {
+        int64_t startMs;
+        int64_t sum;
+        int32_t min;
+        int32_t max;
+        int32_t count;
+        int32_t reserved;
+    };
+
+    // Rolling min/max/mean/count of the field at 1 s, 1 min and 1 h resolution.
+    // The runner adds every sample in O(1); completed buckets go to fixed rings per level, the buckets still
+    // being filled are published separately. Readers on any thread never block the runner.
+    class AggregatePyramid
+    {
+    public:
+        enum Level
+        {
+            Seconds,
+            Minutes,
+            Hours,
+            LevelsCount
+        };
+
+        AggregatePyramid();
+
+        static int64_t bucketWidthMs(Level level);
+        // Number of completed buckets kept: 1 hour of seconds, 7 days of minutes, 1 year of hours.
+        static size_t capacity(Level level);
+
+        // Runner thread only, samples are expected in time order.
+        void add(int64_t timeMs, int32_t value);
+
+        // Calls consumer(id, aggregate) for the completed buckets with id > afterId, oldest first. Returns the cursor.
+        template<typename Consumer>
+        uint64_t readSince(Level level, uint64_t afterId, Consumer consumer) const
+        {
+            return ring(level).readSince(afterId, consumer);
+        }
+
+        uint64_t lastId(Level level) const
+        {
+            return ring(level).lastId();
+        }
+
+        // The bucket being filled (count == 0 if there is none), always a consistent copy.
+        SampleAggregate current(Level level) const;
+    private:
+        struct OpenBuckets
+        {
+            SampleAggregate buckets[LevelsCount];
+        };
+
+        common::SeqLockRing<SampleAggregate>& ring(Level level)
+        {
+            return level == Seconds ? _seconds : level == Minutes ? _minutes : _hours;
+        }
+
+        const common::SeqLockRing<SampleAggregate>& ring(Level level) const
+        {
+            return level == Seconds ? _seconds : level == Minutes ? _minutes : _hours;
+        }
+
+        common::SeqLockRing<SampleAggregate> _seconds;
+        common::SeqLockRing<SampleAggregate> _minutes;
+        common::SeqLockRing<SampleAggregate> _hours;
+        OpenBuckets _open;
+        // Latest copy of _open for the readers behind a single-writer seqlock: the sequence is odd while
+        // the copy is being written
+        std::atomic<uint64_t> _openSequence;
+        OpenBuckets _openPublished;
+    };
+}
@@ -30,43 +30,100 @@ void core::BufferedLogger::fatal(const QString& message)
     write(common::Fatal, message);
 }
 
-void core::BufferedLogger::write(common::LogLevel logLevel, const QString& message)
+QString core::BufferedLogger::levelName(common::LogLevel logLevel)
+{
+    return QString::fromLatin1(levelCode(logLevel));
+}
+
+const char* core::BufferedLogger::levelCode(common::LogLevel logLevel)
 {
-    QString levelMsg;
     switch (logLevel)
     {
     case common::Debug:
-        levelMsg = "DEBUG";
-        break;
+        return "DEBUG";
     case common::Trace:
-        levelMsg = "TRACE";
-        break;
+        return "TRACE";
     case common::Info:
-        levelMsg = "INFO";
-        break;
+        return "INFO";
     case common::Warn:
-        levelMsg = "WARN";
-        break;
+        return "WARN";
     case common::Error:
-        levelMsg = "ERROR";
-        break;
+        return "ERROR";
     case common::Fatal:
-        levelMsg = "FATAL";
-        break;
+        return "FATAL";
     default:
-        break;
+        return "";
     }
+}
 
-    BufferMessage result;
-    result.time = QDateTime::currentDateTimeUtc();
-    result.logLevel = levelMsg;
-    result.message = message;
-    result.id = this->id++;
+void core::BufferedLogger::write(common::LogLevel logLevel, const QString& message)
+{
+    if (!enabled(logLevel))
+    {
+        return;
+    }
+    auto timeMs = QDateTime::currentMSecsSinceEpoch();
+    auto utf8 = message.toUtf8();
+    {
+        std::lock_guard<std::mutex> lock(_repeatsMutex);
+        common::LogRepeats repeats;
+        bool write = _repeats.add(logLevel, utf8, timeMs, repeats);
+        if (!write && repeats.count == 0)
+        {
+            return;
+        }
+        if (repeats.count > 0)
+        {
+            push(repeats.level, timeMs, common::LogRepeatCollapser::repeatedMessage(repeats.count).toUtf8());
+        }
+        if (write)
+        {
+            push(logLevel, timeMs, utf8);
+        }
+    }
+    if (_writeListener)
+    {
+        _writeListener();
+    }
+}
+
+void core::BufferedLogger::push(int logLevel, qint64 timeMs, const QByteArray& utf8)
+{
+    BufferRecord record;
+    record.timeMs = timeMs;
+    record.logLevel = logLevel;
 
-    //auto result = QString("%1 [%2]: %3").arg(QDateTime::currentDateTimeUtc().toString(Qt::DateFormat::ISODate), levelMsg, message);
-    messageBuffer.push_back(result);
-    if (messageBuffer.size() > this->maxBufferSize)
+    int size = utf8.size();
+    if (size > BufferRecord::MaxMessageSize)
+    {
+        // do not cut a multi-byte character in half
+        size = BufferRecord::MaxMessageSize;
+        while (size > 0 && (static_cast<unsigned char>(utf8[size]) & 0xC0) == 0x80)
+        {
+            size--;
+        }
+    }
+    record.messageSize = size;
+    memcpy(record.message, utf8.constData(), size);
+
+    messageBuffer.push(record);
+}
+
+QList<core::BufferMessage> core::BufferedLogger::readSince(uint64_t afterId, uint64_t* cursor) const
+{
+    QList<BufferMessage> result;
+    auto lastId = messageBuffer.readSince(afterId, [&result](uint64_t id, const BufferRecord& record)
+    {
+        BufferMessage message;
+        message.time = QDateTime::fromMSecsSinceEpoch(record.timeMs, Qt::UTC);
+        message.logLevel = levelName(static_cast<common::LogLevel>(record.logLevel));
+        message.message = QString::fromUtf8(record.message, record.messageSize);
+        message.id = id;
+        result.push_back(message);
+    });
+    if (cursor)
     {
-        messageBuffer.pop_front();
+        *cursor = lastId;
     }
+    return result;
 }
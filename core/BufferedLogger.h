@@ -10,7 +10,11 @@
 #pragma once
 
 #include <QtCore/QtCore>
+#include <functional>
 #include "common/Logger.h"
+#include "common/SeqLockRing.h"
+#include "common/LogRepeatCollapser.h"
+#include <mutex>
 
 namespace core
 {
@@ -22,18 +26,39 @@ namespace core
         uint64_t id;
     };
 
+    // Ring slot, copied as raw memory
+    struct BufferRecord
+    {
+        static const int MaxMessageSize = 240;
+
+        qint64 timeMs;
+        int32_t logLevel;
+        int32_t messageSize;
+        char message[MaxMessageSize]; // UTF-8, not terminated
+    };
+
+    // Preallocated multi-writer ring: any thread may write, readers copy out the messages after a given id
+    // without blocking writers. Longer messages are truncated to BufferRecord::MaxMessageSize bytes.
+    // Runs of identical messages take a single slot plus a "Last message repeated N times." one.
     class BufferedLogger
     {
-        int maxBufferSize;
-        int id;
-        QList<BufferMessage> messageBuffer;
+        common::SeqLockRing<BufferRecord> messageBuffer;
     public:
         SMART_PTR_T(BufferedLogger);
 
-        explicit BufferedLogger(int maxBufferSize = 1000)
+        explicit BufferedLogger(int maxBufferSize = 1000) : messageBuffer(maxBufferSize), _logLevel(common::Debug)
         {
-            this->id = 1;
-            this->maxBufferSize = maxBufferSize;
+        }
+
+        // Messages less severe than logLevel are not buffered. Set before logging starts.
+        void initialize(common::LogLevel logLevel)
+        {
+            _logLevel = logLevel;
+        }
+
+        bool enabled(common::LogLevel logLevel) const
+        {
+            return _logLevel >= logLevel;
         }
 
         void debug(const QString& message);
@@ -44,9 +69,42 @@ namespace core
         void fatal(const QString& message);
         void write(common::LogLevel logLevel, const QString& message);
 
-        const QList<BufferMessage>& buffer() const
+        // All buffered messages, oldest first.
+        QList<BufferMessage> buffer() const
+        {
+            return readSince(0);
+        }
+
+        // Messages with id > afterId, oldest first. If cursor is set it receives the id to pass to the next call.
+        QList<BufferMessage> readSince(uint64_t afterId, uint64_t* cursor = nullptr) const;
+
+        // Calls consumer(id, record) for the buffered records with id > afterId without converting them, returns the cursor.
+        template<typename Consumer>
+        uint64_t readRecordsSince(uint64_t afterId, Consumer consumer) const
+        {
+            return messageBuffer.readSince(afterId, consumer);
+        }
+
+        uint64_t lastId() const
         {
-            return messageBuffer;
+            return messageBuffer.lastId();
         }
+
+        static QString levelName(common::LogLevel logLevel);
+        static const char* levelCode(common::LogLevel logLevel);
+
+        // Called by write() on the writing thread after the message has been buffered. Set before logging starts.
+        void writeListener(std::function<void()> listener)
+        {
+            _writeListener = listener;
+        }
+    private:
+        void push(int logLevel, qint64 timeMs, const QByteArray& utf8);
+
+        int _logLevel;
+        // writers only, serializes the repeats check with the pushes
+        std::mutex _repeatsMutex;
+        common::LogRepeatCollapser _repeats;
+        std::function<void()> _writeListener;
     };
 }
@@ -0,0 +1,20 @@
+#include "CachedResponse.h"
+#include <common/Compression.h>
+
+core::CachedResponse::CachedResponse(const QByteArray& contentType, const QByteArray& body, const QByteArray& etag,
+    const QByteArray& cacheControl)
+: contentType(contentType), etag(etag), cacheControl(cacheControl), body(body)
+{
+    if (body.size() < MinCompressedSize)
+    {
+        return;
+    }
+    deflated = common::Compression::deflate(body);
+    if (deflated.size() >= body.size())
+    {
+        deflated.clear();
+        return;
+    }
+    // the same compressed data, only framed differently
+    gzipped = common::Compression::gzipFromDeflated(deflated, body);
+}
@@ -0,0 +1,42 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   CachedResponse.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SmartPtr.h>
+#include <QtCore>
+
+namespace core
+{
+    // Serialized response body together with its precompressed variants, immutable once built,
+    // so the same instance can be sent again while the data it was built from has not changed.
+    struct CachedResponse
+    {
+        SMART_PTR_T(CachedResponse);
+
+        // Smaller bodies are not worth compressing
+        static const int MinCompressedSize = 256;
+
+        CachedResponse() : cacheControl("no-cache")
+        {
+        }
+
+        // etag is the quoted entity tag, empty if the response should not be validated.
+        CachedResponse(const QByteArray& contentType, const QByteArray& body, const QByteArray& etag = QByteArray(),
+            const QByteArray& cacheControl = "no-cache");
+
+        QByteArray contentType;
+        QByteArray etag;
+        QByteArray cacheControl;
+        QByteArray body;
+        // empty if compression does not pay off
+        QByteArray gzipped;
+        QByteArray deflated;
+    };
+}
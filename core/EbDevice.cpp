@@ -1,23 +1,53 @@
 ﻿#include "EbDevice.h"
+#include "EbFrameCodec.h"
 #include "common/Logger.h"
 #include "SerialPortBinaryStream.h"
 #include "common/InvalidOperationException.h"
 #include "common/NotSupportedException.h"
+#include "common/Metrics.h"
+#include "common/Tracer.h"
+
+namespace
+{
+    common::MetricCounter& serialBytesRead = sMetrics.counter("gem_serial_read_bytes_total", "Bytes read from the device serial port.");
+    common::MetricCounter& framesDecoded = sMetrics.counter("gem_frames_decoded_total", "Response frames decoded from the serial input.");
+    common::MetricCounter& unescapeErrors = sMetrics.counter("gem_unescape_errors_total", "Malformed escape sequences in the serial input.");
+    common::MetricCounter& invalidFrames = sMetrics.counter("gem_invalid_frames_total", "Decoded frames rejected as too short for a sample.");
+    common::MetricCounter& samplesParsed = sMetrics.counter("gem_samples_parsed_total", "Samples parsed from the device frames.");
+    common::MetricCounter& samplesInvalid = sMetrics.counter("gem_samples_invalid_total", "Parsed samples without the valid state.");
+
+    // bits 0-6 of EbDevice::SampleState
+    common::MetricCounter& stateFlagCounter(int bit)
+    {
+        static const char* const FlagNames[] = { "NUMERR", "TIMERR", "NOISEERR", "RESERVED", "OUTERR", "FAILED", "PWERR" };
+        static const std::vector<common::MetricCounter*> counters = []()
+        {
+            std::vector<common::MetricCounter*> result;
+            for (auto flagName : FlagNames)
+            {
+                result.push_back(&sMetrics.counter("gem_sample_state_flags_total", "Error flags in the state of the parsed samples.",
+                    std::string("flag=\"") + flagName + "\""));
+            }
+            return result;
+        }();
+        return *counters[bit];
+    }
+}
 
 core::EbDeviceException::EbDeviceException(const QString& message): common::Exception(message)
 {
 }
 
 core::EbDevice::EbDevice(BufferedLogger::SharedPtr_t logger) :
-    _bitConverter(common::BitConverter::EByteOrder::MostSignificantByte),
     _mode(Binary),
+    _samplingRateHz(0),
     _logger(logger)
 {
 }
 
 void core::EbDevice::connect(QString portName)
 {
-    sLogger.debug(QString("Connecting to port %1...").arg(portName));
+    LOG_DEBUG(QString("Connecting to port %1...").arg(portName));
     _serialPort.setPortName(portName);
     _serialPort.setBaudRate(QSerialPort::Baud9600);
     _serialPort.setFlowControl(QSerialPort::NoFlowControl);
@@ -26,13 +56,13 @@ void core::EbDevice::connect(QString portName)
     _serialPort.setStopBits(QSerialPort::OneStop);
     _serialPort.open(QIODevice::ReadWrite);
     _serialPort.setBreakEnabled(false);
-    sLogger.debug("Connected, sending ENQ to interrupt auto mode that might be running...");
+    LOG_DEBUG("Connected, sending ENQ to interrupt auto mode that might be running...");
     sendEnq();
     waitForInputSilence();
-    sLogger.debug("Sending setMode : binary...");
+    LOG_DEBUG("Sending setMode : binary...");
     sendSetMode(Mode::Binary);
     _mode = readSetMode();
-    sLogger.debug("Done connecting.");
+    LOG_DEBUG("Done connecting.");
 }
 
 void core::EbDevice::sendEnq()
@@ -103,7 +133,7 @@ void core::EbDevice::sendSetTime(QDateTime dateTime)
     {
         QByteArray command("time xxxx");
         uint32_t unixtime = dateTime.toTime_t();
-        _bitConverter.ToByteArray(unixtime, command.data() + 5);
+        common::BigEndianConverter::ToByteArray(unixtime, command.data() + 5);
         sendCommand(command);
         break;
     }
@@ -154,7 +184,7 @@ void core::EbDevice::sendSetRange(uint32_t center)
     case Binary:
     {
         auto command = QByteArray("range xxxx");
-        _bitConverter.ToByteArray(center, command.data() + 6);
+        common::BigEndianConverter::ToByteArray(center, command.data() + 6);
         sendCommand(command);
         break;
     }
@@ -170,6 +200,7 @@ void core::EbDevice::sendRun()
 
 void core::EbDevice::sendAuto(int32_t freq)
 {
+    _samplingRateHz = freq < 0 ? -freq : 1.0 / freq;
     switch (_mode)
     {
     case Text:
@@ -181,7 +212,7 @@ void core::EbDevice::sendAuto(int32_t freq)
     case Binary:
     {
         auto command = QByteArray("auto xxxx");
-        _bitConverter.ToByteArray(freq, command.data() + 5);
+        common::BigEndianConverter::ToByteArray(freq, command.data() + 5);
         sendCommand(command, 5000);
         break;
     }
@@ -245,7 +276,7 @@ core::EbDevice::Mode core::EbDevice::readSetMode()
 QDateTime core::EbDevice::readGetTime()
 {
     auto data = readLastResponseMessage();
-    uint32_t unixtime = _bitConverter.GetUInt32(data);
+    uint32_t unixtime = common::BigEndianConverter::GetUInt32(data);
     return QDateTime::fromTime_t(unixtime, Qt::UTC);
 }
 
@@ -277,8 +308,8 @@ core::EbDevice::RangeData core::EbDevice::readGetRange()
     }
     RangeData data;
     auto response = readLastResponseMessage();
-    data.minField = _bitConverter.GetInt32(response);
-    data.maxField = _bitConverter.GetInt32(response.data() + 4);
+    data.minField = common::BigEndianConverter::GetInt32(response);
+    data.maxField = common::BigEndianConverter::GetInt32(response.data() + 4);
     return data;
 }
 
@@ -293,31 +324,60 @@ QList<core::EbDevice::Sample> core::EbDevice::readAllSamples(int readTimeout)
     QList<Sample> result;
     for (auto& resp : responses)
     {
-        auto respPtr = resp.data();
-        result.push_back(parseSample(respPtr));
+        if (checkSampleFrame(resp))
+        {
+            result.push_back(parseSample(resp.data()));
+        }
     }
     return result;
 }
 
+bool core::EbDevice::checkSampleFrame(const QByteArray& frame)
+{
+    if (frame.size() >= SampleFrameSize)
+    {
+        return true;
+    }
+    invalidFrames.add();
+    LOG_MEMBER_LIMITED(common::Warn, 1, 5, QString("EbDevice skipped a sample frame of %1 bytes, %2 expected.").arg(frame.size()).arg(SampleFrameSize));
+    return false;
+}
+
 core::EbDevice::Sample core::EbDevice::parseSample(char* dataPtr)
 {
     Sample data;
-    data.field = _bitConverter.GetInt32(dataPtr);
-    data.qmc = _bitConverter.GetUInt16(dataPtr + 4);
-    data.state = static_cast<SampleState>(_bitConverter.GetUInt8(dataPtr + 6));
-    auto time = _bitConverter.GetInt32(dataPtr + 7);
-    auto pph = _bitConverter.GetUInt8(dataPtr + 11);
+    data.field = common::BigEndianConverter::GetInt32(dataPtr);
+    data.qmc = common::BigEndianConverter::GetUInt16(dataPtr + 4);
+    data.state = static_cast<SampleState>(common::BigEndianConverter::GetUInt8(dataPtr + 6));
+    auto time = common::BigEndianConverter::GetInt32(dataPtr + 7);
+    auto pph = common::BigEndianConverter::GetUInt8(dataPtr + 11);
     auto dateTime = QDateTime::fromTime_t(time, Qt::UTC);
     dateTime = dateTime.addMSecs(pph * 10);
     data.time = dateTime;
+
+    samplesParsed.add();
+    if (data.state != SampleState::Valid)
+    {
+        samplesInvalid.add();
+        for (int bit = 0; bit < 7; bit++)
+        {
+            if (data.state & (1 << bit))
+            {
+                stateFlagCounter(bit).add();
+            }
+        }
+    }
     return data;
 }
 
 core::EbDevice::Sample core::EbDevice::readOneSample()
 {
     auto resp = readLastResponseMessage();
-    auto respPtr = resp.data();
-    return parseSample(respPtr);
+    if (!checkSampleFrame(resp))
+    {
+        throw EbDeviceException(QString("EbDevice got a sample frame of %1 bytes, %2 expected.").arg(resp.size()).arg(SampleFrameSize));
+    }
+    return parseSample(resp.data());
 }
 
 bool core::EbDevice::validateSample(const Sample& sample)
@@ -448,6 +508,7 @@ void core::EbDevice::runTestAutoSequence()
 
 void core::EbDevice::sendCommand(QByteArray command, int delayMilliseconds, bool escape)
 {
+    TRACE_SPAN("EbDevice::sendCommand");
     if (escape)
     {
         command = escapeData(command);
@@ -462,7 +523,10 @@ void core::EbDevice::sendCommand(QByteArray command, int delayMilliseconds, bool
     {
         throw EbDeviceException(QString("EbDevice command execution error: `waitForBytesWritten timeout exceeded`. Error string: `%1`.").arg(_serialPort.errorString()));
     }
-    QThread::msleep(delayMilliseconds);
+    {
+        TRACE_SPAN("EbDevice::sendCommand delay");
+        QThread::msleep(delayMilliseconds);
+    }
 }
 
 QByteArray core::EbDevice::readLastResponseMessage(int readTimeout)
@@ -474,22 +538,32 @@ QByteArray core::EbDevice::readLastResponseMessage(int readTimeout)
     }
     if (messages.size() > 1)
     {
-        logDebug(QString("EbDevice read notice: skipping %1 response messages.").arg(messages.size() - 1));
+        LOG_MEMBER(common::Debug, QString("EbDevice read notice: skipping %1 response messages.").arg(messages.size() - 1));
     }
     return messages.last();
 }
 
 QList<QByteArray> core::EbDevice::readAllResponseMessages(int readTimeout)
 {
-    logDebug(QString("EbDevice is reading pending response messages..."));
+    TRACE_SPAN("EbDevice::readAllResponseMessages");
+    LOG_MEMBER_LIMITED(common::Debug, 1, 5, QString("EbDevice is reading pending response messages..."));
     QList<QByteArray> result;
     if (!_serialPort.waitForReadyRead(readTimeout))
     {
-        logDebug(QString("EbDevice read data suspicious behavior: `waitForReadyRead timeout exceeded`. Error string: %1.").arg(_serialPort.errorString()));
+        LOG_MEMBER(common::Debug, QString("EbDevice read data suspicious behavior: `waitForReadyRead timeout exceeded`. Error string: %1.").arg(_serialPort.errorString()));
         return result;
     }
     auto data = _serialPort.read(SerialPortReadBufferSize);
+    serialBytesRead.add(data.size());
+
+    result = decodeResponseMessages(data);
+    LOG_MEMBER_LIMITED(common::Debug, 1, 5, QString("EbDevice response messages: %1 messages read in total.").arg(result.size()));
+    return result;
+}
 
+QList<QByteArray> core::EbDevice::decodeResponseMessages(const QByteArray& data)
+{
+    QList<QByteArray> result;
     auto responseMessages = data.split('\0');
     if (responseMessages.size() == 0)
     {
@@ -508,16 +582,51 @@ QList<QByteArray> core::EbDevice::readAllResponseMessages(int readTimeout)
         }
         encodedMsg += '\0';
         QByteArray responseMsg = unescapeData(encodedMsg);
-        logDebug(QString("EbDevice got response message, raw size = %1, decoded size = %2...").arg(encodedMsg.size()).arg(responseMsg.size()));
+        LOG_MEMBER_LIMITED(common::Debug, 1, 5, QString("EbDevice got response message, raw size = %1, decoded size = %2...").arg(encodedMsg.size()).arg(responseMsg.size()));
         result.push_back(responseMsg);
     }
+    framesDecoded.add(result.size());
+    return result;
+}
+
+QList<core::EbDevice::Sample> core::EbDevice::readAvailableSamples()
+{
+    TRACE_SPAN("EbDevice::readAvailableSamples");
+    if (_serialPort.bytesAvailable() == 0)
+    {
+        // Zero timeout only pulls the data that is already readable on the descriptor into the port buffer.
+        _serialPort.waitForReadyRead(0);
+    }
+    QByteArray input = _serialPort.read(SerialPortReadBufferSize);
+    serialBytesRead.add(input.size());
+    QByteArray data = _pendingInput + input;
+    QList<Sample> result;
+    int lastTerminator = data.lastIndexOf('\0');
+    if (lastTerminator < 0)
+    {
+        if (data.size() > MessageMaxSize)
+        {
+            throw EbDeviceException(QString("EbDevice got a response message with invalid size (>%2 bytes). Actual size: %1.").arg(data.size()).arg(MessageMaxSize));
+        }
+        _pendingInput = data;
+        return result;
+    }
+    _pendingInput = data.mid(lastTerminator + 1);
+    data.truncate(lastTerminator);
 
-    logDebug(QString("EbDevice response messages: %1 messages read in total.").arg(result.size()));
+    for (auto& resp : decodeResponseMessages(data))
+    {
+        if (checkSampleFrame(resp))
+        {
+            result.push_back(parseSample(resp.data()));
+        }
+    }
     return result;
 }
 
 void core::EbDevice::waitForInputSilence(int maxWaitCicles, int readTimeout)
 {
+    TRACE_SPAN("EbDevice::waitForInputSilence");
     int counter = 0;
     while (true)
     {
@@ -534,55 +643,34 @@ void core::EbDevice::waitForInputSilence(int maxWaitCicles, int readTimeout)
         }
         QThread::msleep(100);
     }
+    // Whatever was left of a partially received frame belongs to the stopped stream.
+    _pendingInput.clear();
 }
 
 QString core::EbDevice::readResponseString(int readTimeout)
 {
     auto response = readLastResponseMessage(readTimeout);
     auto responseString = QString(response);
-    logDebug(QString("EbDevice got text response message: '%1'").arg(responseString));
+    LOG_MEMBER(common::Debug, QString("EbDevice got text response message: '%1'").arg(responseString));
     return responseString;
 }
 
 QByteArray core::EbDevice::escapeData(QByteArray data)
 {
-    QByteArray result;
-    for (int i = 0; i < data.size(); i++)
-    {
-        uint8_t c = data.at(i);
-        if (c < 0x20 || c == 0x1A)
-        {
-            result.append(0x1A);
-            result.append(c + 0x80);
-        }
-        else
-        {
-            result.append(c);
-        }
-    }
+    QByteArray result(EbFrameCodec::maxEscapedSize(data.size()), Qt::Uninitialized);
+    result.resize(EbFrameCodec::escape(data.constData(), data.size(), result.data()));
     return result;
 }
 
 QByteArray core::EbDevice::unescapeData(QByteArray data)
 {
-    bool escaped = false;
-    QByteArray result;
-    for (int i = 0; i < data.size(); i++)
+    QByteArray result(data.size(), Qt::Uninitialized);
+    int errors = 0;
+    result.resize(EbFrameCodec::unescape(data.constData(), data.size(), result.data(), errors));
+    if (errors > 0)
     {
-        uint8_t c = data.at(i);
-        if (c == 0x1A)
-        {
-            escaped = true;
-        }
-        else if (escaped)
-        {
-            escaped = false;
-            result.append(c - 0x80);
-        }
-        else
-        {
-            result.append(c);
-        }
+        // only bytes >= 0x80 are sent escaped, the frame is damaged
+        unescapeErrors.add(errors);
     }
     return result;
 }
@@ -606,6 +694,11 @@ void core::EbDevice::log(common::LogLevel level, const QString& message)
     sLogger.write(level, message);
 }
 
+bool core::EbDevice::logEnabled(common::LogLevel level) const
+{
+    return (_logger.get() && _logger->enabled(level)) || sLogger.enabled(level);
+}
+
 void core::EbDevice::logInfo(const QString& message)
 {
     log(common::Info, message);
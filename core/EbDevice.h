@@ -10,9 +10,10 @@
 #pragma once
 
 #include "common/SmartPtr.h"
+#include "IDevice.h"
 #include <QtCore>
 #include "SerialPortBinaryStream.h"
-#include <common/BitConverter.h>
+#include <common/BitConverterT.h>
 #include <QtSerialPort/QSerialPort>
 #include "BufferedLogger.h"
 
@@ -24,7 +25,7 @@ namespace core
         EbDeviceException(const QString& message);
     };
 
-    class EbDevice
+    class EbDevice : public IDevice
     {
     public:
         SMART_PTR_T(EbDevice);
@@ -35,90 +36,78 @@ namespace core
             Binary
         };
 
-        struct RangeData
-        {
-            int32_t minField;
-            int32_t maxField;
-        };
-
-        enum SampleState
-        {
-            NUMERR = 0x01, // бит 0, значение поля не соответствует установленному рабочему поддиапазону
-            TIMERR = 0x02, // бит 1, укорочение длительности сигнала
-            NOISEERR = 0x04, // бит 2, низкое отношение сигнал/шум
-            RESERVED = 0x08, // бит 3, зарезервирован
-            OUTERR = 0x10, // бит 4, результат не попадает в пределы 20000-100000 нTл
-            FAILED = 0x20, // бит 5, нет сигнала (измерение не проводилось)
-            PWERR = 0x40, // бит 6, низкое напряжение питания (измерение не проводилось)
-            Valid = 0x80, // бит 7, значение магнитного поля можно выводить на дисплей
-            FatalError = 0x7F // 0x7F = Fatal Error
-        };
-
-        struct Sample
-        {
-            int32_t field; /* Field (pT) */
-            uint16_t qmc;  /* Quality(pT) */
-            SampleState state; /* State */
-            QDateTime time;
-        };
-
         explicit EbDevice(BufferedLogger::SharedPtr_t logger = BufferedLogger::SharedPtr_t());
 
-        void connect(QString portName);
+        void connect(QString portName) override;
 
         Mode mode() const { return _mode; }
 
-        void sendEnq();
+        void sendEnq() override;
         void sendNak();
-        void sendAbout();
-        void sendStandBy(bool enabled);
+        void sendAbout() override;
+        void sendStandBy(bool enabled) override;
         void sendGetMode();
         void sendSetMode(Mode mode);
-        void sendGetTime();
-        void sendSetTime(QDateTime dateTime /* use UTC */);
+        void sendGetTime() override;
+        void sendSetTime(QDateTime dateTime /* use UTC */) override;
         void sendGetDate();
         void sendSetDate(QDateTime dateTime /* use UTC */);
-        void sendGetRange();
-        void sendSetRange(uint32_t center);
+        void sendGetRange() override;
+        void sendSetRange(uint32_t center) override;
         void sendRun();
-        void sendAuto(int32_t freq /* -X Hz || 1/X mes/sec, X = [-5,-1]|[1,86400] */);
+        void sendAuto(int32_t freq /* -X Hz || 1/X mes/sec, X = [-5,-1]|[1,86400] */) override;
 
-        QString readEnq();
-        QString readAbout();
-        bool readStandBy();
+        QString readEnq() override;
+        QString readAbout() override;
+        bool readStandBy() override;
         Mode readGetMode();
         Mode readSetMode();
-        QDateTime readGetTime();
-        void readSetTime();
+        QDateTime readGetTime() override;
+        void readSetTime() override;
         QDateTime readGetDate();
         void readSetDate();
-        RangeData readGetRange();
-        RangeData readSetRange();
+        RangeData readGetRange() override;
+        RangeData readSetRange() override;
         QList<Sample> readAllSamples(int readTimeout = 1000);
+        // Non-blocking: decodes the samples that have already arrived, an incomplete trailing frame is kept for the next call.
+        QList<Sample> readAvailableSamples() override;
         Sample parseSample(char* respPtr);
         Sample readOneSample();
-        bool validateSample(const Sample& sample);
+        bool validateSample(const Sample& sample) override;
+        double samplingRateHz() const override { return _samplingRateHz; }
         
-        void runDiagnosticSequence();
-        void runTestAutoSequence();
+        void runDiagnosticSequence() override;
+        void runTestAutoSequence() override;
+
+        void waitForInputSilence(int maxWaitCicles = 10, int readTimeout = 1000) override;
 
-        void waitForInputSilence(int maxWaitCicles = 10, int readTimeout = 1000);
+        // Event loop integration: the port descriptor becomes readable when new data arrives.
+        QSerialPort::Handle nativeHandle() const override { return _serialPort.handle(); }
+        bool hasPendingInput() const override { return _serialPort.bytesAvailable() > 0; }
+        bool waitForInput(int timeoutMs) override { return hasPendingInput() || _serialPort.waitForReadyRead(timeoutMs); }
 
     private:
-        common::BitConverter _bitConverter;
         QSerialPort _serialPort;
         Mode _mode;
+        double _samplingRateHz;
         BufferedLogger::SharedPtr_t _logger;
+        QByteArray _pendingInput;
         static const int SerialPortReadBufferSize = 125000;
         static const int MessageMaxSize = 125000;
+        // field (4), qmc (2), state (1), time (4), hundredths of a second (1)
+        static const int SampleFrameSize = 12;
         void sendCommand(QByteArray command, int delayMilliseconds = 500, bool escape = true);
         QByteArray readLastResponseMessage(int readTimeout = 1000);
         QString readResponseString(int readTimeout = 1000);
         QList<QByteArray> readAllResponseMessages(int readTimeout = 1000);
+        QList<QByteArray> decodeResponseMessages(const QByteArray& data);
+        // A frame too short for a sample is counted and must not be parsed.
+        bool checkSampleFrame(const QByteArray& frame);
 
         QByteArray escapeData(QByteArray data);
         QByteArray unescapeData(QByteArray data);
         void assertTrue(bool condition, QString failureComment);
+        bool logEnabled(common::LogLevel level) const;
         void log(common::LogLevel level, const QString& message);
         void logInfo(const QString& message);
         void logDebug(const QString& message);
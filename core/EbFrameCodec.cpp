@@ -0,0 +1,147 @@
+#include "EbFrameCodec.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GEM_FRAME_CODEC_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GEM_FRAME_CODEC_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const uint8_t EscapeByte = 0x1A;
+    // bytes below are escaped
+    const uint8_t FirstPlainByte = 0x20;
+
+#if defined(GEM_FRAME_CODEC_AVX2) || defined(GEM_FRAME_CODEC_SSE2)
+    inline int lowestBit(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+#endif
+
+    // Bit i of the masks is set if byte i of the block at data is special.
+#if defined(GEM_FRAME_CODEC_AVX2)
+    const int BlockSize = 32;
+
+    inline uint32_t escapeMask(const char* data)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        __m256i lastEscaped = _mm256_set1_epi8(FirstPlainByte - 1);
+        // unsigned block <= 0x1F
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(block, lastEscaped), lastEscaped)));
+    }
+
+    inline uint32_t escapeByteMask(const char* data)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(EscapeByte))));
+    }
+#elif defined(GEM_FRAME_CODEC_SSE2)
+    const int BlockSize = 16;
+
+    inline uint32_t escapeMask(const char* data)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i lastEscaped = _mm_set1_epi8(FirstPlainByte - 1);
+        // unsigned block <= 0x1F
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, lastEscaped), lastEscaped)));
+    }
+
+    inline uint32_t escapeByteMask(const char* data)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(EscapeByte))));
+    }
+#endif
+}
+
+int core::EbFrameCodec::escape(const char* data, int size, char* dst)
+{
+    int in = 0;
+    int out = 0;
+    while (in < size)
+    {
+#if defined(GEM_FRAME_CODEC_AVX2) || defined(GEM_FRAME_CODEC_SSE2)
+        if (in + BlockSize <= size)
+        {
+            uint32_t mask = escapeMask(data + in);
+            int plain = mask == 0 ? BlockSize : lowestBit(mask);
+            memcpy(dst + out, data + in, plain);
+            in += plain;
+            out += plain;
+            if (mask == 0)
+            {
+                continue;
+            }
+        }
+#endif
+        uint8_t c = static_cast<uint8_t>(data[in++]);
+        if (c < FirstPlainByte)
+        {
+            dst[out++] = static_cast<char>(EscapeByte);
+            dst[out++] = static_cast<char>(c + 0x80);
+        }
+        else
+        {
+            dst[out++] = static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+int core::EbFrameCodec::unescape(const char* data, int size, char* dst, int& errors)
+{
+    int in = 0;
+    int out = 0;
+    bool escaped = false;
+    while (in < size)
+    {
+#if defined(GEM_FRAME_CODEC_AVX2) || defined(GEM_FRAME_CODEC_SSE2)
+        if (!escaped && in + BlockSize <= size)
+        {
+            uint32_t mask = escapeByteMask(data + in);
+            int plain = mask == 0 ? BlockSize : lowestBit(mask);
+            memcpy(dst + out, data + in, plain);
+            in += plain;
+            out += plain;
+            if (mask == 0)
+            {
+                continue;
+            }
+        }
+#endif
+        uint8_t c = static_cast<uint8_t>(data[in++]);
+        if (c == EscapeByte)
+        {
+            escaped = true;
+        }
+        else if (escaped)
+        {
+            escaped = false;
+            if (c < 0x80)
+            {
+                errors++;
+            }
+            dst[out++] = static_cast<char>(c - 0x80);
+        }
+        else
+        {
+            dst[out++] = static_cast<char>(c);
+        }
+    }
+    return out;
+}
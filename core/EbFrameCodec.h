@@ -0,0 +1,32 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   EbFrameCodec.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+namespace core
+{
+    // Byte stuffing of the GSM-19 serial link: bytes below 0x20 (0x1A, the escape byte, among them) are sent as
+    // 0x1A followed by the byte + 0x80. Input is scanned 16 bytes at a time with SSE2 (32 with AVX2), so runs
+    // without special bytes are copied as a whole and a frame without escapes costs about a memcpy.
+    class EbFrameCodec
+    {
+    public:
+        static int maxEscapedSize(int size)
+        {
+            return size * 2;
+        }
+
+        // Writes the escaped data into dst (at least maxEscapedSize(size) bytes), returns the written size.
+        static int escape(const char* data, int size, char* dst);
+
+        // Writes the unescaped data into dst (at least size bytes), returns the written size. errors is increased by
+        // the count of escaped bytes below 0x80, which are never sent escaped and mean that the frame is damaged.
+        static int unescape(const char* data, int size, char* dst, int& errors);
+    };
+}
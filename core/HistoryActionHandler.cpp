@@ -0,0 +1,173 @@
+#include "HistoryActionHandler.h"
+#include "HistoryDownsampler.h"
+#include "MSeedReader.h"
+
+core::HistoryActionHandler::HistoryActionHandler(RunnerActionHandler::SharedPtr_t runnerHandler, const QString& mseedFileName)
+: _runnerHandler(runnerHandler), _mseedFileName(mseedFileName)
+{
+}
+
+void core::HistoryActionHandler::registerRoutes(WebRouter& router)
+{
+    // GET api/history?channel=<FLD|QMC|STT>&from=<time>&to=<time>[&maxPoints=1000][&mode=<minmax|lttb>]
+    router.add("GET", "api/history", this, [this]() { executeHistory(); });
+    // GET api/export?from=<time>&to=<time>
+    router.add("GET", "api/export", this, [this]() { executeExport(); });
+}
+
+bool core::HistoryActionHandler::parseTime(const QString& value, qint64& timeMs)
+{
+    // ms since epoch or ISO 8601
+    bool ok;
+    timeMs = value.toLongLong(&ok);
+    if (ok)
+    {
+        return true;
+    }
+    auto time = QDateTime::fromString(value, Qt::ISODate);
+    if (!time.isValid())
+    {
+        return false;
+    }
+    if (time.timeSpec() == Qt::LocalTime)
+    {
+        time = QDateTime(time.date(), time.time(), Qt::UTC);
+    }
+    timeMs = time.toMSecsSinceEpoch();
+    return true;
+}
+
+void core::HistoryActionHandler::sendError(const QString& message)
+{
+    QJsonObject json;
+    json["error"] = message;
+    auto jsonData = QJsonDocument(json).toJson(QJsonDocument::JsonFormat::Compact);
+    response().status(400);
+    response().header("Content-Type", "application/json");
+    response().end(jsonData);
+}
+
+bool core::HistoryActionHandler::parseInterval(qint64& fromMs, qint64& toMs)
+{
+    QString fromValue;
+    QString toValue;
+    if (!queryVariable("from", fromValue) || !queryVariable("to", toValue) ||
+        !parseTime(fromValue, fromMs) || !parseTime(toValue, toMs) || fromMs > toMs)
+    {
+        sendError("Parameters 'from' and 'to' are required (ms since epoch or ISO 8601, from <= to).");
+        return false;
+    }
+    return true;
+}
+
+void core::HistoryActionHandler::executeHistory()
+{
+    QString channel = "FLD";
+    queryVariable("channel", channel);
+    if (channel != "FLD" && channel != "QMC" && channel != "STT")
+    {
+        sendError(QString("Unknown channel '%1'.").arg(channel));
+        return;
+    }
+
+    qint64 fromMs;
+    qint64 toMs;
+    if (!parseInterval(fromMs, toMs))
+    {
+        return;
+    }
+
+    int maxPoints = DefaultMaxPoints;
+    QString maxPointsValue;
+    if (queryVariable("maxPoints", maxPointsValue))
+    {
+        maxPoints = qBound(4, maxPointsValue.toInt(), int(MaxMaxPoints));
+    }
+
+    auto mode = HistoryDownsampler::MinMax;
+    QString modeValue;
+    if (queryVariable("mode", modeValue) && modeValue == "lttb")
+    {
+        mode = HistoryDownsampler::Lttb;
+    }
+
+    auto& store = _runnerHandler->history();
+    auto stats = store.stats();
+    bool fromMemory = stats.samplesCount > 0 && stats.firstTimeMs <= fromMs;
+
+    // The points are written in chunks while the records are being decoded.
+    response().header("Content-Type", "application/json");
+    QByteArray chunk;
+    chunk.reserve(ChunkSize + 64);
+    chunk.append("{\"channel\":\"").append(channel.toLatin1())
+        .append("\",\"mode\":\"").append(mode == HistoryDownsampler::Lttb ? "lttb" : "minmax")
+        .append("\",\"source\":\"").append(fromMemory ? "memory" : "mseed")
+        .append("\",\"from\":").append(QByteArray::number(fromMs))
+        .append(",\"to\":").append(QByteArray::number(toMs))
+        .append(",\"points\":[");
+    bool first = true;
+    HistoryDownsampler downsampler(mode, fromMs, toMs, maxPoints, [&](const HistoryPoint& point)
+    {
+        if (!first)
+        {
+            chunk.append(',');
+        }
+        first = false;
+        chunk.append('[').append(QByteArray::number(point.timeMs)).append(',').append(QByteArray::number(point.value)).append(']');
+        if (chunk.size() >= ChunkSize)
+        {
+            response().write(chunk);
+            chunk.resize(0);
+        }
+    });
+
+    bool complete = false;
+    if (fromMemory)
+    {
+        store.scan(fromMs, toMs, [&downsampler, &channel](const HistorySample& sample)
+        {
+            downsampler.add(sample.timeMs, channel == "FLD" ? sample.field : channel == "QMC" ? sample.qmc : sample.state);
+        });
+        complete = true;
+    }
+    else if (!_mseedFileName.isEmpty() && QFile::exists(_mseedFileName))
+    {
+        MSeedReader reader(_mseedFileName);
+        complete = reader.readSamples(channel, fromMs, toMs, [&downsampler](qint64 timeMs, int32_t value)
+        {
+            downsampler.add(timeMs, value);
+        });
+    }
+    downsampler.finish();
+
+    chunk.append("],\"complete\":").append(complete ? "true" : "false").append('}');
+    response().end(chunk);
+}
+
+void core::HistoryActionHandler::executeExport()
+{
+    qint64 fromMs;
+    qint64 toMs;
+    if (!parseInterval(fromMs, toMs))
+    {
+        return;
+    }
+
+    response().header("Content-Type", "text/csv");
+    response().header("Content-Disposition", "attachment; filename=\"samples.csv\"");
+    QByteArray chunk("time,field,qmc,state\n");
+    chunk.reserve(ChunkSize + 64);
+    _runnerHandler->history().scan(fromMs, toMs, [&](const HistorySample& sample)
+    {
+        chunk.append(QByteArray::number(qint64(sample.timeMs))).append(',')
+            .append(QByteArray::number(sample.field)).append(',')
+            .append(QByteArray::number(sample.qmc)).append(',')
+            .append(QByteArray::number(sample.state)).append('\n');
+        if (chunk.size() >= ChunkSize)
+        {
+            response().write(chunk);
+            chunk.resize(0);
+        }
+    });
+    response().end(chunk);
+}
@@ -0,0 +1,49 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   HistoryActionHandler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "WebServer.h"
+#include "RunnerActionHandler.h"
+
+namespace core
+{
+    // api/history: samples of a channel downsampled on the server, the response size depends on maxPoints only.
+    // Served from the in-memory history store when it covers the interval, otherwise read back from the miniSEED output.
+    // api/export: raw samples from the in-memory history store as CSV.
+    class HistoryActionHandler : public core::WebServerActionHandler
+    {
+    public:
+        SMART_PTR_T(HistoryActionHandler);
+
+        // mseedFileName - the file the runner's MSeedWriter writes to
+        HistoryActionHandler(RunnerActionHandler::SharedPtr_t runnerHandler, const QString& mseedFileName);
+
+        QString name() const override
+        {
+            return "HistoryActionHandler";
+        }
+
+        void registerRoutes(WebRouter& router) override;
+    private:
+        void executeHistory();
+        void executeExport();
+        bool parseInterval(qint64& fromMs, qint64& toMs);
+        void sendError(const QString& message);
+        static bool parseTime(const QString& value, qint64& timeMs);
+
+        static const int DefaultMaxPoints = 1000;
+        static const int MaxMaxPoints = 100000;
+        static const int ChunkSize = 16 * 1024;
+
+        RunnerActionHandler::SharedPtr_t _runnerHandler;
+        // not the status' mseedSettings.fileName, apply-mseed-settings changes it without touching the writer
+        QString _mseedFileName;
+    };
+}
@@ -0,0 +1,175 @@
+#include "HistoryDownsampler.h"
+#include <algorithm>
+#include <cmath>
+
+core::HistoryDownsampler::HistoryDownsampler(Mode mode, qint64 fromMs, qint64 toMs, int maxPoints, Consumer_t consumer)
+: _mode(mode), _fromMs(fromMs), _toMs(toMs), _consumer(consumer), _hasFirst(false)
+{
+    // MinMax gives two points per bucket, Lttb one plus the first and the last points
+    _bucketCount = _mode == MinMax ? maxPoints / 2 : maxPoints - 2;
+    _bucketCount = std::max<qint64>(_bucketCount, 1);
+}
+
+qint64 core::HistoryDownsampler::bucketIndex(qint64 timeMs) const
+{
+    qint64 span = _toMs - _fromMs + 1;
+    // (timeMs - from) * count / span without overflowing for long spans
+    qint64 index = static_cast<qint64>(static_cast<double>(timeMs - _fromMs) * _bucketCount / span);
+    return std::min(index, _bucketCount - 1);
+}
+
+void core::HistoryDownsampler::add(qint64 timeMs, int32_t value)
+{
+    if (timeMs < _fromMs || timeMs > _toMs)
+    {
+        return;
+    }
+    HistoryPoint point = { timeMs, value };
+    if (_mode == Lttb && !_hasFirst)
+    {
+        // the first point is always kept and does not take part in the buckets
+        _hasFirst = true;
+        _previous = point;
+        _last = point;
+        output(point);
+        return;
+    }
+    qint64 index = bucketIndex(timeMs);
+    if (index > _current.index)
+    {
+        completeBucket();
+        _current.index = index;
+    }
+    if (_mode == MinMax)
+    {
+        if (_current.count == 0 || value < _current.min.value)
+        {
+            _current.min = point;
+            _current.minOrder = _current.count;
+        }
+        if (_current.count == 0 || value >= _current.max.value)
+        {
+            _current.max = point;
+            _current.maxOrder = _current.count;
+        }
+    }
+    else
+    {
+        _current.points.push_back(point);
+    }
+    _current.count++;
+    _last = point;
+}
+
+void core::HistoryDownsampler::completeBucket()
+{
+    if (_current.count == 0)
+    {
+        return;
+    }
+    if (_mode == MinMax)
+    {
+        emitMinMax(_current);
+    }
+    else
+    {
+        if (!_pending.points.empty())
+        {
+            double nextTime = 0;
+            double nextValue = 0;
+            for (auto& point : _current.points)
+            {
+                nextTime += point.timeMs;
+                nextValue += point.value;
+            }
+            nextTime /= _current.points.size();
+            nextValue /= _current.points.size();
+            emitLttb(_pending, nextTime, nextValue);
+        }
+        std::swap(_pending, _current);
+    }
+    _current.clear();
+}
+
+void core::HistoryDownsampler::finish()
+{
+    if (_mode == MinMax)
+    {
+        completeBucket();
+        return;
+    }
+    if (!_hasFirst)
+    {
+        return;
+    }
+    // the last point is emitted on its own, it is the anchor for the final buckets
+    HistoryPoint last = _last;
+    bool lastIsFirst = _current.points.empty() && _pending.points.empty();
+    if (!_current.points.empty())
+    {
+        _current.points.pop_back();
+        _current.count--;
+    }
+    else if (!_pending.points.empty())
+    {
+        _pending.points.pop_back();
+        _pending.count--;
+    }
+    completeBucket();
+    if (!_pending.points.empty())
+    {
+        emitLttb(_pending, last.timeMs, last.value);
+        _pending.clear();
+    }
+    if (!lastIsFirst)
+    {
+        output(last);
+    }
+    _hasFirst = false;
+}
+
+void core::HistoryDownsampler::emitMinMax(const Bucket& bucket)
+{
+    if (bucket.minOrder == bucket.maxOrder)
+    {
+        output(bucket.min);
+    }
+    else if (bucket.minOrder < bucket.maxOrder)
+    {
+        output(bucket.min);
+        output(bucket.max);
+    }
+    else
+    {
+        output(bucket.max);
+        output(bucket.min);
+    }
+}
+
+void core::HistoryDownsampler::emitLttb(const Bucket& bucket, double nextTime, double nextValue)
+{
+    // the point forming the largest triangle with the previously selected point and the next bucket average
+    double maxArea = -1;
+    const HistoryPoint* selected = nullptr;
+    for (auto& point : bucket.points)
+    {
+        double area = std::fabs(
+            (static_cast<double>(_previous.timeMs) - nextTime) * (static_cast<double>(point.value) - _previous.value) -
+            (static_cast<double>(_previous.timeMs) - point.timeMs) * (nextValue - _previous.value));
+        if (area > maxArea)
+        {
+            maxArea = area;
+            selected = &point;
+        }
+    }
+    if (selected != nullptr)
+    {
+        _previous = *selected;
+        output(*selected);
+    }
+}
+
+void core::HistoryDownsampler::output(const HistoryPoint& point)
+{
+    _consumer(point);
+}
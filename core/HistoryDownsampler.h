@@ -0,0 +1,91 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   HistoryDownsampler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <QtCore/QtCore>
+#include <functional>
+#include <vector>
+
+namespace core
+{
+    struct HistoryPoint
+    {
+        qint64 timeMs;
+        int32_t value;
+    };
+
+    // Reduces a stream of points (in time order) within [fromMs, toMs] to at most maxPoints points,
+    // splitting the interval into equal time buckets. Output points are passed to the consumer as soon as
+    // their bucket is complete.
+    //   MinMax - the minimum and the maximum of every bucket (in time order), keeps spikes visible,
+    //            only the two points are kept while the bucket is filled;
+    //   Lttb   - Largest-Triangle-Three-Buckets, one point per bucket plus the first and the last point,
+    //            the points of two buckets are kept.
+    class HistoryDownsampler
+    {
+    public:
+        enum Mode
+        {
+            MinMax,
+            Lttb
+        };
+
+        typedef std::function<void(const HistoryPoint&)> Consumer_t;
+
+        HistoryDownsampler(Mode mode, qint64 fromMs, qint64 toMs, int maxPoints, Consumer_t consumer);
+
+        // Points outside of [fromMs, toMs] are ignored, late points are counted in the current bucket.
+        void add(qint64 timeMs, int32_t value);
+        // Emits the remaining points.
+        void finish();
+    private:
+        struct Bucket
+        {
+            Bucket() : index(-1), count(0), minOrder(0), maxOrder(0)
+            {
+            }
+
+            void clear()
+            {
+                count = 0;
+                points.clear();
+            }
+
+            qint64 index;
+            qint64 count;
+            // MinMax: the first minimum and the last maximum, with their positions in the bucket
+            HistoryPoint min;
+            HistoryPoint max;
+            qint64 minOrder;
+            qint64 maxOrder;
+            // Lttb only
+            std::vector<HistoryPoint> points;
+        };
+
+        qint64 bucketIndex(qint64 timeMs) const;
+        void completeBucket();
+        void emitMinMax(const Bucket& bucket);
+        void emitLttb(const Bucket& bucket, double nextTime, double nextValue);
+        void output(const HistoryPoint& point);
+
+        Mode _mode;
+        qint64 _fromMs;
+        qint64 _toMs;
+        qint64 _bucketCount;
+        Consumer_t _consumer;
+
+        Bucket _current;
+        // Lttb: a complete bucket waiting for the average of the next one
+        Bucket _pending;
+        bool _hasFirst;
+        HistoryPoint _previous;
+        HistoryPoint _last;
+    };
+}
@@ -0,0 +1,93 @@
+﻿// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   IDevice.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "common/SmartPtr.h"
+#include <QtCore>
+#include <QtSerialPort/QSerialPort>
+
+namespace core
+{
+    // Source of the magnetometer samples the Runner drives: the GSM-19 behind a serial port (EbDevice) or the
+    // in-process SyntheticDevice. Commands follow the GSM-19 protocol, every send*() is answered by the read*()
+    // of the same name.
+    class IDevice
+    {
+    public:
+        SMART_PTR_T(IDevice);
+
+        struct RangeData
+        {
+            int32_t minField;
+            int32_t maxField;
+        };
+
+        enum SampleState
+        {
+            NUMERR = 0x01, // бит 0, значение поля не соответствует установленному рабочему поддиапазону
+            TIMERR = 0x02, // бит 1, укорочение длительности сигнала
+            NOISEERR = 0x04, // бит 2, низкое отношение сигнал/шум
+            RESERVED = 0x08, // бит 3, зарезервирован
+            OUTERR = 0x10, // бит 4, результат не попадает в пределы 20000-100000 нTл
+            FAILED = 0x20, // бит 5, нет сигнала (измерение не проводилось)
+            PWERR = 0x40, // бит 6, низкое напряжение питания (измерение не проводилось)
+            Valid = 0x80, // бит 7, значение магнитного поля можно выводить на дисплей
+            FatalError = 0x7F // 0x7F = Fatal Error
+        };
+
+        struct Sample
+        {
+            int32_t field; /* Field (pT) */
+            uint16_t qmc;  /* Quality(pT) */
+            SampleState state; /* State */
+            QDateTime time;
+        };
+
+        virtual ~IDevice()
+        {
+        }
+
+        virtual void connect(QString portName) = 0;
+
+        virtual void sendEnq() = 0;
+        virtual void sendAbout() = 0;
+        virtual void sendStandBy(bool enabled) = 0;
+        virtual void sendGetTime() = 0;
+        virtual void sendSetTime(QDateTime dateTime /* use UTC */) = 0;
+        virtual void sendGetRange() = 0;
+        virtual void sendSetRange(uint32_t center) = 0;
+        virtual void sendAuto(int32_t freq /* -X Hz || 1/X mes/sec, X = [-5,-1]|[1,86400] */) = 0;
+
+        virtual QString readEnq() = 0;
+        virtual QString readAbout() = 0;
+        virtual bool readStandBy() = 0;
+        virtual QDateTime readGetTime() = 0;
+        virtual void readSetTime() = 0;
+        virtual RangeData readGetRange() = 0;
+        virtual RangeData readSetRange() = 0;
+        // Non-blocking: the samples that have arrived since the last call.
+        virtual QList<Sample> readAvailableSamples() = 0;
+        virtual bool validateSample(const Sample& sample) = 0;
+        // Rate of the samples after the last sendAuto(), the device may not sample at the asked rate exactly.
+        virtual double samplingRateHz() const = 0;
+
+        virtual void runDiagnosticSequence() = 0;
+        virtual void runTestAutoSequence() = 0;
+
+        // Drops the input of a stopped stream.
+        virtual void waitForInputSilence(int maxWaitCicles = 10, int readTimeout = 1000) = 0;
+
+        // Event loop integration: the descriptor becomes readable when new data arrives, -1 if the device has none
+        // and must be waited for with waitForInput().
+        virtual QSerialPort::Handle nativeHandle() const = 0;
+        virtual bool hasPendingInput() const = 0;
+        virtual bool waitForInput(int timeoutMs) = 0;
+    };
+}
@@ -0,0 +1,133 @@
+#include "LiveActionHandler.h"
+#include <mongoose.h>
+#include <common/JsonWriter.h>
+
+core::LiveActionHandler::LiveActionHandler(RunnerActionHandler::SharedPtr_t runnerHandler)
+: _runnerHandler(runnerHandler), _logCursor(0), _dataCursor(0), _clientsCount(0)
+{
+}
+
+bool core::LiveActionHandler::match()
+{
+    /*
+    GET ws/live (websocket)
+    */
+    return exactMatch("ws/live") && methodMatch("GET");
+}
+
+void core::LiveActionHandler::execute()
+{
+    // Plain HTTP request without the websocket upgrade
+    response().status(400);
+    response().header("Content-Type", "application/json");
+    response().end("{ \"error\": \"websocket connection expected\" }");
+}
+
+void core::LiveActionHandler::websocketConnected()
+{
+    if (_clients.isEmpty())
+    {
+        // nothing has been tracked while nobody listened, start from now
+        _logCursor = _runnerHandler->logger()->lastId();
+        _dataCursor = _runnerHandler->data()->lastSampleId;
+    }
+    _clients.insert(connection(), Client());
+    _clientsCount = _clients.size();
+}
+
+void core::LiveActionHandler::websocketClosed()
+{
+    _clients.remove(connection());
+    _clientsCount = _clients.size();
+}
+
+void core::LiveActionHandler::notify()
+{
+    auto webServer = server();
+    if (_clientsCount.load(std::memory_order_relaxed) > 0 && webServer != nullptr)
+    {
+        webServer->wakeup();
+    }
+}
+
+void core::LiveActionHandler::poll()
+{
+    if (_clients.isEmpty())
+    {
+        return;
+    }
+
+    auto logger = _runnerHandler->logger();
+    if (_logCursor > logger->lastId())
+    {
+        _logCursor = 0;
+    }
+    QByteArray frame;
+    _logCursor = logger->readRecordsSince(_logCursor, [this, &frame](uint64_t id, const BufferRecord& record)
+    {
+        frame.resize(0);
+        common::JsonWriter writer(frame);
+        writer.beginObject()
+            .field("type", "log")
+            .field("id", id);
+        writer.key("time").timeValue(record.timeMs);
+        writer.field("logLevel", BufferedLogger::levelCode(static_cast<common::LogLevel>(record.logLevel)));
+        writer.key("message").value(record.message, record.messageSize);
+        writer.endObject();
+        broadcast(frame);
+    });
+
+    auto data = _runnerHandler->data();
+    if (_dataCursor > data->lastSampleId)
+    {
+        _dataCursor = 0;
+    }
+    for (int i = data->indexAfter(_dataCursor); i < data->samples.size(); i++)
+    {
+        auto& sample = data->samples[i];
+        frame.resize(0);
+        common::JsonWriter writer(frame);
+        writer.beginObject()
+            .field("type", "sample")
+            .field("id", data->sampleId(i));
+        writer.key("time").timeValue(sample.time);
+        writer.field("field", sample.field)
+            .field("qmc", sample.qmc)
+            .field("state", sample.state)
+            .endObject();
+        broadcast(frame);
+    }
+    _dataCursor = data->lastSampleId;
+
+    for (auto it = _clients.begin(); it != _clients.end();)
+    {
+        if (it.value().frames.size() > MaxQueuedFrames)
+        {
+            // too slow to keep up, closed on the next poll
+            mg_close_connection(it.key());
+            it = _clients.erase(it);
+            continue;
+        }
+        flush(it.key(), it.value());
+        ++it;
+    }
+    _clientsCount = _clients.size();
+}
+
+void core::LiveActionHandler::broadcast(const QByteArray& frame)
+{
+    for (auto& client : _clients)
+    {
+        client.frames.enqueue(frame);
+    }
+}
+
+void core::LiveActionHandler::flush(mg_connection* connection, Client& client)
+{
+    // mg_write() with no data returns the amount of data not yet sent to the socket
+    while (!client.frames.isEmpty() && mg_write(connection, "", 0) < MaxPendingBytes)
+    {
+        auto frame = client.frames.dequeue();
+        mg_websocket_write(connection, WEBSOCKET_OPCODE_TEXT, frame.constData(), frame.size());
+    }
+}
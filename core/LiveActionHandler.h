@@ -0,0 +1,61 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   LiveActionHandler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "WebServer.h"
+#include "RunnerActionHandler.h"
+#include <atomic>
+
+namespace core
+{
+    // ws/live: pushes every new sample and log message to the connected websocket clients, one JSON text frame each.
+    // Frames are queued per client and written while the socket keeps up; a client whose queue overflows
+    // is disconnected instead of growing the server memory.
+    class LiveActionHandler : public core::WebServerActionHandler
+    {
+    public:
+        SMART_PTR_T(LiveActionHandler);
+
+        explicit LiveActionHandler(RunnerActionHandler::SharedPtr_t runnerHandler);
+
+        QString name() const override
+        {
+            return "LiveActionHandler";
+        }
+
+        bool match() override;
+        void execute() override;
+
+        void websocketConnected() override;
+        void websocketClosed() override;
+        void poll() override;
+
+        // Thread-safe: new samples or log messages have been published.
+        void notify();
+    private:
+        struct Client
+        {
+            QQueue<QByteArray> frames;
+        };
+
+        void broadcast(const QByteArray& frame);
+        void flush(mg_connection* connection, Client& client);
+
+        static const int MaxQueuedFrames = 500;
+        static const size_t MaxPendingBytes = 64 * 1024;
+
+        RunnerActionHandler::SharedPtr_t _runnerHandler;
+        // Web server thread only
+        QHash<mg_connection*, Client> _clients;
+        uint64_t _logCursor;
+        quint64 _dataCursor;
+        std::atomic<int> _clientsCount;
+    };
+}
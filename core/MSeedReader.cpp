@@ -3,17 +3,20 @@
 
 namespace core
 {
-    MSeedReader::MSeedReader(QString fileName): _fileName(fileName)
+    MSeedReader::MSeedReader(QString fileName): _fileName(fileName), _verbose(None)
     {
     }
 
     QList<AbstractMSeedRecord::SharedPtr_t> MSeedReader::readAll(bool *success)
     {
         QList<AbstractMSeedRecord::SharedPtr_t> records;
+        // per call file state, ms_readmsr() keeps it in statics shared by every thread
+        MSFileParam *msfp = NULL;
         MSRecord *msr = NULL;
         int retcode;
+        auto fileName = _fileName.toLatin1();
 
-        while ((retcode = ms_readmsr(&msr, _fileName.toLatin1().data(), 0, NULL, NULL, 1, 1, _verbose)) == MS_NOERROR)
+        while ((retcode = ms_readmsr_r(&msfp, &msr, fileName.data(), 0, NULL, NULL, 1, 1, _verbose)) == MS_NOERROR)
         {
             AbstractMSeedRecord::SharedPtr_t record;
             switch (msr->sampletype)
@@ -27,6 +30,7 @@ namespace core
                 }
                 break;
             default:
+                ms_readmsr_r(&msfp, &msr, NULL, 0, NULL, NULL, 0, 0, _verbose);
                 throw common::Exception("Sample type is not supported.");
             }
 
@@ -53,7 +57,7 @@ namespace core
             {
                 *success = false;
             }
-            ms_log(2, "Cannot read %s: %s\n", _fileName.toLatin1().data(), ms_errorstr(retcode));
+            ms_log(2, "Cannot read %s: %s\n", fileName.data(), ms_errorstr(retcode));
         }
         else
         {
@@ -64,8 +68,55 @@ namespace core
         }
 
         /* Cleanup memory and close file */
-        ms_readmsr(&msr, NULL, 0, NULL, NULL, 0, 0, _verbose);
+        ms_readmsr_r(&msfp, &msr, NULL, 0, NULL, NULL, 0, 0, _verbose);
 
         return records;
     }
+
+    bool MSeedReader::readSamples(const QString& channelName, qint64 fromMs, qint64 toMs, std::function<void(qint64 timeMs, int32_t value)> consumer)
+    {
+        // per call file state, history requests read concurrently on the web server workers
+        MSFileParam *msfp = NULL;
+        MSRecord *msr = NULL;
+        MSRecord *dataMsr = NULL;
+        int retcode;
+        auto fileName = _fileName.toLatin1();
+        auto channel = channelName.toLatin1();
+        hptime_t from = hptime_t(fromMs) * (HPTMODULUS / 1000);
+        hptime_t to = hptime_t(toMs) * (HPTMODULUS / 1000);
+
+        // headers only, the data of the matching records is unpacked below
+        while ((retcode = ms_readmsr_r(&msfp, &msr, fileName.data(), 0, NULL, NULL, 1, 0, _verbose)) == MS_NOERROR)
+        {
+            if (strcmp(msr->channel, channel.constData()) != 0 || msr->starttime > to || msr_endtime(msr) < from || msr->samprate <= 0)
+            {
+                continue;
+            }
+            if (msr_unpack(msr->record, msr->reclen, &dataMsr, 1, _verbose) != MS_NOERROR || dataMsr->sampletype != 'i')
+            {
+                continue;
+            }
+            auto samples = static_cast<const int32_t*>(dataMsr->datasamples);
+            for (int64_t i = 0; i < dataMsr->numsamples; i++)
+            {
+                hptime_t time = dataMsr->starttime + hptime_t(i / dataMsr->samprate * HPTMODULUS);
+                if (time >= from && time <= to)
+                {
+                    consumer(time / (HPTMODULUS / 1000), samples[i]);
+                }
+            }
+        }
+
+        if (retcode != MS_ENDOFFILE)
+        {
+            // the last record may be still being written
+            ms_log(1, "Cannot read %s: %s\n", fileName.data(), ms_errorstr(retcode));
+        }
+
+        /* Cleanup memory and close file */
+        msr_free(&dataMsr);
+        ms_readmsr_r(&msfp, &msr, NULL, 0, NULL, NULL, 0, 0, _verbose);
+
+        return retcode == MS_ENDOFFILE;
+    }
 }
@@ -11,6 +11,7 @@
 
 #include "MSeedRecord.h"
 #include "MSeedWriter.h"
+#include <functional>
 
 namespace core
 {
@@ -25,6 +26,10 @@ namespace core
         inline void verbose(const MSeedPackVerbose& verbose) { _verbose = verbose; }
 
         QList<AbstractMSeedRecord::SharedPtr_t> readAll(bool *success = nullptr);
+
+        // Streams the integer samples of the channel with time within [fromMs, toMs] (ms since epoch, UTC) in file order.
+        // Only the records overlapping the interval are decoded. Returns false if the file could not be read to the end.
+        bool readSamples(const QString& channelName, qint64 fromMs, qint64 toMs, std::function<void(qint64 timeMs, int32_t value)> consumer);
     private:
         QString _fileName;
         MSeedPackVerbose _verbose;
@@ -1,6 +1,8 @@
 #include "MSeedWriter.h"
 
 #include <libmseed.h>
+#include <common/Metrics.h>
+#include <common/Tracer.h>
 
 namespace core
 {
@@ -18,10 +20,14 @@ namespace core
         return btime;
     }
 
+    static common::MetricCounter& recordsPacked = sMetrics.counter("gem_mseed_records_packed_total", "miniSEED records packed.");
+    static common::MetricCounter& bytesWritten = sMetrics.counter("gem_mseed_written_bytes_total", "miniSEED bytes written to the output stream.");
+
     static void binaryStreamRecorder(char* record, int reclen, void* pvOutStream)
     {
         auto binaryStream = reinterpret_cast<IBinaryStream*>(pvOutStream);
         binaryStream->write(record, reclen);
+        bytesWritten.add(reclen);
     }
 
     void MSeedWriter::close()
@@ -31,6 +37,7 @@ namespace core
 
     bool MSeedWriter::write(IntegerMSeedRecord::SharedPtr_t sampleRange)
     {
+        TRACE_SPAN("MSeedWriter::write");
         //   mseed
         MSRecord* msr = msr_init(NULL);
 
@@ -57,11 +64,15 @@ namespace core
 
         flag verbose = _verbose;
         _packedSamples = 0;
-        _packedRecords = msr_pack(msr, &binaryStreamRecorder, _binaryStream.get(), &_packedSamples, 1, verbose);
+        {
+            TRACE_SPAN("msr_pack");
+            _packedRecords = msr_pack(msr, &binaryStreamRecorder, _binaryStream.get(), &_packedSamples, 1, verbose);
+        }
         if (_packedRecords == -1)
         {
             return false;
         }
+        recordsPacked.add(_packedRecords);
 
         msr->datasamples = NULL;
         msr_free(&msr);
@@ -72,6 +83,7 @@ namespace core
 
     bool MSeedWriter::flush()
     {
+        TRACE_SPAN("MSeedWriter::flush");
         return _binaryStream->flush();
     }
 }
@@ -0,0 +1,14 @@
+#include "MetricsActionHandler.h"
+#include <common/Metrics.h>
+
+void core::MetricsActionHandler::registerRoutes(WebRouter& router)
+{
+    router.add("GET", "api/metrics", this, [this]() { executeMetrics(); });
+}
+
+void core::MetricsActionHandler::executeMetrics()
+{
+    auto& buffer = responseBuffer();
+    sMetrics.writePrometheus(buffer);
+    sendResponse(CachedResponse("text/plain; version=0.0.4; charset=utf-8", buffer));
+}
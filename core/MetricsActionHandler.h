@@ -0,0 +1,31 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   MetricsActionHandler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "WebServer.h"
+
+namespace core
+{
+    // api/metrics: the process metrics (common::Metrics) in the Prometheus text format, for scraping.
+    class MetricsActionHandler : public core::WebServerActionHandler
+    {
+    public:
+        SMART_PTR_T(MetricsActionHandler);
+
+        QString name() const override
+        {
+            return "MetricsActionHandler";
+        }
+
+        void registerRoutes(WebRouter& router) override;
+    private:
+        void executeMetrics();
+    };
+}
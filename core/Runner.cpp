@@ -1,26 +1,98 @@
 ﻿#include "Runner.h"
 #include <common/NotImplementedException.h>
+#include <common/InvalidOperationException.h>
 #include "RunnerCommands.h"
 #include <common/Logger.h>
+#include <common/Metrics.h>
+#include <common/Tracer.h>
 #include "MSeedRecord.h"
 #include "FileBinaryStream.h"
 #include "MSeedWriter.h"
+#include "HistoryActionHandler.h"
+#include "MetricsActionHandler.h"
+#include "TraceActionHandler.h"
+#include "StaticFilesActionHandler.h"
+#include "SyntheticDevice.h"
+#ifdef __linux__
+#include <poll.h>
+#include <errno.h>
+#endif
+
+namespace
+{
+    common::MetricGauge& samplesCacheDepth = sMetrics.gauge("gem_samples_cache_depth", "Samples waiting in the cache to be written as miniSEED.");
+    common::MetricHistogram& flushDuration = sMetrics.histogram("gem_flush_duration_seconds", "Time to pack and write the samples cache.");
+    common::MetricHistogram& deviceToDiskLatency = sMetrics.histogram("gem_device_to_disk_latency_seconds",
+        "Time from receiving the oldest sample of a flush until it has been written.");
+
+    uint64_t microsecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Keeps a dequeued command counted as pending until it has been executed, even if it throws.
+    // A command that is left unfinished by an exception fails, so that its waiters are released.
+    class PendingCommandGuard
+    {
+    public:
+        PendingCommandGuard(const core::RunnerActionHandler::SharedPtr_t& actionHandler, const core::RunnerCommand::SharedPtr_t& command)
+            : _actionHandler(actionHandler), _command(command)
+        {
+        }
+
+        ~PendingCommandGuard()
+        {
+            _command->failed("The command has been interrupted, see the log for details.");
+            _actionHandler->commandCompleted();
+        }
+    private:
+        core::RunnerActionHandler::SharedPtr_t _actionHandler;
+        core::RunnerCommand::SharedPtr_t _command;
+    };
+}
 
 core::Runner::Runner(RunnerConfig config)
-: _config(config), _isRunning(false), _isFlushing(false), _samplingIntervalMs(0), _timeFixIntervalSeconds(0)
+: _config(config), _isRunning(false), _isFlushing(false), _samplingIntervalMs(0), _samplingRateHz(0), _timeFixIntervalSeconds(0), _stopRequested(false)
 {
     _actionHandler = std::make_shared<RunnerActionHandler>();
     _webLogger = _actionHandler->logger();
+    _webLogger->initialize(static_cast<common::LogLevel>(config.webLogLevel));
     _webServer = std::make_shared<WebServer>();
     _webServer->port(config.webServerPort);
+    _webServer->workerThreads(config.webServerWorkerThreads);
+    _webServer->maxConnections(config.webServerMaxConnections);
+    _actionHandler->history().retentionDays(config.historyRetentionDays);
+    _actionHandler->history().maxSizeBytes(size_t(config.historyMaxSizeMb) * 1024 * 1024);
     _webServer->addActionHandler(_actionHandler);
+    _liveHandler = std::make_shared<LiveActionHandler>(_actionHandler);
+    _webServer->addActionHandler(_liveHandler);
+    _webServer->addActionHandler(std::make_shared<HistoryActionHandler>(_actionHandler, config.msFileName));
+    _webServer->addActionHandler(std::make_shared<MetricsActionHandler>());
+#ifdef GEM_ENABLE_TRACING
+    _webServer->addActionHandler(std::make_shared<TraceActionHandler>());
+#endif
+    // the dashboard used to reach the API through the Node application
+    _webServer->addUriAlias("/api/dashboard/eb-device/", "/api/");
+    if (!config.webServerPublicDir.isEmpty() && QDir(config.webServerPublicDir).exists())
+    {
+        // last, it takes every GET request the API handlers have not matched
+        _webServer->addActionHandler(std::make_shared<StaticFilesActionHandler>(config.webServerPublicDir, config.webServerStaticMaxAgeSeconds));
+    }
+    std::weak_ptr<LiveActionHandler> liveHandler = _liveHandler;
+    _webLogger->writeListener([liveHandler]()
+    {
+        if (auto handler = liveHandler.lock())
+        {
+            handler->notify();
+        }
+    });
 }
 
-void core::Runner::executeRunCommand(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, int samplingIntervalMs, int timeFixIntervalSeconds, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeRunCommand(core::IDevice::SharedPtr_t& device, int samplingIntervalMs, int timeFixIntervalSeconds, RunnerStatus& status)
 {
     logInfo(QString("Preparing command RUN..."));
-    status->isRunning = true;
-    status->updated = QDateTime::currentDateTimeUtc();
+    status.isRunning = true;
+    status.updated = QDateTime::currentDateTimeUtc();
     int actualSamplingIntervalMs;
     int32_t actualIntervalVal;
     if (samplingIntervalMs > 1000)
@@ -61,37 +133,42 @@ void core::Runner::executeRunCommand(QMutexLocker& dataLock, core::EbDevice::Sha
             actualSamplingIntervalMs = 1000;
         }
     }
-    status->samplingIntervalMs = actualSamplingIntervalMs;
-    status->timeFixIntervalSeconds = timeFixIntervalSeconds;
+    status.timeFixIntervalSeconds = timeFixIntervalSeconds;
     logInfo(QString("Executing command RUN with { intervalMilliseconds: %1 (converted to %2) }...")
         .arg(samplingIntervalMs).arg(actualIntervalVal));
-    dataLock.unlock();
     device->sendAuto(actualIntervalVal);
-    dataLock.relock();
+    _samplingRateHz = device->samplingRateHz();
+    if (_samplingRateHz <= 0)
+    {
+        _samplingRateHz = 1000.0 / actualSamplingIntervalMs;
+    }
+    else if (!std::dynamic_pointer_cast<EbDevice>(device))
+    {
+        // the GSM-19 samples at the interval rounded above, the synthetic device at its configured rate whatever is asked
+        actualSamplingIntervalMs = qMax(1, qRound(1000 / _samplingRateHz));
+    }
+    status.samplingIntervalMs = actualSamplingIntervalMs;
     logInfo(QString("Executed."));
-    _isRunning = _actionHandler->status()->isRunning;
-    _samplingIntervalMs = _actionHandler->status()->samplingIntervalMs;
+    _isRunning = status.isRunning;
+    _samplingIntervalMs = status.samplingIntervalMs;
     _timeFixIntervalSeconds = timeFixIntervalSeconds;
 }
 
-void core::Runner::executeStopCommand(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeStopCommand(core::IDevice::SharedPtr_t& device, RunnerStatus& status)
 {
     logInfo(QString("Executing command STOP..."));
-    dataLock.unlock();
     device->sendEnq();
     // We wait for the moment when there are no incoming messages. That means that the incoming data stream has stopped.
     device->waitForInputSilence();
-    dataLock.relock();
-    status->isRunning = false;
-    status->updated = QDateTime::currentDateTimeUtc();
+    status.isRunning = false;
+    status.updated = QDateTime::currentDateTimeUtc();
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeUpdateStatus(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeUpdateStatus(core::IDevice::SharedPtr_t& device, RunnerStatus& status)
 {
     logInfo(QString("Executing command UPDATE-STATUS..."));
 
-    dataLock.unlock();
     // enq
     device->sendEnq();
     auto newEnq = device->readEnq();
@@ -104,81 +181,68 @@ void core::Runner::executeUpdateStatus(QMutexLocker& dataLock, core::EbDevice::S
     // time
     device->sendGetTime();
     auto newTime = device->readGetTime();
-    dataLock.relock();
 
-    status->enq = newEnq;
-    status->about = newAbout;
-    status->range = newRange;
-    status->time = newTime;
+    status.enq = newEnq;
+    status.about = newAbout;
+    status.range = newRange;
+    status.time = newTime;
 
     // timeUpdated
-    status->timeUpdated = QDateTime::currentDateTimeUtc();
+    status.timeUpdated = QDateTime::currentDateTimeUtc();
     // updated
-    status->updated = status->timeUpdated;
-    // commands size
-    _actionHandler->status()->commandQueueSize = _actionHandler->commands().size();
+    status.updated = status.timeUpdated;
 
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeSetTime(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, QDateTime time, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeSetTime(core::IDevice::SharedPtr_t& device, QDateTime time, RunnerStatus& status)
 {
     logInfo(QString("Executing command SET-TIME..."));
-    dataLock.unlock();
     device->sendSetTime(time);
     device->readSetTime();
     device->sendGetTime();
     auto newTime = device->readGetTime();
-    dataLock.relock();
-    status->time = newTime;
-    status->timeUpdated = QDateTime::currentDateTimeUtc();
-    status->updated = status->timeUpdated;
+    status.time = newTime;
+    status.timeUpdated = QDateTime::currentDateTimeUtc();
+    status.updated = status.timeUpdated;
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeSetRange(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, uint32_t center, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeSetRange(core::IDevice::SharedPtr_t& device, uint32_t center, RunnerStatus& status)
 {
     logInfo(QString("Executing command SET-RANGE..."));
-    dataLock.unlock();
     device->sendSetRange(center);
     auto newRange = device->readSetRange();
-    dataLock.relock();
-    status->range = newRange;
-    status->updated = QDateTime::currentDateTimeUtc();
+    status.range = newRange;
+    status.updated = QDateTime::currentDateTimeUtc();
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeSetStandBy(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, bool standBy, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeSetStandBy(core::IDevice::SharedPtr_t& device, bool standBy, RunnerStatus& status)
 {
     logInfo(QString("Executing command SET-STAND-BY..."));
-    dataLock.unlock();
     device->sendStandBy(standBy);
     auto newStandBy = device->readStandBy();
-    dataLock.relock();
-    status->standBy = newStandBy;
-    status->updated = QDateTime::currentDateTimeUtc();
+    status.standBy = newStandBy;
+    status.updated = QDateTime::currentDateTimeUtc();
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeDiagnostics(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeDiagnostics(core::IDevice::SharedPtr_t& device, RunnerStatus& status)
 {
     logInfo(QString("Executing command RUN-DIAGNOSTICS..."));
-    dataLock.unlock();
     device->runDiagnosticSequence();
-    dataLock.relock();
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeAutoTest(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeAutoTest(core::IDevice::SharedPtr_t& device, RunnerStatus& status)
 {
     logInfo(QString("Executing command AUTO-TEST..."));
-    dataLock.unlock();
     device->runTestAutoSequence();
-    dataLock.relock();
     logInfo(QString("Executed."));
 }
 
-void core::Runner::executeApplyMSeedSettings(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, core::MSeedSettings newSettings, RunnerStatus::SharedPtr_t status)
+void core::Runner::executeApplyMSeedSettings(core::IDevice::SharedPtr_t& device, core::MSeedSettings newSettings, RunnerStatus& status)
 {
     logInfo(QString("Executing command APPLY-MSEED-SETTINGS..."));
     logInfo(QString("Arguments: { fileName: '%1', network: '%2', station: '%3', location: '%4', samplesInRecord: %5 }")
@@ -187,21 +251,35 @@ void core::Runner::executeApplyMSeedSettings(QMutexLocker& dataLock, core::EbDev
         .arg(newSettings.station)
         .arg(newSettings.location)
         .arg(newSettings.samplesInRecord));
-    _actionHandler->status()->mseedSettings.fileName = newSettings.fileName;
-    _actionHandler->status()->mseedSettings.network = newSettings.network;
-    _actionHandler->status()->mseedSettings.station = newSettings.station;
-    _actionHandler->status()->mseedSettings.location = newSettings.location;
-    _actionHandler->status()->mseedSettings.samplesInRecord = newSettings.samplesInRecord;
+    _status.mseedSettings.fileName = newSettings.fileName;
+    _status.mseedSettings.network = newSettings.network;
+    _status.mseedSettings.station = newSettings.station;
+    _status.mseedSettings.location = newSettings.location;
+    _status.mseedSettings.samplesInRecord = newSettings.samplesInRecord;
     logInfo(QString("Executed."));
 }
 
-core::IntegerMSeedRecord::SharedPtr_t core::Runner::createIntegerRecord(QString channelName, double samplingRateHz, QDateTime time)
+core::IDevice::SharedPtr_t core::Runner::createDevice()
+{
+    if (_config.deviceType == "synthetic")
+    {
+        sLogger.info(QString("Using the synthetic device (%1 Hz, 0 = as asked by the run command).").arg(_config.syntheticDevice.rateHz));
+        return std::make_shared<SyntheticDevice>(_config.syntheticDevice);
+    }
+    if (!_config.deviceType.isEmpty() && _config.deviceType != "gsm19")
+    {
+        throw common::InvalidOperationException(QString("Unknown device type `%1`, expected gsm19 or synthetic.").arg(_config.deviceType));
+    }
+    return std::make_shared<EbDevice>(_webLogger);
+}
+
+core::IntegerMSeedRecord::SharedPtr_t core::Runner::createIntegerRecord(const RunnerConfig& config, QString channelName, double samplingRateHz, QDateTime time)
 {
     auto record = std::make_shared<IntegerMSeedRecord>();
     record->channelName(channelName);
-    record->location(_config.msRecordLocation);
-    record->network(_config.msRecordNetwork);
-    record->station(_config.msRecordStation);
+    record->location(config.msRecordLocation);
+    record->network(config.msRecordNetwork);
+    record->station(config.msRecordStation);
     record->samplingRateHz(samplingRateHz);
     record->startTime(time);
     return record;
@@ -213,133 +291,179 @@ void core::Runner::flushSamplesCache()
     {
         return;
     }
+    if (_samplingRateHz <= 0)
+    {
+        // records with no rate are skipped by the readers, the samples would be lost from the history anyway
+        LOG_MEMBER(common::Error, QString("Dropping %1 samples, their sampling rate is unknown.").arg(_samplesCache.size()));
+        _samplesCache.clear();
+        samplesCacheDepth.set(0);
+        return;
+    }
+    TRACE_SPAN("Runner::flushSamplesCache");
     _isFlushing = true;
-    logDebug(QString("Flushing samples cache (%1 samples)...").arg(_samplesCache.size()));
-    double samplingRateHz = 1000.0 / _samplingIntervalMs;
+    auto flushStarted = std::chrono::steady_clock::now();
+    LOG_MEMBER(common::Debug, QString("Flushing samples cache (%1 samples)...").arg(_samplesCache.size()));
+    writeSamples(*_writer, _config, _samplesCache, _samplingRateHz);
+    _samplesCache.clear();
+    samplesCacheDepth.set(0);
+    flushDuration.record(microsecondsSince(flushStarted));
+    deviceToDiskLatency.record(microsecondsSince(_samplesCacheStarted));
+    LOG_MEMBER(common::Debug, QString("Done flushing."));
+    _isFlushing = false;
+}
 
-    auto recordTime = _samplesCache.first().time;
+void core::Runner::writeSamples(MSeedWriter& writer, const RunnerConfig& config, const QVector<EbDevice::Sample>& samples, double samplingRateHz)
+{
+    auto recordTime = samples.first().time;
 
     // field
-    auto fieldRecord = createIntegerRecord("FLD", samplingRateHz, recordTime);
-    for (auto& sample : _samplesCache)
+    auto fieldRecord = createIntegerRecord(config, "FLD", samplingRateHz, recordTime);
+    for (auto& sample : samples)
     {
         fieldRecord->data().push_back(sample.field);
     }
-    _writer->write(fieldRecord);
+    writer.write(fieldRecord);
     // qmc
-    auto qualityRecord = createIntegerRecord("QMC", samplingRateHz, recordTime);
-    for (auto& sample : _samplesCache)
+    auto qualityRecord = createIntegerRecord(config, "QMC", samplingRateHz, recordTime);
+    for (auto& sample : samples)
     {
         qualityRecord->data().push_back(sample.qmc);
     }
-    _writer->write(qualityRecord);
+    writer.write(qualityRecord);
     // state
-    auto stateRecord = createIntegerRecord("STT", samplingRateHz, recordTime);
-    for (auto& sample : _samplesCache)
+    auto stateRecord = createIntegerRecord(config, "STT", samplingRateHz, recordTime);
+    for (auto& sample : samples)
     {
         stateRecord->data().push_back(sample.state);
     }
-    _writer->write(stateRecord);
+    writer.write(stateRecord);
 
-    _writer->flush();
-    _samplesCache.clear();
-    logDebug(QString("Done flushing."));
-    _isFlushing = false;
+    writer.flush();
 }
 
 void core::Runner::handlePendingWebServerCommands()
 {
-    QMutexLocker lock(_actionHandler->dataMutex());
-    while (!_actionHandler->commands().empty())
+    RunnerCommand::SharedPtr_t cmd;
+    while (_actionHandler->commands().tryDequeue(cmd))
     {
-        sLogger.debug("Found a command...");
-
-        if (_isRunning)
+        LOG_DEBUG(QString("Found a command #%1...").arg(cmd->id()));
+        PendingCommandGuard pendingCommandGuard(_actionHandler, cmd);
+        cmd->started();
+        try
         {
-            flushSamplesCache();
-            executeStopCommand(lock, _device, _actionHandler->status());
-            _isRunning = false;
+            executeCommand(cmd);
+        }
+        catch (common::Exception& ex)
+        {
+            // the command may have changed the status before it failed, api/status must not keep the old one
+            publishStatus();
+            cmd->failed(ex.what());
+            throw;
+        }
+        catch (std::exception& ex)
+        {
+            publishStatus();
+            cmd->failed(ex.what());
+            throw;
         }
+        publishStatus();
+        cmd->completed();
+        LOG_DEBUG("Done reading command.");
+    }
+}
 
-        auto cmd = _actionHandler->commands().dequeue();
-        switch (cmd->type())
+void core::Runner::executeCommand(const RunnerCommand::SharedPtr_t& cmd)
+{
+    TRACE_SPAN("Runner::executeCommand");
+    if (_isRunning)
+    {
+        flushSamplesCache();
+        executeStopCommand(_device, _status);
+        _isRunning = false;
+    }
+
+    switch (cmd->type())
+    {
+    case Run:
         {
-        case Run:
-            {
-                if (!_isRunning)
-                {
-                    auto runCmd = std::static_pointer_cast<RunRunnerCommand>(cmd);
-                    int samplingIntervalMs = runCmd->intervalMilliseconds();
-                    int timeFixIntervalSeconds = runCmd->timeFixIntervalSeconds();
-                    executeRunCommand(lock, _device, samplingIntervalMs, timeFixIntervalSeconds, _actionHandler->status());
-                }
-            }
-            break;
-        case Stop:
-            // Any command make a stop first
-            break;
-        case UpdateStatus:
-            executeUpdateStatus(lock, _device, _actionHandler->status());
-            break;
-        case SetTime:
+            if (!_isRunning)
             {
-                auto timeCmd = std::static_pointer_cast<SetTimeRunnerCommand>(cmd);
-                QDateTime time = timeCmd->time();
-                executeSetTime(lock, _device, time, _actionHandler->status());
+                auto runCmd = std::static_pointer_cast<RunRunnerCommand>(cmd);
+                int samplingIntervalMs = runCmd->intervalMilliseconds();
+                int timeFixIntervalSeconds = runCmd->timeFixIntervalSeconds();
+                executeRunCommand(_device, samplingIntervalMs, timeFixIntervalSeconds, _status);
             }
-            break;
-        case SetRange:
-            {
-                auto rangeCmd = std::static_pointer_cast<SetRangeRunnerCommand>(cmd);
-                uint32_t center = rangeCmd->center();
-                executeSetRange(lock, _device, center, _actionHandler->status());
-            }
-            break;
-        case SetStandBy:
-            {
-                auto standByCmd = std::static_pointer_cast<SetStandByRunnerCommand>(cmd);
-                bool standBy = standByCmd->standBy();
-                executeSetStandBy(lock, _device, standBy, _actionHandler->status());
-            }
-            break;
-        case RunDiagnostics:
-            executeDiagnostics(lock, _device, _actionHandler->status());
-            executeUpdateStatus(lock, _device, _actionHandler->status());
-            break;
-        case RunModeAutoTest:
-            executeAutoTest(lock, _device, _actionHandler->status());
-            break;
-        case ApplyMSeedSettings:
-            {
-                auto applyMSeedSettingsCmd = std::static_pointer_cast<ApplyMSeedSettingsRunnerCommand>(cmd);
-                auto newSettings = applyMSeedSettingsCmd->settings();
-                executeApplyMSeedSettings(lock, _device, newSettings, _actionHandler->status());
-            }
-            break;
-        default:
-            throw common::NotImplementedException();
         }
-        _actionHandler->status()->commandQueueSize = _actionHandler->commands().size();
-        sLogger.debug("Done reading command.");
+        break;
+    case Stop:
+        // Any command make a stop first
+        break;
+    case UpdateStatus:
+        executeUpdateStatus(_device, _status);
+        break;
+    case SetTime:
+        {
+            auto timeCmd = std::static_pointer_cast<SetTimeRunnerCommand>(cmd);
+            QDateTime time = timeCmd->time();
+            executeSetTime(_device, time, _status);
+        }
+        break;
+    case SetRange:
+        {
+            auto rangeCmd = std::static_pointer_cast<SetRangeRunnerCommand>(cmd);
+            uint32_t center = rangeCmd->center();
+            executeSetRange(_device, center, _status);
+        }
+        break;
+    case SetStandBy:
+        {
+            auto standByCmd = std::static_pointer_cast<SetStandByRunnerCommand>(cmd);
+            bool standBy = standByCmd->standBy();
+            executeSetStandBy(_device, standBy, _status);
+        }
+        break;
+    case RunDiagnostics:
+        executeDiagnostics(_device, _status);
+        executeUpdateStatus(_device, _status);
+        break;
+    case RunModeAutoTest:
+        executeAutoTest(_device, _status);
+        break;
+    case ApplyMSeedSettings:
+        {
+            auto applyMSeedSettingsCmd = std::static_pointer_cast<ApplyMSeedSettingsRunnerCommand>(cmd);
+            auto newSettings = applyMSeedSettingsCmd->settings();
+            executeApplyMSeedSettings(_device, newSettings, _status);
+        }
+        break;
+    default:
+        throw common::NotImplementedException();
     }
 }
 
 void core::Runner::handleNewDataSamples()
 {
+    TRACE_SPAN("Runner::handleNewDataSamples");
     // receive data sample and write it into mini-seed stream
-    const int acceptableDelay = 1000;
-    auto samples = _device->readAllSamples(_samplingIntervalMs + acceptableDelay);
+    auto samples = _device->readAvailableSamples();
     for (auto& sample : samples)
     {
         auto isValid = _device->validateSample(sample);
-        sLogger.info(QString("Received another sample: field: %1, time: %2.%3, state: 0x%4, qmc: %5, isValid: %6")
+        LOG_LIMITED_TO(sLogger, common::Info, 1, 5, QString("Received another sample: field: %1, time: %2.%3, state: 0x%4, qmc: %5, isValid: %6")
             .arg(sample.field).arg(sample.time.toString(Qt::ISODate)).arg(sample.time.toMSecsSinceEpoch() % 1000)
             .arg(sample.state, 2, 16).arg(sample.qmc).arg(isValid));
 
+        if (_samplesCache.empty())
+        {
+            _samplesCacheStarted = std::chrono::steady_clock::now();
+        }
         _samplesCache.push_back(sample);
+        samplesCacheDepth.set(_samplesCache.size());
+        HistorySample historySample = { sample.time.toMSecsSinceEpoch(), sample.field, sample.qmc, static_cast<uint8_t>(sample.state) };
+        _actionHandler->history().append(historySample);
+        if (isValid)
         {
-            QMutexLocker lock(_actionHandler->dataMutex());
-            _actionHandler->addToDataBuffer(sample);
+            _actionHandler->aggregates().add(sample.time.toMSecsSinceEpoch(), sample.field);
         }
 
         if (_samplesCache.size() >= _config.samplesCacheMaxSize)
@@ -347,20 +471,27 @@ void core::Runner::handleNewDataSamples()
             flushSamplesCache();
         }
     }
+    _actionHandler->addToDataBuffer(samples);
+    if (!samples.empty())
+    {
+        _actionHandler->history().publish();
+        _liveHandler->notify();
+    }
 }
 
 void core::Runner::run()
 {
+    TRACE_THREAD_NAME("runner");
     // Running commands aggregator in background thread
     sLogger.info(QString("Starting web server on port %1...").arg(_config.webServerPort));
     _webServer->runAsync();
 
     // Error-restart loop
-    while (true)
+    while (!_stopRequested.load())
     {
         // Creating a device
         sLogger.info(QString("Connecting to device on port %1...").arg(_config.devicePortName));
-        _device = std::make_shared<EbDevice>(_webLogger);
+        _device = createDevice();
         _device->connect(_config.devicePortName);
         if (!_config.skipDiagnostics)
         {
@@ -386,17 +517,26 @@ void core::Runner::run()
         _timeFixIntervalSeconds = 0;
         {
             sLogger.info(QString("Gathering device start-up config..."));
-            QMutexLocker lock(_actionHandler->dataMutex());
             RunnerCommand::SharedPtr_t updateCmd = std::make_shared<UpdateStatusRunnerCommand>();
-            executeUpdateStatus(lock, _device, _actionHandler->status());
-            _isRunning = _actionHandler->status()->isRunning;
-            _samplingIntervalMs = _actionHandler->status()->samplingIntervalMs;
-            _timeFixIntervalSeconds = _actionHandler->status()->timeFixIntervalSeconds;
-            _actionHandler->status()->mseedSettings.fileName = _config.msFileName;
-            _actionHandler->status()->mseedSettings.network = _config.msRecordNetwork;
-            _actionHandler->status()->mseedSettings.station = _config.msRecordStation;
-            _actionHandler->status()->mseedSettings.location = _config.msRecordLocation;
-            _actionHandler->status()->mseedSettings.samplesInRecord = _config.samplesCacheMaxSize;
+            executeUpdateStatus(_device, _status);
+            _isRunning = _status.isRunning;
+            _samplingIntervalMs = _status.samplingIntervalMs;
+            _timeFixIntervalSeconds = _status.timeFixIntervalSeconds;
+            // the new device is not told a rate until the next RUN, the samples still coming are at the rate of the last one
+            if (!_isRunning)
+            {
+                _samplingRateHz = 0;
+            }
+            else if (_samplingRateHz <= 0 && _samplingIntervalMs > 0)
+            {
+                _samplingRateHz = 1000.0 / _samplingIntervalMs;
+            }
+            _status.mseedSettings.fileName = _config.msFileName;
+            _status.mseedSettings.network = _config.msRecordNetwork;
+            _status.mseedSettings.station = _config.msRecordStation;
+            _status.mseedSettings.location = _config.msRecordLocation;
+            _status.mseedSettings.samplesInRecord = _config.samplesCacheMaxSize;
+            publishStatus();
             sLogger.info(QString("Done gathering."));
         }
 
@@ -408,30 +548,54 @@ void core::Runner::run()
             sLogger.info(QString("Starting main logging loop..."));
             while (true)
             {
+                // While idle we only wake up on commands, while running also on incoming data, the time fix deadline
+                // and the sampling watchdog.
+                int timeoutMs = -1;
+                if (_isRunning)
+                {
+                    timeoutMs = _samplingIntervalMs + AcceptableSampleDelayMs;
+                    if (_timeFixIntervalSeconds > 0)
+                    {
+                        qint64 timeFixDueMs = lastTimeFixEpoch + _timeFixIntervalSeconds * 1000LL - QDateTime::currentMSecsSinceEpoch();
+                        timeoutMs = static_cast<int>(qBound<qint64>(0, timeFixDueMs, timeoutMs));
+                    }
+                }
+                int events = waitForEvents(timeoutMs);
+                if (_stopRequested.load())
+                {
+                    sLogger.info("Stopping main logging loop...");
+                    flushSamplesCache();
+                    return;
+                }
+
                 if (_isRunning)
                 {
                     // Performing device time fix if required
                     qint64 nowEpoch = QDateTime::currentMSecsSinceEpoch();
-                    if (_timeFixIntervalSeconds > 0 && nowEpoch - lastTimeFixEpoch > _timeFixIntervalSeconds * 1000)
+                    if (_timeFixIntervalSeconds > 0 && nowEpoch - lastTimeFixEpoch >= _timeFixIntervalSeconds * 1000LL)
                     {
                         sLogger.info("Performing device time correction...");
-                        QMutexLocker lock(_actionHandler->dataMutex());
-                        executeStopCommand(lock, _device, _actionHandler->status());
-                        _actionHandler->status()->isRunning = true; // simulating that we are still running
-                        executeSetTime(lock, _device, QDateTime::currentDateTimeUtc(), _actionHandler->status());
-                        executeRunCommand(lock, _device, _samplingIntervalMs, _timeFixIntervalSeconds, _actionHandler->status());
+                        executeStopCommand(_device, _status);
+                        _status.isRunning = true; // simulating that we are still running
+                        executeSetTime(_device, QDateTime::currentDateTimeUtc(), _status);
+                        executeRunCommand(_device, _samplingIntervalMs, _timeFixIntervalSeconds, _status);
+                        publishStatus();
                         lastTimeFixEpoch = QDateTime::currentMSecsSinceEpoch();
                     }
-
-                    handleNewDataSamples();
+                    else if (events & DeviceInputEvent)
+                    {
+                        handleNewDataSamples();
+                    }
+                    else if (events == NoEvents)
+                    {
+                        LOG_DEBUG(QString("No samples received within %1 ms.").arg(timeoutMs));
+                    }
                 }
-                else
+
+                if (events & CommandsEvent)
                 {
-                    // sleep 1 second as a fallback for data logging
-                    QThread::sleep(1);
+                    handlePendingWebServerCommands();
                 }
-
-                handlePendingWebServerCommands();
             }
         }
         catch (EbDeviceException& ex)
@@ -460,6 +624,113 @@ void core::Runner::run()
     }
 }
 
+void core::Runner::stop()
+{
+    _stopRequested.store(true);
+    // wakes the runner thread up as a command would
+    _actionHandler->commandsNotifier().notify();
+}
+
+void core::Runner::publishStatus()
+{
+    TRACE_SPAN("Runner::publishStatus");
+    _actionHandler->publishStatus(_status);
+}
+
+int core::Runner::waitForEvents(int timeoutMs)
+{
+    auto& notifier = _actionHandler->commandsNotifier();
+    bool watchDevice = _isRunning && _device.get();
+    int events = NoEvents;
+    if (!_actionHandler->commands().empty())
+    {
+        events |= CommandsEvent;
+    }
+    if (watchDevice && _device->hasPendingInput())
+    {
+        events |= DeviceInputEvent;
+    }
+    if (events != NoEvents)
+    {
+        notifier.reset();
+        return events;
+    }
+
+#ifdef __linux__
+    // a device without a descriptor (the synthetic one) is waited for in slices below
+    if (!watchDevice || _device->nativeHandle() >= 0)
+    {
+        pollfd fds[2];
+        nfds_t count = 0;
+        fds[count].fd = notifier.fd();
+        fds[count].events = POLLIN;
+        fds[count].revents = 0;
+        count++;
+        if (watchDevice)
+        {
+            fds[count].fd = _device->nativeHandle();
+            fds[count].events = POLLIN;
+            fds[count].revents = 0;
+            count++;
+        }
+        int result;
+        do
+        {
+            result = ::poll(fds, count, timeoutMs);
+        } while (result < 0 && errno == EINTR);
+        if (result < 0)
+        {
+            throw common::Exception(QString("Runner event loop poll() failed, errno = %1.").arg(errno));
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            // Reset before draining the queue: a command enqueued later signals again.
+            notifier.reset();
+            events |= CommandsEvent;
+        }
+        if (count > 1 && (fds[1].revents & (POLLIN | POLLERR | POLLHUP)))
+        {
+            // Errors and hang-ups are reported by the port on the following read.
+            events |= DeviceInputEvent;
+        }
+        return events;
+    }
+#endif
+    // No pollable descriptors: wait on the device in short slices and check the notifier in between.
+    QElapsedTimer timer;
+    timer.start();
+    while (true)
+    {
+        int sliceMs = FallbackPollSliceMs;
+        if (timeoutMs >= 0)
+        {
+            sliceMs = qMin<qint64>(sliceMs, qMax<qint64>(0, timeoutMs - timer.elapsed()));
+        }
+        if (watchDevice)
+        {
+            if (_device->waitForInput(sliceMs))
+            {
+                events |= DeviceInputEvent;
+            }
+            if (notifier.wait(0))
+            {
+                notifier.reset();
+                events |= CommandsEvent;
+            }
+        }
+        else if (notifier.wait(sliceMs))
+        {
+            notifier.reset();
+            events |= CommandsEvent;
+        }
+        if (events != NoEvents || (timeoutMs >= 0 && timer.elapsed() >= timeoutMs))
+        {
+            break;
+        }
+    }
+    return events;
+}
+
 void core::Runner::log(common::LogLevel level, const QString& message)
 {
     if (_webLogger.get())
@@ -469,6 +740,11 @@ void core::Runner::log(common::LogLevel level, const QString& message)
     sLogger.write(level, message);
 }
 
+bool core::Runner::logEnabled(common::LogLevel level) const
+{
+    return (_webLogger.get() && _webLogger->enabled(level)) || sLogger.enabled(level);
+}
+
 void core::Runner::logInfo(const QString& message)
 {
     log(common::Info, message);
@@ -11,9 +11,12 @@
 
 #include "WebServer.h"
 #include "RunnerActionHandler.h"
+#include "LiveActionHandler.h"
 #include "RunnerData.h"
 #include "MSeedRecord.h"
 #include "MSeedWriter.h"
+#include <atomic>
+#include <chrono>
 
 namespace core
 {
@@ -23,39 +26,71 @@ namespace core
         SMART_PTR_T(Runner);
         Runner(RunnerConfig config);
         void run();
+
+        // Thread-safe: run() flushes the samples cache and returns once it is done with the current event.
+        void stop();
+
+        // Packs the field, QMC and state columns of the samples into miniSEED records and flushes the writer.
+        static void writeSamples(MSeedWriter& writer, const RunnerConfig& config, const QVector<EbDevice::Sample>& samples, double samplingRateHz);
     private:
-        void executeRunCommand(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, int samplingIntervalMs, int timeFixIntervalSeconds, RunnerStatus::SharedPtr_t status);
-        void executeStopCommand(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status);
-        void executeUpdateStatus(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status);
-        void executeSetTime(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, QDateTime time, RunnerStatus::SharedPtr_t status);
-        void executeSetRange(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, uint32_t center, RunnerStatus::SharedPtr_t status);
-        void executeSetStandBy(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, bool standBy, RunnerStatus::SharedPtr_t status);
-        void executeDiagnostics(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status);
-        void executeAutoTest(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, RunnerStatus::SharedPtr_t status);
-        void executeApplyMSeedSettings(QMutexLocker& dataLock, core::EbDevice::SharedPtr_t& device, core::MSeedSettings newSettings, RunnerStatus::SharedPtr_t status);
+        void executeRunCommand(core::IDevice::SharedPtr_t& device, int samplingIntervalMs, int timeFixIntervalSeconds, RunnerStatus& status);
+        void executeStopCommand(core::IDevice::SharedPtr_t& device, RunnerStatus& status);
+        void executeUpdateStatus(core::IDevice::SharedPtr_t& device, RunnerStatus& status);
+        void executeSetTime(core::IDevice::SharedPtr_t& device, QDateTime time, RunnerStatus& status);
+        void executeSetRange(core::IDevice::SharedPtr_t& device, uint32_t center, RunnerStatus& status);
+        void executeSetStandBy(core::IDevice::SharedPtr_t& device, bool standBy, RunnerStatus& status);
+        void executeDiagnostics(core::IDevice::SharedPtr_t& device, RunnerStatus& status);
+        void executeAutoTest(core::IDevice::SharedPtr_t& device, RunnerStatus& status);
+        void executeApplyMSeedSettings(core::IDevice::SharedPtr_t& device, core::MSeedSettings newSettings, RunnerStatus& status);
 
+        bool logEnabled(common::LogLevel level) const;
         void log(common::LogLevel level, const QString& message);
         void logInfo(const QString& message);
         void logDebug(const QString& message);
         void logError(const QString& message);
 
-        IntegerMSeedRecord::SharedPtr_t createIntegerRecord(QString channelName, double samplingRateHz, QDateTime time);
+        IDevice::SharedPtr_t createDevice();
+        static IntegerMSeedRecord::SharedPtr_t createIntegerRecord(const RunnerConfig& config, QString channelName, double samplingRateHz, QDateTime time);
         void flushSamplesCache();
         void handlePendingWebServerCommands();
+        // Stops the logging first if it is running, the same as every command does.
+        void executeCommand(const RunnerCommand::SharedPtr_t& cmd);
         void handleNewDataSamples();
+        void publishStatus();
+
+        enum RunnerEvent
+        {
+            NoEvents = 0x0,
+            CommandsEvent = 0x1,
+            DeviceInputEvent = 0x2
+        };
+        // Blocks until commands arrive, the device has input (while running) or the timeout expires (-1 = infinite).
+        // Returns a combination of RunnerEvent flags, NoEvents on timeout.
+        int waitForEvents(int timeoutMs);
+
+        static const int AcceptableSampleDelayMs = 1000;
+        static const int FallbackPollSliceMs = 20;
 
         WebServer::SharedPtr_t _webServer;
         RunnerActionHandler::SharedPtr_t _actionHandler;
+        LiveActionHandler::SharedPtr_t _liveHandler;
         RunnerConfig _config;
         BufferedLogger::SharedPtr_t _webLogger;
 
         // Runner loop components and data
-        EbDevice::SharedPtr_t _device;
+        IDevice::SharedPtr_t _device;
         MSeedWriter::SharedPtr_t _writer;
         QVector<EbDevice::Sample> _samplesCache;
+        // when the oldest sample in the cache has been received
+        std::chrono::steady_clock::time_point _samplesCacheStarted;
+        // Owned by the runner thread, the web server only sees published copies
+        RunnerStatus _status;
         bool _isRunning;
         bool _isFlushing;
         int _samplingIntervalMs;
+        // as reported by the device, the interval is rounded
+        double _samplingRateHz;
         int _timeFixIntervalSeconds;
+        std::atomic<bool> _stopRequested;
     };
 }
@@ -1,82 +1,189 @@
 ﻿#include "RunnerActionHandler.h"
-#include <mongoose.h>
 #include <common/InvalidOperationException.h>
-#include <common/Helpers.h>
+#include <common/JsonWriter.h>
 #include "RunnerCommands.h"
+#include "SampleColumns.h"
+#include <cmath>
 
-core::RunnerActionHandler::RunnerActionHandler() : _status(new RunnerStatus()), _logger(new BufferedLogger())
+namespace
 {
+    const char* commandName(core::RunnerCommandType type)
+    {
+        switch (type)
+        {
+        case core::Run:
+            return "run";
+        case core::Stop:
+            return "stop";
+        case core::UpdateStatus:
+            return "update-status";
+        case core::SetTime:
+            return "set-device-time";
+        case core::SetRange:
+            return "set-device-range";
+        case core::SetStandBy:
+            return "set-device-stand-by";
+        case core::RunDiagnostics:
+            return "run-diagnostics";
+        case core::RunModeAutoTest:
+            return "run-mode-auto-test";
+        case core::ApplyMSeedSettings:
+            return "apply-mseed-settings";
+        default:
+            return "unknown";
+        }
+    }
+
+    // "enqueued" is what api/command used to answer before commands could be waited for
+    const char* commandStateName(core::RunnerCommandState state)
+    {
+        switch (state)
+        {
+        case core::CommandRunning:
+            return "running";
+        case core::CommandCompleted:
+            return "completed";
+        case core::CommandFailed:
+            return "failed";
+        default:
+            return "enqueued";
+        }
+    }
 }
 
-bool core::RunnerActionHandler::match()
+core::RunnerActionHandler::RunnerActionHandler() : _pendingCommandsCount(0), _commandWaiters(0), _lastCommandId(0), _statusVersion(0), _logger(new BufferedLogger())
 {
-    /*
-    GET api/status
-    POST api/command
-    */
-    return
-        (exactMatch("api/status") && methodMatch("GET")) ||
-        (exactMatch("api/log") && methodMatch("GET")) ||
-        (exactMatch("api/data") && methodMatch("GET")) ||
-        (exactMatch("api/command") && methodMatch("POST"));
+    _etagPrefix = QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 36);
 }
 
-void core::RunnerActionHandler::addToDataBuffer(const EbDevice::Sample& sample)
+void core::RunnerActionHandler::registerRoutes(WebRouter& router)
 {
-    dataSamples.append(sample);
-    while (dataSamples.size() > maxDataSamplesListSize)
+    router.add("GET", "api/status", this, [this]() { executeStatus(); });
+    router.add("POST", "api/command", this, [this]() { executeCommand(); });
+    router.add("GET", "api/command/{id}", this, [this]() { executeCommandResult(); });
+    router.add("GET", "api/log", this, [this]() { executeLog(); });
+    router.add("GET", "api/data", this, [this]() { executeData(); });
+    router.add("GET", "api/data/binary", this, [this]() { executeBinaryData(); });
+    router.add("GET", "api/aggregates", this, [this]() { executeAggregates(); });
+}
+
+void core::RunnerActionHandler::publishStatus(RunnerStatus& status)
+{
+    status.version = ++_statusVersion;
+    _status.store(std::make_shared<RunnerStatus>(status));
+}
+
+void core::RunnerActionHandler::addToDataBuffer(const QList<EbDevice::Sample>& samples)
+{
+    if (samples.empty())
+    {
+        return;
+    }
+    auto current = _data.load();
+    auto data = std::make_shared<RunnerDataSnapshot>();
+    int keepCount = qMax(0, qMin(current->samples.size(), maxDataSamplesListSize - samples.size()));
+    data->samples.reserve(keepCount + samples.size());
+    for (int i = current->samples.size() - keepCount; i < current->samples.size(); i++)
+    {
+        data->samples.append(current->samples[i]);
+    }
+    for (int i = qMax(0, samples.size() - maxDataSamplesListSize); i < samples.size(); i++)
     {
-        dataSamples.pop_front();
+        data->samples.append(samples[i]);
     }
+    data->lastSampleId = current->lastSampleId + samples.size();
+    _data.store(data);
 }
 
-void core::RunnerActionHandler::addRunCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::enqueueCommand(RunnerCommand::SharedPtr_t command)
+{
+    command->id(++_lastCommandId);
+    {
+        std::lock_guard<std::mutex> lock(_recentCommandsMutex);
+        _recentCommands.insert(command->id(), command);
+        _recentCommandIds.enqueue(command->id());
+        while (_recentCommandIds.size() > MaxRecentCommands)
+        {
+            _recentCommands.remove(_recentCommandIds.dequeue());
+        }
+    }
+    _pendingCommandsCount.fetch_add(1, std::memory_order_relaxed);
+    _commands.enqueue(command);
+    _commandsNotifier.notify();
+    return command;
+}
+
+void core::RunnerActionHandler::sendCommandResult(const RunnerCommand& command, int status)
+{
+    auto state = command.state();
+    auto& buffer = responseBuffer();
+    common::JsonWriter writer(buffer);
+    writer.beginObject()
+        .field("result", commandStateName(state))
+        .field("id", command.id())
+        .field("command", commandName(command.type()));
+    if (state == CommandFailed)
+    {
+        writer.field("error", command.error());
+    }
+    writer.endObject();
+    if (status != 200)
+    {
+        response().status(status);
+        response().header("Content-Type", "application/json");
+        response().end(buffer);
+        return;
+    }
+    sendResponse(CachedResponse("application/json", buffer));
+}
+
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addRunCommand(QJsonObject json)
 {
     auto intervalMilliseconds = json.value("intervalMilliseconds").toInt();
     auto timeFixIntervalSeconds = json.value("timeFixIntervalSeconds").toInt();
-    _commands.enqueue(std::make_shared<RunRunnerCommand>(intervalMilliseconds, timeFixIntervalSeconds));
+    return enqueueCommand(std::make_shared<RunRunnerCommand>(intervalMilliseconds, timeFixIntervalSeconds));
 }
 
-void core::RunnerActionHandler::addStopCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addStopCommand(QJsonObject json)
 {
-    _commands.enqueue(std::make_shared<StopRunnerCommand>());
+    return enqueueCommand(std::make_shared<StopRunnerCommand>());
 }
 
-void core::RunnerActionHandler::addUpdateStatusCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addUpdateStatusCommand(QJsonObject json)
 {
-    _commands.enqueue(std::make_shared<UpdateStatusRunnerCommand>());
+    return enqueueCommand(std::make_shared<UpdateStatusRunnerCommand>());
 }
 
-void core::RunnerActionHandler::addSetTimeCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addSetTimeCommand(QJsonObject json)
 {
     auto unixTime = json.value("time").toInt();
     auto time = QDateTime::fromTime_t(unixTime, Qt::UTC);
-    _commands.enqueue(std::make_shared<SetTimeRunnerCommand>(time));
+    return enqueueCommand(std::make_shared<SetTimeRunnerCommand>(time));
 }
 
-void core::RunnerActionHandler::addSetRangeCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addSetRangeCommand(QJsonObject json)
 {
     auto range = json.value("range").toInt();
-    _commands.enqueue(std::make_shared<SetRangeRunnerCommand>(range));
+    return enqueueCommand(std::make_shared<SetRangeRunnerCommand>(range));
 }
 
-void core::RunnerActionHandler::addSetStandByCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addSetStandByCommand(QJsonObject json)
 {
     auto standBy = json.value("standBy").toBool();
-    _commands.enqueue(std::make_shared<SetStandByRunnerCommand>(standBy));
+    return enqueueCommand(std::make_shared<SetStandByRunnerCommand>(standBy));
 }
 
-void core::RunnerActionHandler::addRunDiagnosticsCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addRunDiagnosticsCommand(QJsonObject json)
 {
-    _commands.enqueue(std::make_shared<RunDiagnosticsRunnerCommand>());
+    return enqueueCommand(std::make_shared<RunDiagnosticsRunnerCommand>());
 }
 
-void core::RunnerActionHandler::addRunModeAutoTestCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addRunModeAutoTestCommand(QJsonObject json)
 {
-    _commands.enqueue(std::make_shared<RunModeAutoTestRunnerCommand>());
+    return enqueueCommand(std::make_shared<RunModeAutoTestRunnerCommand>());
 }
 
-void core::RunnerActionHandler::addApplyMSeedSettingsCommand(QJsonObject json)
+core::RunnerCommand::SharedPtr_t core::RunnerActionHandler::addApplyMSeedSettingsCommand(QJsonObject json)
 {
     MSeedSettings settings;
     settings.fileName = json.value("fileName").toString();
@@ -84,151 +191,351 @@ void core::RunnerActionHandler::addApplyMSeedSettingsCommand(QJsonObject json)
     settings.network = json.value("network").toString();
     settings.station = json.value("station").toString();
     settings.samplesInRecord = json.value("samplesInRecord").toInt();
-    _commands.enqueue(std::make_shared<ApplyMSeedSettingsRunnerCommand>(settings));
-}
-
-void core::RunnerActionHandler::execute()
-{
-    QMutexLocker lock(dataMutex());
-    if (exactMatch("api/status"))
-    {
-        // api/status
-        QJsonDocument document;
-        QJsonObject json;
-        json["about"] = _status->about;
-        json["enq"] = _status->enq;
-        json["time"] = common::Helpers::toISODateWithMilliseconds(_status->time);
-        json["timeUpdated"] = common::Helpers::toISODateWithMilliseconds(_status->timeUpdated);
-        json["updated"] = common::Helpers::toISODateWithMilliseconds(_status->updated);
-        json["standBy"] = _status->standBy;
-        json["isRunning"] = _status->isRunning;
-        json["samplingIntervalMs"] = _status->samplingIntervalMs;
-        json["timeFixIntervalSeconds"] = _status->timeFixIntervalSeconds;
-        
-        QJsonObject range;
-        range["minField"] = _status->range.minField;
-        range["maxField"] = _status->range.maxField;
-        json["range"] = range;
-        
-        QJsonObject mseedSettings;
-        mseedSettings["fileName"] = _status->mseedSettings.fileName;
-        mseedSettings["location"] = _status->mseedSettings.location;
-        mseedSettings["network"] = _status->mseedSettings.network;
-        mseedSettings["station"] = _status->mseedSettings.station;
-        mseedSettings["samplesInRecord"] = _status->mseedSettings.samplesInRecord;
-        json["mseedSettings"] = mseedSettings;
-
-        json["commandQueueSize"] = _status->commandQueueSize;
-
-        document.setObject(json);
-        auto jsonData = document.toJson(QJsonDocument::JsonFormat::Indented);
-
-        mg_send_data(connection(), jsonData.data(), jsonData.size());
-    }
-    else if (exactMatch("api/command"))
-    {
-        // api/command
-        QString content(QByteArray(connection()->content, connection()->content_len));
-        QJsonDocument doc = QJsonDocument::fromJson(content.toLatin1());
-        auto root = doc.object();
-        auto command = root.value("command").toString();
-        if (command == "run")
-        {
-            addRunCommand(root);
-        }
-        else if (command == "stop")
-        {
-            addStopCommand(root);
-        }
-        else if (command == "update-status")
-        {
-            addUpdateStatusCommand(root);
-        }
-        else if (command == "set-device-time")
-        {
-            addSetTimeCommand(root);
-        }
-        else if (command == "set-device-range")
-        {
-            addSetRangeCommand(root);
-        }
-        else if (command == "set-device-stand-by")
-        {
-            addSetStandByCommand(root);
-        }
-        else if (command == "run-diagnostics")
-        {
-            addRunDiagnosticsCommand(root);
-        }
-        else if (command == "run-mode-auto-test")
-        {
-            addRunModeAutoTestCommand(root);
-        }
-        else if (command == "apply-mseed-settings")
-        {
-            addApplyMSeedSettingsCommand(root);
-        }
-        else
-        {
-            throw common::InvalidOperationException(QString("Command `%1` is not supported.").arg(command));
-        }
+    return enqueueCommand(std::make_shared<ApplyMSeedSettingsRunnerCommand>(settings));
+}
+
+void core::RunnerActionHandler::writeStatusJson(QByteArray& buffer, const RunnerStatus& status, int pendingCommandsCount)
+{
+    common::JsonWriter writer(buffer);
+    writer.beginObject()
+        .field("about", status.about)
+        .field("enq", status.enq);
+    writer.key("time").timeValue(status.time);
+    writer.key("timeUpdated").timeValue(status.timeUpdated);
+    writer.key("updated").timeValue(status.updated);
+    writer.field("standBy", status.standBy)
+        .field("isRunning", status.isRunning)
+        .field("samplingIntervalMs", status.samplingIntervalMs)
+        .field("timeFixIntervalSeconds", status.timeFixIntervalSeconds);
+
+    writer.key("range").beginObject()
+        .field("minField", status.range.minField)
+        .field("maxField", status.range.maxField)
+        .endObject();
+
+    writer.key("mseedSettings").beginObject()
+        .field("fileName", status.mseedSettings.fileName)
+        .field("location", status.mseedSettings.location)
+        .field("network", status.mseedSettings.network)
+        .field("station", status.mseedSettings.station)
+        .field("samplesInRecord", status.mseedSettings.samplesInRecord)
+        .endObject();
+
+    writer.field("commandQueueSize", pendingCommandsCount);
+    writer.endObject();
+}
+
+core::CachedResponse::SharedPtr_t core::RunnerActionHandler::buildStatusResponse(const RunnerStatus& status, int pendingCommandsCount, const QByteArray& etag)
+{
+    auto& buffer = responseBuffer();
+    writeStatusJson(buffer, status, pendingCommandsCount);
+    return std::make_shared<CachedResponse>("application/json", buffer, etag);
+}
 
-        _status->commandQueueSize++;
-        mg_printf_data(connection(), "{ \"result\": \"enqueued\" }");
+void core::RunnerActionHandler::writeDataJson(QByteArray& buffer, const RunnerDataSnapshot& data, quint64 since)
+{
+    common::JsonWriter writer(buffer);
+    writer.beginObject().key("samples").beginArray();
+    for (int i = data.indexAfter(since); i < data.samples.size(); i++)
+    {
+        auto& sample = data.samples[i];
+        writer.beginObject();
+        writer.key("time").timeValue(sample.time);
+        writer.field("field", sample.field)
+            .field("qmc", sample.qmc)
+            .field("state", sample.state)
+            .endObject();
     }
-    else if (exactMatch("api/log"))
+    writer.endArray();
+    writer.field("cursor", data.lastSampleId);
+    writer.endObject();
+}
+
+core::CachedResponse::SharedPtr_t core::RunnerActionHandler::buildDataResponse(const RunnerDataSnapshot& data, quint64 since, const QByteArray& etag)
+{
+    auto& buffer = responseBuffer();
+    writeDataJson(buffer, data, since);
+    return std::make_shared<CachedResponse>("application/json", buffer, etag);
+}
+
+uint64_t core::RunnerActionHandler::writeLogJson(QByteArray& buffer, const BufferedLogger& logger, uint64_t sinceId)
+{
+    common::JsonWriter writer(buffer);
+    writer.beginObject().key("messages").beginArray();
+    uint64_t lastId = logger.readRecordsSince(sinceId, [&writer](uint64_t id, const BufferRecord& record)
     {
-        // api/log
-        QJsonDocument document;
-        QJsonObject json;
-        QJsonArray messages;
+        writer.beginObject();
+        writer.key("time").timeValue(record.timeMs);
+        writer.field("id", id)
+            .field("logLevel", BufferedLogger::levelCode(static_cast<common::LogLevel>(record.logLevel)));
+        writer.key("message").value(record.message, record.messageSize);
+        writer.endObject();
+    });
+    writer.endArray();
+    writer.field("lastId", lastId);
+    writer.endObject();
+    return lastId;
+}
 
-        for (auto& msg : _logger->buffer())
-        {
-            QJsonObject messageObject;
-            messageObject["time"] = common::Helpers::toISODateWithMilliseconds(msg.time);
-            messageObject["id"] = qint64(msg.id);
-            messageObject["logLevel"] = msg.logLevel;
-            messageObject["message"] = msg.message;
-            messages.append(messageObject);
-        }
+void core::RunnerActionHandler::executeStatus()
+{
+    // api/status
+    auto status = _status.load();
+    int pendingCount = pendingCommandsCount();
+    auto etag = "\"" + _etagPrefix + "-" + QByteArray::number(status->version) + "-" + QByteArray::number(pendingCount) + "\"";
+    auto response = _statusResponse.load();
+    if (response->etag != etag)
+    {
+        response = buildStatusResponse(*status, pendingCount, etag);
+        _statusResponse.store(response);
+    }
+    sendResponse(*response);
+}
 
-        json["messages"] = messages;
-        document.setObject(json);
-        auto jsonData = document.toJson(QJsonDocument::JsonFormat::Indented);
+void core::RunnerActionHandler::executeCommand()
+{
+    // api/command[?wait=<ms to wait for the command to finish>]
+    QString content(request().content());
+    QJsonDocument doc = QJsonDocument::fromJson(content.toLatin1());
+    auto root = doc.object();
+    auto command = root.value("command").toString();
+    RunnerCommand::SharedPtr_t queued;
+    if (command == "run")
+    {
+        queued = addRunCommand(root);
+    }
+    else if (command == "stop")
+    {
+        queued = addStopCommand(root);
+    }
+    else if (command == "update-status")
+    {
+        queued = addUpdateStatusCommand(root);
+    }
+    else if (command == "set-device-time")
+    {
+        queued = addSetTimeCommand(root);
+    }
+    else if (command == "set-device-range")
+    {
+        queued = addSetRangeCommand(root);
+    }
+    else if (command == "set-device-stand-by")
+    {
+        queued = addSetStandByCommand(root);
+    }
+    else if (command == "run-diagnostics")
+    {
+        queued = addRunDiagnosticsCommand(root);
+    }
+    else if (command == "run-mode-auto-test")
+    {
+        queued = addRunModeAutoTestCommand(root);
+    }
+    else if (command == "apply-mseed-settings")
+    {
+        queued = addApplyMSeedSettingsCommand(root);
+    }
+    else
+    {
+        throw common::InvalidOperationException(QString("Command `%1` is not supported.").arg(command));
+    }
+
+    int waitMs = 0;
+    QString waitValue;
+    if (queryVariable("wait", waitValue))
+    {
+        waitMs = qBound(0, waitValue.toInt(), int(MaxCommandWaitMs));
+    }
+    if (waitMs == 0)
+    {
+        sendCommandResult(*queued);
+        return;
+    }
+    // with too many requests waiting already, the answer is immediate
+    if (_commandWaiters.fetch_add(1, std::memory_order_relaxed) < maxCommandWaiters())
+    {
+        queued->waitFinished(waitMs);
+    }
+    _commandWaiters.fetch_sub(1, std::memory_order_relaxed);
+    // a command that has not finished is only accepted, the client follows it with api/command/{id}
+    auto state = queued->state();
+    sendCommandResult(*queued, state == CommandCompleted || state == CommandFailed ? 200 : 202);
+}
+
+int core::RunnerActionHandler::maxCommandWaiters() const
+{
+    return server() != nullptr ? qMax(1, server()->workerThreads() / WorkersPerCommandWaiter) : 1;
+}
 
-        mg_send_data(connection(), jsonData.data(), jsonData.size());
+void core::RunnerActionHandler::executeCommandResult()
+{
+    // api/command/{id}
+    auto id = request().routeParameter("id").toULongLong();
+    RunnerCommand::SharedPtr_t command;
+    {
+        std::lock_guard<std::mutex> lock(_recentCommandsMutex);
+        command = _recentCommands.value(id);
+    }
+    if (!command)
+    {
+        response().status(404);
+        response().header("Content-Type", "application/json");
+        response().end("{\"error\":\"The command is unknown or has been forgotten.\"}");
+        return;
+    }
+    sendCommandResult(*command);
+}
+
+void core::RunnerActionHandler::executeLog()
+{
+    // api/log[?sinceId=<lastId from the previous response>]
+    uint64_t sinceId = 0;
+    QString sinceIdValue;
+    if (queryVariable("sinceId", sinceIdValue))
+    {
+        sinceId = sinceIdValue.toULongLong();
     }
-    else if (exactMatch("api/data"))
+    if (sinceId > _logger->lastId())
     {
-        // api/data
-        QJsonDocument document;
-        QJsonObject json;
-        QJsonArray samples;
+        // the cursor is from another process lifetime, start over
+        sinceId = 0;
+    }
 
-        for (auto& sample : dataSamples)
+    auto& buffer = responseBuffer();
+    writeLogJson(buffer, *_logger, sinceId);
+    sendResponse(CachedResponse("application/json", buffer));
+}
+
+void core::RunnerActionHandler::executeData()
+{
+    // api/data[?since=<cursor from the previous response>]
+    auto data = _data.load();
+    quint64 since = 0;
+    QString sinceValue;
+    if (queryVariable("since", sinceValue))
+    {
+        since = sinceValue.toULongLong();
+    }
+    if (since > data->lastSampleId)
+    {
+        // the cursor is from another process lifetime, start over
+        since = 0;
+    }
+    if (since == 0)
+    {
+        // the complete list is the same for every client until new samples arrive
+        auto etag = "\"" + _etagPrefix + "-d" + QByteArray::number(data->lastSampleId) + "\"";
+        auto response = _dataResponse.load();
+        if (response->etag != etag)
         {
-            QJsonObject messageObject;
-            messageObject["time"] = common::Helpers::toISODateWithMilliseconds(sample.time);
-            messageObject["field"] = sample.field;
-            messageObject["qmc"] = sample.qmc;
-            messageObject["state"] = sample.state;
-            samples.append(messageObject);
+            response = buildDataResponse(*data, 0, etag);
+            _dataResponse.store(response);
         }
+        sendResponse(*response);
+    }
+    else
+    {
+        sendResponse(*buildDataResponse(*data, since, QByteArray()));
+    }
+}
 
-        json["samples"] = samples;
-        document.setObject(json);
-        auto jsonData = document.toJson(QJsonDocument::JsonFormat::Indented);
+void core::RunnerActionHandler::executeBinaryData()
+{
+    // api/data/binary[?since=<cursor>][&delta=1], see SampleColumns for the format
+    auto data = _data.load();
+    quint64 since = 0;
+    QString sinceValue;
+    if (queryVariable("since", sinceValue))
+    {
+        since = sinceValue.toULongLong();
+    }
+    if (since > data->lastSampleId)
+    {
+        since = 0;
+    }
+    QString deltaValue;
+    int flags = queryVariable("delta", deltaValue) && deltaValue == "1" ? SampleColumns::DeltaEncoded : SampleColumns::NoFlags;
+    int firstIndex = data->indexAfter(since);
+    auto encoded = SampleColumns::encode(data->samples.constData() + firstIndex, data->samples.size() - firstIndex, data->lastSampleId, flags);
+    sendResponse(CachedResponse("application/octet-stream", encoded));
+}
 
-        mg_send_data(connection(), jsonData.data(), jsonData.size());
+void core::RunnerActionHandler::executeAggregates()
+{
+    // api/aggregates?level=<1s|1m|1h>[&since=<cursor>][&from=<ms since epoch>]
+    // buckets: [startMs, min, max, mean, count], current: the bucket still being filled (or null)
+    auto level = AggregatePyramid::Minutes;
+    QString levelValue;
+    if (queryVariable("level", levelValue))
+    {
+        if (levelValue == "1s")
+        {
+            level = AggregatePyramid::Seconds;
+        }
+        else if (levelValue == "1h")
+        {
+            level = AggregatePyramid::Hours;
+        }
     }
-    else
+    uint64_t since = 0;
+    QString sinceValue;
+    if (queryVariable("since", sinceValue))
+    {
+        since = sinceValue.toULongLong();
+    }
+    if (since > _aggregates.lastId(level))
+    {
+        since = 0;
+    }
+    qint64 fromMs = 0;
+    QString fromValue;
+    if (queryVariable("from", fromValue))
     {
-        throw common::InvalidOperationException();
+        fromMs = fromValue.toLongLong();
     }
+
+    auto& buffer = responseBuffer();
+    writeAggregatesJson(buffer, _aggregates, level, since, fromMs);
+    sendResponse(CachedResponse("application/json", buffer));
 }
 
-QMutex* core::RunnerActionHandler::dataMutex()
+void core::RunnerActionHandler::writeAggregatesJson(QByteArray& buffer, const AggregatePyramid& aggregates, AggregatePyramid::Level level,
+    uint64_t since, qint64 fromMs)
 {
-    return &_dataMutex;
+    common::JsonWriter writer(buffer);
+    auto writeBucket = [&writer](const SampleAggregate& bucket)
+    {
+        writer.beginArray()
+            .value(static_cast<long long>(bucket.startMs))
+            .value(bucket.min)
+            .value(bucket.max)
+            // one decimal is below the resolution of the magnetometer
+            .value(std::round(static_cast<double>(bucket.sum) * 10 / bucket.count) / 10)
+            .value(bucket.count)
+            .endArray();
+    };
+    writer.beginObject()
+        .field("level", level == AggregatePyramid::Seconds ? "1s" : level == AggregatePyramid::Minutes ? "1m" : "1h");
+    writer.key("buckets").beginArray();
+    auto cursor = aggregates.readSince(level, since, [&](uint64_t, const SampleAggregate& bucket)
+    {
+        if (bucket.startMs >= fromMs)
+        {
+            writeBucket(bucket);
+        }
+    });
+    writer.endArray();
+    writer.field("cursor", static_cast<unsigned long long>(cursor));
+    writer.key("current");
+    auto current = aggregates.current(level);
+    if (current.count > 0)
+    {
+        writeBucket(current);
+    }
+    else
+    {
+        writer.nullValue();
+    }
+    writer.endObject();
 }
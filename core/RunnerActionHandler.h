@@ -12,6 +12,13 @@
 #include "WebServer.h"
 #include "RunnerData.h"
 #include "RunnerCommands.h"
+#include "AggregatePyramid.h"
+#include "SampleHistoryStore.h"
+#include <common/MpscQueue.h>
+#include <common/EventNotifier.h>
+#include <common/AtomicSnapshot.h>
+#include <atomic>
+#include <mutex>
 
 namespace core
 {
@@ -27,13 +34,19 @@ namespace core
             return "RunnerActionHandler";
         }
 
-        bool match() override;
-        void execute() override;
-        QMutex* dataMutex();
+        void registerRoutes(WebRouter& router) override;
 
-        RunnerStatus::SharedPtr_t& status()
+        // Runner thread only: publishes a copy of the status (with a new version), web threads read it lock-free.
+        void publishStatus(RunnerStatus& status);
+
+        common::AtomicSnapshot<RunnerStatus>::Ptr_t status() const
+        {
+            return _status.load();
+        }
+
+        common::AtomicSnapshot<RunnerDataSnapshot>::Ptr_t data() const
         {
-            return _status;
+            return _data.load();
         }
 
         BufferedLogger::SharedPtr_t& logger()
@@ -41,31 +54,91 @@ namespace core
             return _logger;
         }
 
-        void setStatus(RunnerStatus::SharedPtr_t runnerStatus)
+        // Filled by web server threads, drained by the runner thread only.
+        common::MpscQueue<RunnerCommand::SharedPtr_t>& commands() { return _commands; }
+
+        // Signaled after every enqueued command.
+        common::EventNotifier& commandsNotifier() { return _commandsNotifier; }
+
+        // Runner thread: a dequeued command has been executed.
+        void commandCompleted()
         {
-            _status = runnerStatus;
+            _pendingCommandsCount.fetch_sub(1, std::memory_order_relaxed);
         }
 
-        QQueue<RunnerCommand::SharedPtr_t>& commands() { return _commands; }
+        // Commands that are either queued or being executed.
+        int pendingCommandsCount() const
+        {
+            return _pendingCommandsCount.load(std::memory_order_relaxed);
+        }
+
+        // Runner thread only: appends the samples and publishes the new data snapshot.
+        void addToDataBuffer(const QList<EbDevice::Sample>& samples);
+
+        // Filled by the runner thread with the valid samples.
+        AggregatePyramid& aggregates() { return _aggregates; }
+
+        // Raw samples of the last days, appended and published by the runner thread.
+        SampleHistoryStore& history() { return _history; }
 
-        void addToDataBuffer(const EbDevice::Sample& sample);
+        // The JSON bodies of api/status, api/data, api/log and api/aggregates, appended to buffer.
+        static void writeStatusJson(QByteArray& buffer, const RunnerStatus& status, int pendingCommandsCount);
+        static void writeDataJson(QByteArray& buffer, const RunnerDataSnapshot& data, quint64 since);
+        // Returns the id of the last message written.
+        static uint64_t writeLogJson(QByteArray& buffer, const BufferedLogger& logger, uint64_t sinceId);
+        static void writeAggregatesJson(QByteArray& buffer, const AggregatePyramid& aggregates, AggregatePyramid::Level level,
+            uint64_t since, qint64 fromMs);
     private:
-        void addRunCommand(QJsonObject json);
-        void addStopCommand(QJsonObject json);
-        void addUpdateStatusCommand(QJsonObject json);
-        void addSetTimeCommand(QJsonObject json);
-        void addSetRangeCommand(QJsonObject json);
-        void addSetStandByCommand(QJsonObject json);
-        void addRunDiagnosticsCommand(QJsonObject json);
-        void addRunModeAutoTestCommand(QJsonObject json);
-        void addApplyMSeedSettingsCommand(QJsonObject json);
+        void executeStatus();
+        void executeCommand();
+        void executeLog();
+        void executeData();
+        void executeBinaryData();
+        void executeAggregates();
+        void executeCommandResult();
+        RunnerCommand::SharedPtr_t enqueueCommand(RunnerCommand::SharedPtr_t command);
+        void sendCommandResult(const RunnerCommand& command, int status = 200);
+        // Requests that may block a web server worker in api/command?wait= at the same time.
+        int maxCommandWaiters() const;
+        RunnerCommand::SharedPtr_t addRunCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addStopCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addUpdateStatusCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addSetTimeCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addSetRangeCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addSetStandByCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addRunDiagnosticsCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addRunModeAutoTestCommand(QJsonObject json);
+        RunnerCommand::SharedPtr_t addApplyMSeedSettingsCommand(QJsonObject json);
+        CachedResponse::SharedPtr_t buildStatusResponse(const RunnerStatus& status, int pendingCommandsCount, const QByteArray& etag);
+        CachedResponse::SharedPtr_t buildDataResponse(const RunnerDataSnapshot& data, quint64 since, const QByteArray& etag);
 
         static const int maxDataSamplesListSize = 100;
+        // Commands that can be looked up with api/command/{id}, the oldest are forgotten first
+        static const int MaxRecentCommands = 256;
+        // Longest api/command?wait=, the request holds a web server worker meanwhile
+        static const int MaxCommandWaitMs = 30000;
+        // One waiting request per this many workers (at least one), the others get 202 with the command id at once,
+        // so that slow device commands do not stall the other endpoints
+        static const int WorkersPerCommandWaiter = 4;
 
-        QList<EbDevice::Sample> dataSamples;
-        QQueue<RunnerCommand::SharedPtr_t> _commands;
-        RunnerStatus::SharedPtr_t _status;
+        common::AtomicSnapshot<RunnerDataSnapshot> _data;
+        AggregatePyramid _aggregates;
+        SampleHistoryStore _history;
+        common::MpscQueue<RunnerCommand::SharedPtr_t> _commands;
+        common::EventNotifier _commandsNotifier;
+        std::atomic<int> _pendingCommandsCount;
+        std::atomic<int> _commandWaiters;
+        std::atomic<quint64> _lastCommandId;
+        std::mutex _recentCommandsMutex;
+        QHash<quint64, RunnerCommand::SharedPtr_t> _recentCommands;
+        QQueue<quint64> _recentCommandIds;
+        common::AtomicSnapshot<RunnerStatus> _status;
+        quint64 _statusVersion;
         BufferedLogger::SharedPtr_t _logger;
-        QMutex _dataMutex;
+        // Responses are rebuilt only when the data behind them changes. ETags start with the process start time,
+        // versions restart from 1 with every process.
+        QByteArray _etagPrefix;
+        common::AtomicSnapshot<CachedResponse> _statusResponse;
+        common::AtomicSnapshot<CachedResponse> _dataResponse;
     };
 }
@@ -13,6 +13,9 @@
 #include <stdint.h>
 #include <QtCore>
 #include "common/SmartPtr.h"
+#include <atomic>
+#include <chrono>
+#include <future>
 
 namespace core
 {
@@ -30,12 +33,22 @@ namespace core
         ApplyMSeedSettings
     };
 
+    enum RunnerCommandState
+    {
+        CommandQueued,
+        CommandRunning,
+        CommandCompleted,
+        CommandFailed
+    };
+
+    // Created and queued by a web server thread, executed and completed by the runner thread.
+    // Any thread may wait for the completion or read the state, error() is valid once the state is CommandFailed.
     class RunnerCommand
     {
     public:
         SMART_PTR_T(RunnerCommand);
 
-        explicit RunnerCommand()
+        explicit RunnerCommand() : _id(0), _state(CommandQueued), _completion(_completionPromise.get_future().share())
         {
         }
 
@@ -44,6 +57,67 @@ namespace core
         }
 
         virtual RunnerCommandType type() const = 0;
+
+        // Assigned before the command is queued, unique within the process.
+        quint64 id() const
+        {
+            return _id;
+        }
+
+        void id(quint64 id)
+        {
+            _id = id;
+        }
+
+        RunnerCommandState state() const
+        {
+            return static_cast<RunnerCommandState>(_state.load(std::memory_order_acquire));
+        }
+
+        const QString& error() const
+        {
+            return _error;
+        }
+
+        // Runner thread only.
+        void started()
+        {
+            _state.store(CommandRunning, std::memory_order_release);
+        }
+
+        void completed()
+        {
+            finish(CommandCompleted, QString());
+        }
+
+        void failed(const QString& error)
+        {
+            finish(CommandFailed, error);
+        }
+
+        // Returns true if the command has completed or failed within the timeout.
+        bool waitFinished(int timeoutMs) const
+        {
+            return _completion.wait_for(std::chrono::milliseconds(timeoutMs)) == std::future_status::ready;
+        }
+    private:
+        void finish(RunnerCommandState state, const QString& error)
+        {
+            int current = _state.load(std::memory_order_relaxed);
+            if (current == CommandCompleted || current == CommandFailed)
+            {
+                return;
+            }
+            _error = error;
+            _state.store(state, std::memory_order_release);
+            _completionPromise.set_value();
+        }
+
+        quint64 _id;
+        std::atomic<int> _state;
+        QString _error;
+        std::promise<void> _completionPromise;
+        std::shared_future<void> _completion;
     };
 
     class RunRunnerCommand : public RunnerCommand
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "EbDevice.h"
+#include "SyntheticDevice.h"
 
 namespace core
 {
@@ -42,8 +43,8 @@ namespace core
             standBy = false;
             isRunning = false;
             samplingIntervalMs = 0;
-            commandQueueSize = 0;
             timeFixIntervalSeconds = 0;
+            version = 0;
         }
 
         QDateTime timeUpdated;
@@ -51,20 +52,65 @@ namespace core
         bool standBy;
         bool isRunning;
         int samplingIntervalMs;
-        int commandQueueSize;
         MSeedSettings mseedSettings;
         int timeFixIntervalSeconds;
+        // Incremented by every publication.
+        quint64 version;
+    };
+
+    // Most recent samples as seen by the web server.
+    struct RunnerDataSnapshot
+    {
+        SMART_PTR_T(RunnerDataSnapshot);
+
+        RunnerDataSnapshot()
+        {
+            lastSampleId = 0;
+        }
+
+        QVector<EbDevice::Sample> samples;
+        // Id of the last sample in the list, samples are numbered continuously from 1.
+        quint64 lastSampleId;
+
+        quint64 sampleId(int index) const
+        {
+            return lastSampleId - samples.size() + 1 + index;
+        }
+
+        // Index of the first sample with id > sampleId (samples.size() if there are none).
+        int indexAfter(quint64 sampleId) const
+        {
+            quint64 firstSampleId = lastSampleId - samples.size() + 1;
+            if (sampleId >= lastSampleId)
+            {
+                return samples.size();
+            }
+            return sampleId >= firstSampleId ? int(sampleId - firstSampleId + 1) : 0;
+        }
     };
 
     struct RunnerConfig
     {
         int webServerPort;
+        int webServerWorkerThreads;
+        int webServerMaxConnections;
+        // Directory with the built dashboard, not served if empty or missing
+        QString webServerPublicDir;
+        int webServerStaticMaxAgeSeconds;
         QString devicePortName;
+        // gsm19 (the default) or synthetic
+        QString deviceType;
+        SyntheticDeviceSettings syntheticDevice;
         QString msRecordLocation;
         QString msRecordNetwork;
         QString msRecordStation;
         QString msFileName;
         int samplesCacheMaxSize;
         bool skipDiagnostics;
+        int historyRetentionDays;
+        // Memory limit of the in-memory history, whichever of the two is reached first applies
+        int historyMaxSizeMb;
+        // Least severe common::LogLevel kept in the dashboard log
+        int webLogLevel;
     };
 }
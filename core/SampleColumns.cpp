@@ -0,0 +1,96 @@
+#include "SampleColumns.h"
+#include <vector>
+
+namespace
+{
+    const char Magic[4] = { 'G', 'E', 'M', 'S' };
+}
+
+QByteArray core::SampleColumns::encode(const EbDevice::Sample* samples, int count, quint64 cursor, int flags)
+{
+    typedef common::LittleEndianConverter Converter;
+    QByteArray result(encodedSize(count), '\0');
+    char* data = result.data();
+
+    memcpy(data, Magic, sizeof(Magic));
+    Converter::ToByteArray(static_cast<uint8_t>(FormatVersion), data + 4);
+    Converter::ToByteArray(static_cast<uint8_t>(flags), data + 5);
+    Converter::ToByteArray(static_cast<uint16_t>(HeaderSize), data + 6);
+    Converter::ToByteArray(static_cast<uint32_t>(count), data + 8);
+    Converter::ToByteArray(static_cast<uint32_t>(0), data + 12);
+    Converter::ToByteArray(static_cast<uint64_t>(cursor), data + 16);
+
+    char* times = data + HeaderSize;
+    char* fields = times + count * 8;
+    char* qmcs = fields + count * 4;
+    char* states = qmcs + count * 2;
+    // the columns are gathered in machine order and converted in one pass each (a plain copy on little-endian machines)
+    std::vector<int64_t> timeValues(count);
+    std::vector<uint32_t> fieldValues(count);
+    std::vector<uint16_t> qmcValues(count);
+    bool delta = (flags & DeltaEncoded) != 0;
+    int64_t previousTime = 0;
+    uint32_t previousField = 0;
+    for (int i = 0; i < count; i++)
+    {
+        auto& sample = samples[i];
+        int64_t time = sample.time.toMSecsSinceEpoch();
+        uint32_t field = static_cast<uint32_t>(sample.field);
+        timeValues[i] = delta ? time - previousTime : time;
+        fieldValues[i] = delta ? field - previousField : field;
+        qmcValues[i] = sample.qmc;
+        states[i] = static_cast<char>(sample.state);
+        previousTime = time;
+        previousField = field;
+    }
+    Converter::ToByteArray(timeValues.data(), count, times);
+    Converter::ToByteArray(fieldValues.data(), count, fields);
+    Converter::ToByteArray(qmcValues.data(), count, qmcs);
+    return result;
+}
+
+bool core::SampleColumns::decode(const QByteArray& data, QVector<EbDevice::Sample>& samples, quint64& cursor)
+{
+    typedef common::LittleEndianConverter Converter;
+    if (data.size() < HeaderSize || memcmp(data.constData(), Magic, sizeof(Magic)) != 0)
+    {
+        return false;
+    }
+    const char* header = data.constData();
+    int headerSize = Converter::GetUInt16(header + 6);
+    uint32_t count = Converter::GetUInt32(header + 8);
+    if (Converter::GetUInt8(header + 4) != FormatVersion || headerSize != HeaderSize ||
+        count > uint32_t(data.size()) || data.size() != encodedSize(int(count)))
+    {
+        return false;
+    }
+    bool delta = (Converter::GetUInt8(header + 5) & DeltaEncoded) != 0;
+    cursor = Converter::GetUInt64(header + 16);
+
+    const char* times = header + HeaderSize;
+    const char* fields = times + count * 8;
+    const char* qmcs = fields + count * 4;
+    const char* states = qmcs + count * 2;
+    std::vector<int64_t> timeValues(count);
+    std::vector<uint32_t> fieldValues(count);
+    std::vector<uint16_t> qmcValues(count);
+    Converter::GetArray(times, timeValues.data(), count);
+    Converter::GetArray(fields, fieldValues.data(), count);
+    Converter::GetArray(qmcs, qmcValues.data(), count);
+    int64_t time = 0;
+    uint32_t field = 0;
+    samples.clear();
+    samples.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EbDevice::Sample sample;
+        time = delta ? time + timeValues[i] : timeValues[i];
+        field = delta ? field + fieldValues[i] : fieldValues[i];
+        sample.time = QDateTime::fromMSecsSinceEpoch(time, Qt::UTC);
+        sample.field = static_cast<int32_t>(field);
+        sample.qmc = qmcValues[i];
+        sample.state = static_cast<EbDevice::SampleState>(static_cast<uint8_t>(states[i]));
+        samples.push_back(sample);
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SampleColumns.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "EbDevice.h"
+#include <common/BitConverterT.h>
+
+namespace core
+{
+    // Packed little-endian columnar representation of samples for the plots (application/octet-stream).
+    //
+    // Header (HeaderSize bytes):
+    //   0  char[4] magic "GEMS"
+    //   4  uint8   format version
+    //   5  uint8   flags (SampleColumns::Flags)
+    //   6  uint16  header size
+    //   8  uint32  sample count (n)
+    //   12 uint32  reserved (0)
+    //   16 uint64  cursor, id of the last sample (to be passed as 'since' to the next request)
+    // Columns follow each other right after the header:
+    //   int64[n] time (ms since epoch, UTC), int32[n] field (pT), uint16[n] qmc (pT), uint8[n] state
+    // Every column starts at an offset aligned to its element size, so the browser can map it with a typed array.
+    // With DeltaEncoded the time and field columns hold the difference to the previous value (the first one is absolute),
+    // field differences wrap around in 32 bits. The columns keep their width, the small differences pay off once the body
+    // is compressed for the wire.
+    class SampleColumns
+    {
+    public:
+        enum Flags
+        {
+            NoFlags = 0x0,
+            DeltaEncoded = 0x1
+        };
+
+        static const int HeaderSize = 24;
+        static const uint8_t FormatVersion = 1;
+
+        static int encodedSize(int count)
+        {
+            return HeaderSize + count * (8 + 4 + 2 + 1);
+        }
+
+        static QByteArray encode(const EbDevice::Sample* samples, int count, quint64 cursor, int flags = NoFlags);
+
+        // Returns false if the data is not a complete encoded block.
+        static bool decode(const QByteArray& data, QVector<EbDevice::Sample>& samples, quint64& cursor);
+    };
+}
@@ -0,0 +1,212 @@
+#include "SampleHistoryStore.h"
+#include <algorithm>
+
+namespace
+{
+    const uint64_t TimeChangedFlag = 0x1;
+    const uint64_t QualityChangedFlag = 0x2;
+
+    uint64_t zigzag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    void writeVarint(uint8_t* data, size_t& size, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data[size++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        data[size++] = static_cast<uint8_t>(value);
+    }
+
+    uint64_t readVarint(const uint8_t*& data)
+    {
+        uint64_t value = 0;
+        int shift = 0;
+        while (*data & 0x80)
+        {
+            value |= static_cast<uint64_t>(*data++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= static_cast<uint64_t>(*data++) << shift;
+        return value;
+    }
+}
+
+core::SampleHistoryStore::Block::Block()
+: minTimeMs(INT64_MAX), maxTimeMs(INT64_MIN), count(0), lastTimeMs(0), lastDeltaMs(0), size(0)
+{
+    last.timeMs = 0;
+    last.field = 0;
+    last.qmc = 0;
+    last.state = 0;
+}
+
+core::SampleHistoryStore::SampleHistoryStore(int retentionDays, size_t maxSizeBytes)
+: _retentionDays(retentionDays), _maxSizeBytes(maxSizeBytes), _open(std::make_shared<Block>()), _sealedCount(0)
+{
+    publish();
+}
+
+core::SampleHistoryStore::~SampleHistoryStore()
+{
+    // the nodes are released one by one, dropping the first one would release the whole list recursively
+    _snapshot.store(std::make_shared<Snapshot>());
+    _lastSealed.reset();
+    while (_firstSealed)
+    {
+        auto next = _firstSealed->next;
+        _firstSealed = next;
+    }
+}
+
+void core::SampleHistoryStore::append(const HistorySample& sample)
+{
+    if (_open->size + MaxSampleSize > BlockSize)
+    {
+        seal();
+    }
+    auto& block = *_open;
+    int64_t delta = sample.timeMs - block.lastTimeMs;
+    int64_t deltaOfDelta = delta - block.lastDeltaMs;
+    bool qualityChanged = sample.qmc != block.last.qmc || sample.state != block.last.state;
+    // the field delta and two flags share the leading varint, a steady sample costs a single varint
+    uint64_t head = zigzag(int64_t(sample.field) - block.last.field) << 2;
+    head |= (deltaOfDelta != 0 ? TimeChangedFlag : 0) | (qualityChanged ? QualityChangedFlag : 0);
+    writeVarint(block.data, block.size, head);
+    if (deltaOfDelta != 0)
+    {
+        writeVarint(block.data, block.size, zigzag(deltaOfDelta));
+    }
+    if (qualityChanged)
+    {
+        writeVarint(block.data, block.size, uint16_t(sample.qmc ^ block.last.qmc));
+        writeVarint(block.data, block.size, uint8_t(sample.state ^ block.last.state));
+    }
+    block.lastDeltaMs = delta;
+    block.lastTimeMs = sample.timeMs;
+    block.last = sample;
+    block.minTimeMs = std::min(block.minTimeMs, sample.timeMs);
+    block.maxTimeMs = std::max(block.maxTimeMs, sample.timeMs);
+    block.count++;
+}
+
+void core::SampleHistoryStore::seal()
+{
+    // the published snapshots hold the previous newest node and stop before its next pointer
+    auto node = std::make_shared<SealedNode>();
+    node->block = BlockView(_open);
+    if (_lastSealed)
+    {
+        _lastSealed->next = node;
+    }
+    else
+    {
+        _firstSealed = node;
+    }
+    _lastSealed = node;
+    _sealedCount++;
+    int64_t oldestMs = _open->maxTimeMs - int64_t(_retentionDays) * 24 * 60 * 60 * 1000;
+    size_t maxSealedCount = _maxSizeBytes / sizeof(Block);
+    while (_sealedCount > 0 && (_firstSealed->block.maxTimeMs < oldestMs || _sealedCount > maxSealedCount))
+    {
+        _firstSealed = _firstSealed->next;
+        _sealedCount--;
+    }
+    if (_sealedCount == 0)
+    {
+        _lastSealed.reset();
+    }
+    _open = std::make_shared<Block>();
+}
+
+void core::SampleHistoryStore::publish()
+{
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->firstSealed = _firstSealed;
+    snapshot->sealedCount = _sealedCount;
+    snapshot->open = BlockView(_open);
+    _snapshot.store(snapshot);
+}
+
+void core::SampleHistoryStore::decode(const BlockView& view, int64_t fromMs, int64_t toMs, const std::function<void(const HistorySample&)>& consumer)
+{
+    if (view.count == 0 || view.maxTimeMs < fromMs || view.minTimeMs > toMs)
+    {
+        return;
+    }
+    const uint8_t* data = view.block->data;
+    HistorySample sample = { 0, 0, 0, 0 };
+    int64_t delta = 0;
+    for (size_t i = 0; i < view.count; i++)
+    {
+        uint64_t head = readVarint(data);
+        if (head & TimeChangedFlag)
+        {
+            delta += unzigzag(readVarint(data));
+        }
+        sample.timeMs += delta;
+        sample.field = static_cast<int32_t>(sample.field + unzigzag(head >> 2));
+        if (head & QualityChangedFlag)
+        {
+            sample.qmc ^= static_cast<uint16_t>(readVarint(data));
+            sample.state ^= static_cast<uint8_t>(readVarint(data));
+        }
+        if (sample.timeMs >= fromMs && sample.timeMs <= toMs)
+        {
+            consumer(sample);
+        }
+    }
+}
+
+void core::SampleHistoryStore::scan(int64_t fromMs, int64_t toMs, const std::function<void(const HistorySample&)>& consumer) const
+{
+    auto snapshot = _snapshot.load();
+    forEachSealed(*snapshot, [&](const BlockView& view)
+    {
+        decode(view, fromMs, toMs, consumer);
+    });
+    decode(snapshot->open, fromMs, toMs, consumer);
+}
+
+void core::SampleHistoryStore::forEachSealed(const Snapshot& snapshot, const std::function<void(const BlockView&)>& consumer)
+{
+    auto node = snapshot.firstSealed.get();
+    for (size_t remaining = snapshot.sealedCount; remaining > 0; remaining--)
+    {
+        consumer(node->block);
+        // the next pointer of the newest node of the snapshot may be being set by the runner
+        if (remaining > 1)
+        {
+            node = node->next.get();
+        }
+    }
+}
+
+core::SampleHistoryStore::Stats core::SampleHistoryStore::stats() const
+{
+    auto snapshot = _snapshot.load();
+    Stats stats = { 0, 0, 0, INT64_MAX, INT64_MIN };
+    auto add = [&stats](const BlockView& view)
+    {
+        if (view.count == 0)
+        {
+            return;
+        }
+        stats.blocksCount++;
+        stats.samplesCount += view.count;
+        stats.sizeBytes += view.size;
+        stats.firstTimeMs = std::min(stats.firstTimeMs, view.minTimeMs);
+        stats.lastTimeMs = std::max(stats.lastTimeMs, view.maxTimeMs);
+    };
+    forEachSealed(*snapshot, add);
+    add(snapshot->open);
+    return stats;
+}
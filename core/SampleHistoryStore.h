@@ -0,0 +1,151 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SampleHistoryStore.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/AtomicSnapshot.h>
+#include <common/SmartPtr.h>
+#include <cstdint>
+#include <functional>
+
+namespace core
+{
+    struct HistorySample
+    {
+        int64_t timeMs;
+        int32_t field;
+        uint16_t qmc;
+        uint8_t state;
+    };
+
+    // Compressed raw samples of the last days in memory.
+    // Samples are packed into blocks of at most BlockSize bytes as varints:
+    //   head  - zigzag delta of the field to the previous value, shifted left by two flag bits;
+    //   time  - zigzag delta-of-delta, only if the 'time changed' flag is set (omitted for a steady sampling interval);
+    //   qmc, state - XOR with the previous values, only if the 'quality changed' flag is set.
+    // A regular sample with a small field change takes one or two bytes.
+    // Full blocks are sealed and never change. The runner appends and publishes, any thread can scan the published
+    // blocks without locks; blocks older than the retention period, or the oldest ones beyond the size limit,
+    // are dropped when a new block is sealed.
+    // Publishing copies no data: the sealed blocks form a list shared by every snapshot, and the open block is
+    // only appended to, so a snapshot just remembers how much of it has been written.
+    class SampleHistoryStore
+    {
+    public:
+        SMART_PTR_T(SampleHistoryStore);
+
+        static const int DefaultRetentionDays = 7;
+        static const size_t DefaultMaxSizeBytes = 256 * 1024 * 1024;
+        static const size_t BlockSize = 4096;
+
+        explicit SampleHistoryStore(int retentionDays = DefaultRetentionDays, size_t maxSizeBytes = DefaultMaxSizeBytes);
+        ~SampleHistoryStore();
+
+        int retentionDays() const { return _retentionDays; }
+        // Runner thread only, before the samples are appended.
+        void retentionDays(int retentionDays) { _retentionDays = retentionDays; }
+        // Memory of the sealed blocks, a fast source reaches it long before the retention period.
+        size_t maxSizeBytes() const { return _maxSizeBytes; }
+        // Runner thread only, before the samples are appended.
+        void maxSizeBytes(size_t maxSizeBytes) { _maxSizeBytes = maxSizeBytes; }
+
+        // Runner thread only. The samples become visible for scan() after publish().
+        void append(const HistorySample& sample);
+        void publish();
+
+        // Calls consumer for the published samples with time within [fromMs, toMs], in the order of appending.
+        void scan(int64_t fromMs, int64_t toMs, const std::function<void(const HistorySample&)>& consumer) const;
+
+        struct Stats
+        {
+            size_t blocksCount;
+            size_t samplesCount;
+            size_t sizeBytes;
+            int64_t firstTimeMs;
+            int64_t lastTimeMs;
+        };
+
+        // Of the published data; firstTimeMs and lastTimeMs are meaningless if samplesCount == 0.
+        Stats stats() const;
+    private:
+        struct Block
+        {
+            SMART_PTR_T(Block);
+
+            Block();
+
+            int64_t minTimeMs;
+            int64_t maxTimeMs;
+            size_t count;
+            // encoder state
+            int64_t lastTimeMs;
+            int64_t lastDeltaMs;
+            HistorySample last;
+            size_t size;
+            // the bytes before size never change
+            uint8_t data[BlockSize];
+        };
+
+        // What the readers see of a block, the block itself may have grown since.
+        struct BlockView
+        {
+            BlockView() : minTimeMs(0), maxTimeMs(0), count(0), size(0)
+            {
+            }
+
+            explicit BlockView(const Block::SharedPtr_t& block)
+            : block(block), minTimeMs(block->minTimeMs), maxTimeMs(block->maxTimeMs), count(block->count), size(block->size)
+            {
+            }
+
+            std::shared_ptr<const Block> block;
+            int64_t minTimeMs;
+            int64_t maxTimeMs;
+            size_t count;
+            size_t size;
+        };
+
+        // Sealed blocks from the oldest one. A node is never changed once published, except for the next pointer
+        // of the newest node, which the snapshots holding it do not follow.
+        struct SealedNode
+        {
+            SMART_PTR_T(SealedNode);
+
+            BlockView block;
+            SharedPtr_t next;
+        };
+
+        struct Snapshot
+        {
+            Snapshot() : sealedCount(0)
+            {
+            }
+
+            SealedNode::SharedPtr_t firstSealed;
+            size_t sealedCount;
+            BlockView open;
+        };
+
+        static void decode(const BlockView& view, int64_t fromMs, int64_t toMs, const std::function<void(const HistorySample&)>& consumer);
+        static void forEachSealed(const Snapshot& snapshot, const std::function<void(const BlockView&)>& consumer);
+        void seal();
+
+        // Maximum encoded size of a sample
+        static const size_t MaxSampleSize = 6 + 10 + 3 + 2;
+
+        int _retentionDays;
+        size_t _maxSizeBytes;
+        // Runner thread only
+        Block::SharedPtr_t _open;
+        SealedNode::SharedPtr_t _firstSealed;
+        SealedNode::SharedPtr_t _lastSealed;
+        size_t _sealedCount;
+        common::AtomicSnapshot<Snapshot> _snapshot;
+    };
+}
@@ -0,0 +1,126 @@
+#include "StaticFilesActionHandler.h"
+#include <mongoose.h>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+core::StaticFilesActionHandler::StaticFilesActionHandler(const QString& rootPath, int maxAgeSeconds)
+: _rootPath(QFileInfo(rootPath).canonicalFilePath()), _cacheSize(0)
+{
+    _cacheControl = "public, max-age=" + QByteArray::number(maxAgeSeconds);
+}
+
+bool core::StaticFilesActionHandler::match()
+{
+    /*
+    GET <any path outside api/ and ws/>, / is index.html
+    */
+    static const QRegularExpression serverUrls("^/(api|ws)/");
+    return methodMatch("GET") && !regexMatch(serverUrls);
+}
+
+QString core::StaticFilesActionHandler::resolve(const QString& uri) const
+{
+    if (_rootPath.isEmpty())
+    {
+        return QString();
+    }
+    QString relativePath = uri;
+    if (relativePath.endsWith('/'))
+    {
+        relativePath += "index.html";
+    }
+    QFileInfo info(_rootPath + relativePath);
+    if (!info.isFile())
+    {
+        return QString();
+    }
+    // also rejects '..' and symbolic links leading out of the root
+    auto path = info.canonicalFilePath();
+    return path.startsWith(_rootPath + '/') ? path : QString();
+}
+
+void core::StaticFilesActionHandler::sendNotFound()
+{
+    response().status(404);
+    response().header("Content-Type", "text/plain");
+    response().end("Not Found");
+}
+
+void core::StaticFilesActionHandler::execute()
+{
+    auto path = resolve(QString::fromUtf8(request().uri()));
+    if (path.isEmpty())
+    {
+        sendNotFound();
+        return;
+    }
+
+    QFileInfo info(path);
+    qint64 size = info.size();
+    qint64 modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    auto etag = "\"" + QByteArray::number(size, 16) + "-" + QByteArray::number(modifiedMs, 16) + "\"";
+    // index.html is always revalidated, so that an update of the dashboard is picked up
+    QByteArray cacheControl = info.fileName() == "index.html" ? QByteArray("no-cache") : _cacheControl;
+    auto nativePath = QFile::encodeName(path);
+    QByteArray contentType = mg_get_mime_type(nativePath.constData(), "application/octet-stream");
+
+    if (size > MaxCachedFileSize)
+    {
+        if (sendNotModified(etag))
+        {
+            return;
+        }
+        int fileDescriptor = open(nativePath.constData(), O_RDONLY | O_BINARY);
+        if (fileDescriptor < 0)
+        {
+            sendNotFound();
+            return;
+        }
+        response().header("Content-Type", contentType);
+        response().header("Cache-Control", cacheControl);
+        response().header("ETag", etag);
+        response().sendFile(fileDescriptor, size);
+        return;
+    }
+
+    CachedResponse::SharedPtr_t cached;
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        auto it = _cache.find(path);
+        if (it != _cache.end() && it->size == size && it->modifiedMs == modifiedMs)
+        {
+            cached = it->response;
+        }
+    }
+    if (!cached)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            sendNotFound();
+            return;
+        }
+        cached = std::make_shared<CachedResponse>(contentType, file.readAll(), etag, cacheControl);
+
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        auto it = _cache.find(path);
+        if (it != _cache.end())
+        {
+            _cacheSize -= it->size;
+            _cache.erase(it);
+        }
+        if (_cacheSize + size <= MaxCacheSize)
+        {
+            CacheEntry entry = { size, modifiedMs, cached };
+            _cache.insert(path, entry);
+            _cacheSize += size;
+        }
+    }
+    sendResponse(*cached);
+}
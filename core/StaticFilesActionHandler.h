@@ -0,0 +1,56 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   StaticFilesActionHandler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "WebServer.h"
+#include <mutex>
+
+namespace core
+{
+    // Serves the built dashboard (web/public) for every GET request outside api/ and ws/, so no Node process is needed.
+    // Small files are kept in memory together with their compressed variants and revalidated against the file time
+    // and size on every request; larger ones are sent from disk (with sendfile() where available).
+    // Everything except index.html may be cached by the browser for maxAgeSeconds.
+    class StaticFilesActionHandler : public core::WebServerActionHandler
+    {
+    public:
+        SMART_PTR_T(StaticFilesActionHandler);
+
+        static const int MaxCachedFileSize = 512 * 1024;
+        static const int MaxCacheSize = 32 * 1024 * 1024;
+
+        StaticFilesActionHandler(const QString& rootPath, int maxAgeSeconds);
+
+        QString name() const override
+        {
+            return "StaticFilesActionHandler";
+        }
+
+        bool match() override;
+        void execute() override;
+    private:
+        // Canonical path of the file under the root the uri refers to, empty if there is none.
+        QString resolve(const QString& uri) const;
+        void sendNotFound();
+
+        struct CacheEntry
+        {
+            qint64 size;
+            qint64 modifiedMs;
+            CachedResponse::SharedPtr_t response;
+        };
+
+        QString _rootPath;
+        QByteArray _cacheControl;
+        std::mutex _cacheMutex;
+        QHash<QString, CacheEntry> _cache;
+        qint64 _cacheSize;
+    };
+}
@@ -0,0 +1,257 @@
+#include "SyntheticDevice.h"
+#include <common/InvalidOperationException.h>
+#include <common/Logger.h>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+    // batches of the samples are handed out no more often
+    const int DeliveryIntervalMs = 10;
+    // GSM-19 tuning window around the range center
+    const int32_t RangeHalfWidth = 5000000;
+
+    const core::IDevice::SampleState ErrorStates[] =
+    {
+        core::IDevice::NUMERR, core::IDevice::TIMERR, core::IDevice::NOISEERR,
+        core::IDevice::OUTERR, core::IDevice::FAILED, core::IDevice::PWERR
+    };
+}
+
+core::SyntheticDevice::SyntheticDevice(const SyntheticDeviceSettings& settings) :
+    _settings(settings),
+    _random(settings.seed),
+    _normal(0, 1),
+    _uniform(0, 1),
+    _standBy(false),
+    _clockOffsetMs(0),
+    _isRunning(false),
+    _samplingRateHz(0),
+    _autoStartedEpochMs(0),
+    _nextIndex(0),
+    _gapEndIndex(0)
+{
+    if (settings.rateHz != 0 && (settings.rateHz < 1 || settings.rateHz > MaxRateHz))
+    {
+        throw common::InvalidOperationException(QString("Synthetic device rate must be 0 or in [1, %1] Hz, got %2.").arg(MaxRateHz).arg(settings.rateHz));
+    }
+    if (settings.invalidShare < 0 || settings.invalidShare > 1 || settings.gapsPerHour < 0 || settings.gapSeconds < 0 || settings.noise < 0)
+    {
+        throw common::InvalidOperationException("Synthetic device noise, invalid share and gaps must not be negative, the share must not exceed 1.");
+    }
+    if (settings.periodSeconds <= 0)
+    {
+        throw common::InvalidOperationException(QString("Synthetic device period must be positive, got %1 s.").arg(settings.periodSeconds));
+    }
+    _range.minField = settings.field - RangeHalfWidth;
+    _range.maxField = settings.field + RangeHalfWidth;
+}
+
+void core::SyntheticDevice::connect(QString portName)
+{
+    LOG_DEBUG(QString("Synthetic device is used, port %1 is not opened.").arg(portName));
+}
+
+void core::SyntheticDevice::sendEnq()
+{
+    _isRunning = false;
+}
+
+void core::SyntheticDevice::sendAbout()
+{
+}
+
+void core::SyntheticDevice::sendStandBy(bool enabled)
+{
+    _standBy = enabled;
+}
+
+void core::SyntheticDevice::sendGetTime()
+{
+}
+
+void core::SyntheticDevice::sendSetTime(QDateTime dateTime)
+{
+    _clockOffsetMs = dateTime.toMSecsSinceEpoch() - QDateTime::currentMSecsSinceEpoch();
+}
+
+void core::SyntheticDevice::sendGetRange()
+{
+}
+
+void core::SyntheticDevice::sendSetRange(uint32_t center)
+{
+    _range.minField = static_cast<int32_t>(center) - RangeHalfWidth;
+    _range.maxField = static_cast<int32_t>(center) + RangeHalfWidth;
+}
+
+void core::SyntheticDevice::sendAuto(int32_t freq)
+{
+    if (_settings.rateHz > 0)
+    {
+        _samplingRateHz = _settings.rateHz;
+    }
+    else if (freq != 0)
+    {
+        _samplingRateHz = freq < 0 ? -freq : 1.0 / freq;
+    }
+    else
+    {
+        throw common::InvalidOperationException("Auto mode frequency must not be 0.");
+    }
+    _isRunning = true;
+    _autoStarted = Clock::now();
+    _autoStartedEpochMs = QDateTime::currentMSecsSinceEpoch() + _clockOffsetMs;
+    _nextIndex = 0;
+    _gapEndIndex = 0;
+    _lastDelivery = _autoStarted;
+    LOG_DEBUG(QString("Synthetic device is sampling at %1 Hz.").arg(_samplingRateHz));
+}
+
+QString core::SyntheticDevice::readEnq()
+{
+    return "GSM-19 synthetic";
+}
+
+QString core::SyntheticDevice::readAbout()
+{
+    return QString("Synthetic GSM-19 source, seed %1").arg(_settings.seed);
+}
+
+bool core::SyntheticDevice::readStandBy()
+{
+    return _standBy;
+}
+
+QDateTime core::SyntheticDevice::readGetTime()
+{
+    return QDateTime::fromMSecsSinceEpoch(QDateTime::currentMSecsSinceEpoch() + _clockOffsetMs, Qt::UTC);
+}
+
+void core::SyntheticDevice::readSetTime()
+{
+}
+
+core::IDevice::RangeData core::SyntheticDevice::readGetRange()
+{
+    return _range;
+}
+
+core::IDevice::RangeData core::SyntheticDevice::readSetRange()
+{
+    return _range;
+}
+
+QList<core::IDevice::Sample> core::SyntheticDevice::readAvailableSamples()
+{
+    return readSamplesDue(Clock::now());
+}
+
+QList<core::IDevice::Sample> core::SyntheticDevice::readSamplesDue(Clock::time_point now)
+{
+    QList<Sample> result;
+    if (!_isRunning || now < _autoStarted)
+    {
+        return result;
+    }
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - _autoStarted).count();
+    quint64 dueCount = static_cast<quint64>(elapsedUs * _samplingRateHz / 1e6) + 1;
+    quint64 endIndex = qMin(dueCount, _nextIndex + MaxSamplesPerRead);
+    double gapChance = _settings.gapsPerHour / (3600 * _samplingRateHz);
+    quint64 gapSamples = qMax<quint64>(1, static_cast<quint64>(_settings.gapSeconds * _samplingRateHz + 0.5));
+    for (; _nextIndex < endIndex; _nextIndex++)
+    {
+        if (_nextIndex < _gapEndIndex)
+        {
+            continue;
+        }
+        if (gapChance > 0 && _uniform(_random) < gapChance)
+        {
+            _gapEndIndex = _nextIndex + gapSamples;
+            continue;
+        }
+        result.push_back(generateSample(_nextIndex));
+    }
+    _lastDelivery = now;
+    return result;
+}
+
+core::IDevice::Sample core::SyntheticDevice::generateSample(quint64 index)
+{
+    double seconds = index / _samplingRateHz;
+    Sample sample;
+    sample.time = QDateTime::fromMSecsSinceEpoch(_autoStartedEpochMs + static_cast<qint64>(seconds * 1000), Qt::UTC);
+    double variation = _settings.amplitude * std::sin(2 * Pi * seconds / _settings.periodSeconds);
+    double noise = _settings.noise * _normal(_random);
+    sample.field = static_cast<int32_t>(std::lround(_settings.field + variation + noise));
+    // the GSM-19 reports its quality estimate around the noise level
+    sample.qmc = static_cast<uint16_t>(qBound(0.0, _settings.noise + std::fabs(noise) / 4, 65535.0));
+    sample.state = Valid;
+    if (_settings.invalidShare > 0 && _uniform(_random) < _settings.invalidShare)
+    {
+        sample.state = ErrorStates[_random() % (sizeof(ErrorStates) / sizeof(ErrorStates[0]))];
+        if (sample.state == FAILED || sample.state == PWERR)
+        {
+            // the measurement has not been made
+            sample.field = 0;
+        }
+    }
+    return sample;
+}
+
+bool core::SyntheticDevice::validateSample(const Sample& sample)
+{
+    return sample.state == Valid;
+}
+
+void core::SyntheticDevice::runDiagnosticSequence()
+{
+    LOG_DEBUG("Synthetic device has nothing to diagnose.");
+}
+
+void core::SyntheticDevice::runTestAutoSequence()
+{
+    LOG_DEBUG("Synthetic device has nothing to test.");
+}
+
+void core::SyntheticDevice::waitForInputSilence(int maxWaitCicles, int readTimeout)
+{
+    // a stopped stream has nothing in flight
+    _isRunning = false;
+}
+
+QSerialPort::Handle core::SyntheticDevice::nativeHandle() const
+{
+#ifdef Q_OS_WIN
+    return INVALID_HANDLE_VALUE;
+#else
+    return -1;
+#endif
+}
+
+core::SyntheticDevice::Clock::time_point core::SyntheticDevice::dueTime(quint64 index) const
+{
+    return _autoStarted + std::chrono::microseconds(static_cast<qint64>(index * 1e6 / _samplingRateHz));
+}
+
+core::SyntheticDevice::Clock::time_point core::SyntheticDevice::nextDeliveryTime() const
+{
+    return qMax(dueTime(_nextIndex), _lastDelivery + std::chrono::milliseconds(DeliveryIntervalMs));
+}
+
+bool core::SyntheticDevice::hasPendingInput() const
+{
+    return _isRunning && Clock::now() >= nextDeliveryTime();
+}
+
+bool core::SyntheticDevice::waitForInput(int timeoutMs)
+{
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    if (_isRunning)
+    {
+        deadline = qMin(deadline, nextDeliveryTime());
+    }
+    std::this_thread::sleep_until(deadline);
+    return hasPendingInput();
+}
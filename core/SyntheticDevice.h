@@ -0,0 +1,123 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   SyntheticDevice.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "IDevice.h"
+#include <chrono>
+#include <random>
+
+namespace core
+{
+    struct SyntheticDeviceSettings
+    {
+        SyntheticDeviceSettings()
+        {
+            rateHz = 0;
+            field = 50000000;
+            amplitude = 20000;
+            periodSeconds = 600;
+            noise = 100;
+            invalidShare = 0.01;
+            gapsPerHour = 0;
+            gapSeconds = 5;
+            seed = 1;
+        }
+
+        // Samples per second in [1, 10000], 0 samples at the rate of the run command like the GSM-19.
+        double rateHz;
+        // Mean field, the amplitude of its sine variation and the standard deviation of the white noise (pT).
+        int32_t field;
+        int32_t amplitude;
+        double periodSeconds;
+        int32_t noise;
+        // Share of the samples with error state bits.
+        double invalidShare;
+        // Mean count of the drop-outs per hour and their length, the samples of a gap are never delivered.
+        double gapsPerHour;
+        double gapSeconds;
+        quint32 seed;
+    };
+
+    // In-process sample source for load testing the pipeline beyond the 5 Hz of the GSM-19. Samples are
+    // generated as their time passes and handed out in batches at most every 10 ms, like a serial port buffers
+    // its input. There is no descriptor to poll, the Runner waits with waitForInput().
+    // Sample times have millisecond resolution, so above 1 kHz neighbour samples may share the time.
+    class SyntheticDevice : public IDevice
+    {
+    public:
+        SMART_PTR_T(SyntheticDevice);
+
+        static const int MaxRateHz = 10000;
+        // a stalled reader gets the backlog over several calls
+        static const int MaxSamplesPerRead = 65536;
+
+        // Throws InvalidOperationException if the settings are out of range.
+        explicit SyntheticDevice(const SyntheticDeviceSettings& settings);
+
+        void connect(QString portName) override;
+
+        void sendEnq() override;
+        void sendAbout() override;
+        void sendStandBy(bool enabled) override;
+        void sendGetTime() override;
+        void sendSetTime(QDateTime dateTime /* use UTC */) override;
+        void sendGetRange() override;
+        void sendSetRange(uint32_t center) override;
+        void sendAuto(int32_t freq /* -X Hz || 1/X mes/sec, X = [-5,-1]|[1,86400] */) override;
+
+        QString readEnq() override;
+        QString readAbout() override;
+        bool readStandBy() override;
+        QDateTime readGetTime() override;
+        void readSetTime() override;
+        RangeData readGetRange() override;
+        RangeData readSetRange() override;
+        QList<Sample> readAvailableSamples() override;
+        bool validateSample(const Sample& sample) override;
+        double samplingRateHz() const override { return _samplingRateHz; }
+
+        void runDiagnosticSequence() override;
+        void runTestAutoSequence() override;
+
+        void waitForInputSilence(int maxWaitCicles = 10, int readTimeout = 1000) override;
+
+        QSerialPort::Handle nativeHandle() const override;
+        bool hasPendingInput() const override;
+        bool waitForInput(int timeoutMs) override;
+
+        // The samples due at now (readAvailableSamples() passes the current time).
+        QList<Sample> readSamplesDue(std::chrono::steady_clock::time_point now);
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Sample generateSample(quint64 index);
+        // When the sample is due, counted from the start of the auto mode.
+        Clock::time_point dueTime(quint64 index) const;
+        // When the next batch may be delivered.
+        Clock::time_point nextDeliveryTime() const;
+
+        SyntheticDeviceSettings _settings;
+        std::mt19937 _random;
+        std::normal_distribution<double> _normal;
+        std::uniform_real_distribution<double> _uniform;
+        bool _standBy;
+        RangeData _range;
+        qint64 _clockOffsetMs;
+
+        bool _isRunning;
+        double _samplingRateHz;
+        Clock::time_point _autoStarted;
+        qint64 _autoStartedEpochMs;
+        quint64 _nextIndex;
+        // samples before it belong to the current gap
+        quint64 _gapEndIndex;
+        Clock::time_point _lastDelivery;
+    };
+}
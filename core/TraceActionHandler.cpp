@@ -0,0 +1,14 @@
+#include "TraceActionHandler.h"
+#include <common/Tracer.h>
+
+void core::TraceActionHandler::registerRoutes(WebRouter& router)
+{
+    router.add("GET", "api/trace", this, [this]() { executeTrace(); });
+}
+
+void core::TraceActionHandler::executeTrace()
+{
+    auto& buffer = responseBuffer();
+    sTracer.writeChromeTrace(buffer);
+    sendResponse(CachedResponse("application/json", buffer));
+}
@@ -0,0 +1,32 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   TraceActionHandler.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include "WebServer.h"
+
+namespace core
+{
+    // api/trace: the recent spans of every thread (common::Tracer) as Chrome trace-event JSON,
+    // to be opened in chrome://tracing or Perfetto. Registered only in builds with GEM_ENABLE_TRACING.
+    class TraceActionHandler : public core::WebServerActionHandler
+    {
+    public:
+        SMART_PTR_T(TraceActionHandler);
+
+        QString name() const override
+        {
+            return "TraceActionHandler";
+        }
+
+        void registerRoutes(WebRouter& router) override;
+    private:
+        void executeTrace();
+    };
+}
@@ -0,0 +1,70 @@
+#include "WebRequest.h"
+#include <cstring>
+
+core::WebRequest::WebRequest(const mg_connection* connection, const char* uri)
+: _content(connection->content, int(connection->content_len))
+{
+    // every string is copied with its terminating zero, the pointers are fixed up once the buffer is complete
+    QVector<int> offsets;
+    auto copy = [this, &offsets](const char* value)
+    {
+        if (value == nullptr)
+        {
+            offsets.push_back(-1);
+            return;
+        }
+        offsets.push_back(_strings.size());
+        _strings.append(value, int(std::strlen(value)) + 1);
+    };
+    copy(connection->request_method);
+    copy(uri != nullptr ? uri : connection->uri);
+    copy(connection->http_version);
+    copy(connection->query_string);
+    for (int i = 0; i < connection->num_headers; i++)
+    {
+        copy(connection->http_headers[i].name);
+        copy(connection->http_headers[i].value);
+    }
+
+    std::memset(&_connection, 0, sizeof(_connection));
+    auto at = [this, &offsets](int index) -> const char*
+    {
+        return offsets[index] < 0 ? nullptr : _strings.constData() + offsets[index];
+    };
+    _connection.request_method = at(0);
+    _connection.uri = at(1);
+    _connection.http_version = at(2);
+    _connection.query_string = at(3);
+    _connection.num_headers = connection->num_headers;
+    for (int i = 0; i < connection->num_headers; i++)
+    {
+        _connection.http_headers[i].name = at(4 + 2 * i);
+        _connection.http_headers[i].value = at(5 + 2 * i);
+    }
+    std::memcpy(_connection.remote_ip, connection->remote_ip, sizeof(_connection.remote_ip));
+    std::memcpy(_connection.local_ip, connection->local_ip, sizeof(_connection.local_ip));
+    _connection.remote_port = connection->remote_port;
+    _connection.local_port = connection->local_port;
+    _connection.content = const_cast<char*>(_content.constData());
+    _connection.content_len = _content.size();
+    _connection.is_websocket = connection->is_websocket;
+    _connection.wsbits = connection->wsbits;
+    _connection.server_param = connection->server_param;
+}
+
+const char* core::WebRequest::header(const char* name) const
+{
+    return mg_get_header(&_connection, name);
+}
+
+QByteArray core::WebRequest::routeParameter(const char* name) const
+{
+    for (auto& parameter : _routeParameters)
+    {
+        if (parameter.first == name)
+        {
+            return parameter.second;
+        }
+    }
+    return QByteArray();
+}
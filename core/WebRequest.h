@@ -0,0 +1,53 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   WebRequest.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SmartPtr.h>
+#include <QtCore>
+#include <boost/utility.hpp>
+#include <mongoose.h>
+
+namespace core
+{
+    // Copy of a parsed HTTP request that stays valid after the server thread has moved on with the connection,
+    // so a handler can run on a worker thread. connection() is a detached mg_connection pointing into the copy:
+    // it can be passed to the mongoose functions that only read the request (mg_get_header, mg_get_var),
+    // never to the ones that write a response.
+    class WebRequest : boost::noncopyable
+    {
+    public:
+        SMART_PTR_T(WebRequest);
+
+        // uri replaces the request uri if given.
+        explicit WebRequest(const mg_connection* connection, const char* uri = nullptr);
+
+        const char* method() const { return _connection.request_method; }
+        // URL-decoded, starts with '/'
+        const char* uri() const { return _connection.uri; }
+        const char* httpVersion() const { return _connection.http_version; }
+        // nullptr if the request has no query string
+        const char* queryString() const { return _connection.query_string; }
+        const char* remoteIp() const { return _connection.remote_ip; }
+        // nullptr if the header is absent
+        const char* header(const char* name) const;
+        const QByteArray& content() const { return _content; }
+
+        // Value of a parameter of the matched route pattern, null if the pattern has no such parameter.
+        QByteArray routeParameter(const char* name) const;
+        void routeParameters(const QVector<QPair<QByteArray, QByteArray>>& parameters) { _routeParameters = parameters; }
+
+        const mg_connection* connection() const { return &_connection; }
+    private:
+        QByteArray _strings;
+        QByteArray _content;
+        QVector<QPair<QByteArray, QByteArray>> _routeParameters;
+        mg_connection _connection;
+    };
+}
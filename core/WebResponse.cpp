@@ -0,0 +1,259 @@
+#include "WebResponse.h"
+
+#include <mongoose.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+core::WebResponse::WebResponse(bool chunkedAllowed, std::function<void()> dataReady)
+: _dataReady(dataReady), _chunkedAllowed(chunkedAllowed), _status(200), _headersSent(false),
+  _finished(false), _failed(false), _cancelled(false), _readySignalled(false), _fileDescriptor(-1), _fileSize(0),
+  _fileHandedOver(false)
+{
+}
+
+core::WebResponse::~WebResponse()
+{
+    closeFile();
+}
+
+void core::WebResponse::closeFile()
+{
+    if (_fileDescriptor >= 0)
+    {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+}
+
+void core::WebResponse::status(int code)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _status = code;
+}
+
+void core::WebResponse::header(const QByteArray& name, const QByteArray& value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _headers.append(name).append(": ").append(value).append("\r\n");
+}
+
+void core::WebResponse::write(const char* data, int size)
+{
+    bool signal = false;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_cancelled || _finished)
+        {
+            return;
+        }
+        _pending.append(data, size);
+        if (_chunkedAllowed && _pending.size() >= StreamThreshold && !_readySignalled)
+        {
+            _readySignalled = true;
+            signal = true;
+        }
+    }
+    if (signal)
+    {
+        _dataReady();
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    _drained.wait(lock, [this]()
+    {
+        return _cancelled || !_chunkedAllowed || _pending.size() < MaxPendingBytes;
+    });
+}
+
+void core::WebResponse::end(const QByteArray& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_cancelled || _finished)
+        {
+            return;
+        }
+        _pending.append(data);
+        _finished = true;
+    }
+    _dataReady();
+}
+
+void core::WebResponse::sendFile(int fileDescriptor, qint64 size)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_cancelled || _finished)
+        {
+            close(fileDescriptor);
+            return;
+        }
+        _pending.clear();
+        _fileDescriptor = fileDescriptor;
+        _fileSize = size;
+        _finished = true;
+    }
+    _dataReady();
+}
+
+void core::WebResponse::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+    }
+    _dataReady();
+}
+
+void core::WebResponse::fail()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_headersSent)
+        {
+            _status = 500;
+            _headers.clear();
+            _pending.clear();
+            closeFile();
+        }
+        else
+        {
+            _failed = true;
+        }
+        _finished = true;
+    }
+    _dataReady();
+}
+
+bool core::WebResponse::cancelled() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cancelled;
+}
+
+void core::WebResponse::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cancelled = true;
+        _pending.clear();
+    }
+    _drained.notify_all();
+}
+
+bool core::WebResponse::transfer(mg_connection* connection)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_failed)
+    {
+        // the status line is gone already, the client can only notice the truncated body
+        mg_close_connection(connection);
+        return true;
+    }
+    if (!_headersSent)
+    {
+        if (_finished && _fileDescriptor >= 0)
+        {
+            auto headers = headersBlock(false, _fileSize);
+            mg_write(connection, headers.constData(), headers.size());
+            connection->status_code = _status;
+            _headersSent = true;
+            mg_send_file_range(connection, _fileDescriptor, _fileSize);
+            _fileDescriptor = -1;
+            _fileHandedOver = true;
+            return true;
+        }
+        if (_finished)
+        {
+            auto headers = headersBlock(false, _pending.size());
+            mg_write(connection, headers.constData(), headers.size());
+            mg_write(connection, _pending.constData(), _pending.size());
+            connection->status_code = _status;
+            _headersSent = true;
+            _pending.clear();
+            return true;
+        }
+        if (!_chunkedAllowed || _pending.size() < StreamThreshold)
+        {
+            return false;
+        }
+        auto headers = headersBlock(true, 0);
+        mg_write(connection, headers.constData(), headers.size());
+        connection->status_code = _status;
+        _headersSent = true;
+    }
+
+    // mg_write() with no data returns the amount of data not yet sent to the socket
+    bool drained = false;
+    if (!_pending.isEmpty() && mg_write(connection, "", 0) < MaxPendingBytes)
+    {
+        char size[20];
+        int length = qsnprintf(size, sizeof(size), "%X\r\n", unsigned(_pending.size()));
+        mg_write(connection, size, length);
+        mg_write(connection, _pending.constData(), _pending.size());
+        mg_write(connection, "\r\n", 2);
+        _pending.resize(0);
+        _readySignalled = false;
+        drained = true;
+    }
+    bool complete = _finished && _pending.isEmpty();
+    if (complete)
+    {
+        mg_write(connection, "0\r\n\r\n", 5);
+    }
+    lock.unlock();
+    if (drained)
+    {
+        _drained.notify_all();
+    }
+    return complete;
+}
+
+QByteArray core::WebResponse::headersBlock(bool chunked, qint64 contentLength) const
+{
+    QByteArray headers;
+    headers.reserve(128 + _headers.size());
+    headers.append("HTTP/1.1 ").append(QByteArray::number(_status)).append(' ').append(statusText(_status)).append("\r\n");
+    headers.append(_headers);
+    if (chunked)
+    {
+        headers.append("Transfer-Encoding: chunked\r\n");
+    }
+    else if (_status != 204 && _status != 304)
+    {
+        headers.append("Content-Length: ").append(QByteArray::number(contentLength)).append("\r\n");
+    }
+    headers.append("\r\n");
+    return headers;
+}
+
+const char* core::WebResponse::statusText(int code)
+{
+    switch (code)
+    {
+    case 200:
+        return "OK";
+    case 202:
+        return "Accepted";
+    case 204:
+        return "No Content";
+    case 304:
+        return "Not Modified";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Request Entity Too Large";
+    case 500:
+        return "Internal Server Error";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "Unknown";
+    }
+}
@@ -0,0 +1,87 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   WebResponse.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SmartPtr.h>
+#include <QtCore>
+#include <boost/utility.hpp>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+struct mg_connection;
+
+namespace core
+{
+    // Response produced by a handler on a worker thread and written to the connection by the server thread.
+    // A response that is complete before the server thread picks it up is sent with Content-Length; a longer one
+    // is streamed with chunked encoding as soon as StreamThreshold bytes are pending. The worker blocks in write()
+    // while MaxPendingBytes are waiting for a slow client, so a large export does not end up in memory.
+    class WebResponse : boost::noncopyable
+    {
+    public:
+        SMART_PTR_T(WebResponse);
+
+        static const int StreamThreshold = 64 * 1024;
+        static const int MaxPendingBytes = 256 * 1024;
+
+        // chunkedAllowed is false for HTTP/1.0 clients, then the whole body is buffered.
+        // dataReady is called on the worker thread when the server thread should call transfer() again.
+        WebResponse(bool chunkedAllowed, std::function<void()> dataReady);
+        ~WebResponse();
+
+        // Worker thread. Status and headers are ignored once the first bytes have been sent.
+        void status(int code);
+        void header(const QByteArray& name, const QByteArray& value);
+        void write(const char* data, int size);
+        void write(const QByteArray& data)
+        {
+            write(data.constData(), data.size());
+        }
+        // Writes the rest of the body at once, so that it can be sent with Content-Length. Later writes are ignored.
+        void end(const QByteArray& data);
+        // Sends the file as the body, from the server thread with sendfile() where available. Takes the descriptor over.
+        void sendFile(int fileDescriptor, qint64 size);
+        // No more data, called by the server after the handler has returned.
+        void finish();
+        // Replaces the response with an empty 500 if nothing has been sent yet, otherwise drops the connection.
+        void fail();
+        // True when the client has gone away, further writes are discarded.
+        bool cancelled() const;
+
+        // Server thread. Writes the data produced so far, returns true when the response is complete.
+        bool transfer(mg_connection* connection);
+        // The connection has been closed: wakes a blocked writer and discards everything it writes.
+        void cancel();
+        // The last transfer() has left the file body to mongoose, the request is not complete for it yet.
+        bool fileHandedOver() const { return _fileHandedOver; }
+
+        static const char* statusText(int code);
+    private:
+        QByteArray headersBlock(bool chunked, qint64 contentLength) const;
+        void closeFile();
+
+        mutable std::mutex _mutex;
+        std::condition_variable _drained;
+        std::function<void()> _dataReady;
+        bool _chunkedAllowed;
+        int _status;
+        QByteArray _headers;
+        QByteArray _pending;
+        bool _headersSent;
+        bool _finished;
+        bool _failed;
+        bool _cancelled;
+        bool _readySignalled;
+        int _fileDescriptor;
+        qint64 _fileSize;
+        bool _fileHandedOver;
+    };
+}
@@ -0,0 +1,167 @@
+#include "WebRouter.h"
+#include <common/InvalidOperationException.h>
+#include <cstring>
+
+core::WebRouter::WebRouter()
+{
+    // the root
+    _nodes.push_back(Node());
+}
+
+int core::WebRouter::child(int nodeIndex, int Node::* link, const QByteArray& parameterName, const QByteArray& pattern)
+{
+    int childIndex = _nodes[nodeIndex].*link;
+    if (childIndex >= 0)
+    {
+        if (_nodes[childIndex].parameterName != parameterName)
+        {
+            throw common::InvalidOperationException(QString("Route `%1` names a parameter differently than a route registered before.").arg(QString(pattern)));
+        }
+        return childIndex;
+    }
+    Node node;
+    node.parameterName = parameterName;
+    _nodes.push_back(node);
+    childIndex = int(_nodes.size()) - 1;
+    _nodes[nodeIndex].*link = childIndex;
+    return childIndex;
+}
+
+void core::WebRouter::add(const QByteArray& method, const QByteArray& pattern, WebServerActionHandler* handler, Action action)
+{
+    int nodeIndex = 0;
+    auto segments = pattern.split('/');
+    for (int i = 0; i < segments.size(); i++)
+    {
+        auto& segment = segments[i];
+        if (segment.isEmpty())
+        {
+            continue;
+        }
+        if (!segment.startsWith('{'))
+        {
+            auto literal = _nodes[nodeIndex].literalChildren.constFind(segment);
+            if (literal != _nodes[nodeIndex].literalChildren.constEnd())
+            {
+                nodeIndex = literal.value();
+                continue;
+            }
+            _nodes.push_back(Node());
+            int childIndex = int(_nodes.size()) - 1;
+            _nodes[nodeIndex].literalChildren.insert(segment, childIndex);
+            nodeIndex = childIndex;
+            continue;
+        }
+        if (!segment.endsWith('}') || segment.size() < 3)
+        {
+            throw common::InvalidOperationException(QString("Route `%1` has a malformed parameter.").arg(QString(pattern)));
+        }
+        if (segment.endsWith("*}"))
+        {
+            if (i != segments.size() - 1 || segment.size() < 4)
+            {
+                throw common::InvalidOperationException(QString("Route `%1` has a malformed rest parameter, it must be the last segment.").arg(QString(pattern)));
+            }
+            nodeIndex = child(nodeIndex, &Node::restChild, segment.mid(1, segment.size() - 3), pattern);
+        }
+        else
+        {
+            nodeIndex = child(nodeIndex, &Node::parameterChild, segment.mid(1, segment.size() - 2), pattern);
+        }
+    }
+
+    auto& node = _nodes[nodeIndex];
+    for (auto& route : node.routes)
+    {
+        if (route.first == method)
+        {
+            throw common::InvalidOperationException(QString("Route `%1 %2` is already registered.").arg(QString(method)).arg(QString(pattern)));
+        }
+    }
+    Route route;
+    route.method = method;
+    route.pattern = pattern;
+    route.handler = handler;
+    route.action = action;
+    route.duration = &durationMetric(method + " " + pattern);
+    _routes.push_back(route);
+    node.routes.push_back(qMakePair(method, int(_routes.size()) - 1));
+}
+
+common::MetricHistogram& core::WebRouter::durationMetric(const QByteArray& name)
+{
+    return sMetrics.histogram("gem_http_request_duration_seconds", "Time from accepting an HTTP request until its response is produced.",
+        std::string("route=\"") + name.constData() + "\"");
+}
+
+const core::WebRouter::Route* core::WebRouter::match(const char* method, const char* uri, Parameters& parameters) const
+{
+    return matchNode(0, uri, method, parameters);
+}
+
+const core::WebRouter::Route* core::WebRouter::routeOf(const Node& node, const char* method) const
+{
+    for (auto& route : node.routes)
+    {
+        if (route.first == method)
+        {
+            return &_routes[route.second];
+        }
+    }
+    return nullptr;
+}
+
+const core::WebRouter::Route* core::WebRouter::matchNode(int nodeIndex, const char* path, const char* method, Parameters& parameters) const
+{
+    while (*path == '/')
+    {
+        path++;
+    }
+    const Node& node = _nodes[nodeIndex];
+    if (*path == 0)
+    {
+        return routeOf(node, method);
+    }
+
+    const char* end = std::strchr(path, '/');
+    if (end == nullptr)
+    {
+        end = path + std::strlen(path);
+    }
+    int length = int(end - path);
+
+    // the key only wraps the uri, no copy is made for the lookup
+    auto literal = node.literalChildren.constFind(QByteArray::fromRawData(path, length));
+    if (literal != node.literalChildren.constEnd())
+    {
+        auto route = matchNode(literal.value(), end, method, parameters);
+        if (route != nullptr)
+        {
+            return route;
+        }
+    }
+
+    if (node.parameterChild >= 0)
+    {
+        int mark = parameters.size();
+        parameters.push_back(qMakePair(_nodes[node.parameterChild].parameterName, QByteArray(path, length)));
+        auto route = matchNode(node.parameterChild, end, method, parameters);
+        if (route != nullptr)
+        {
+            return route;
+        }
+        parameters.resize(mark);
+    }
+
+    if (node.restChild >= 0)
+    {
+        const Node& rest = _nodes[node.restChild];
+        auto route = routeOf(rest, method);
+        if (route != nullptr)
+        {
+            parameters.push_back(qMakePair(rest.parameterName, QByteArray(path)));
+            return route;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,82 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   WebRouter.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SmartPtr.h>
+#include <common/Metrics.h>
+#include <QtCore>
+#include <boost/utility.hpp>
+#include <functional>
+#include <vector>
+
+namespace core
+{
+    class WebServerActionHandler;
+
+    // Method + path patterns registered once and compiled into a trie of path segments, so that a request is
+    // dispatched with a single walk over its uri instead of asking every handler.
+    // Pattern segments are literals, "{name}" for any one segment or "{name*}" (last only) for the rest of the path.
+    // Literals win over parameters and parameters over the rest of the path. Empty segments are ignored,
+    // so "/api/status/" is the same path as "api/status".
+    class WebRouter : boost::noncopyable
+    {
+    public:
+        SMART_PTR_T(WebRouter);
+
+        typedef std::function<void()> Action;
+        typedef QVector<QPair<QByteArray, QByteArray>> Parameters;
+
+        struct Route
+        {
+            QByteArray method;
+            QByteArray pattern;
+            WebServerActionHandler* handler;
+            Action action;
+            // labelled with the method and pattern
+            common::MetricHistogram* duration;
+        };
+
+        WebRouter();
+
+        // Not thread-safe, all routes are added before the server starts. Throws InvalidOperationException
+        // for a malformed pattern or if the method and pattern are already registered.
+        void add(const QByteArray& method, const QByteArray& pattern, WebServerActionHandler* handler, Action action);
+
+        // The route of the request or nullptr. Appends the values of the pattern parameters to parameters.
+        const Route* match(const char* method, const char* uri, Parameters& parameters) const;
+
+        int size() const { return int(_routes.size()); }
+
+        // Histogram of the time from accepting a request until its response is produced, labelled route="<name>".
+        static common::MetricHistogram& durationMetric(const QByteArray& name);
+    private:
+        struct Node
+        {
+            Node() : parameterChild(-1), restChild(-1)
+            {
+            }
+
+            QHash<QByteArray, int> literalChildren;
+            int parameterChild;
+            int restChild;
+            // name of the parameter this node matches, if it is a parameter or rest node
+            QByteArray parameterName;
+            // method -> index in _routes
+            QVector<QPair<QByteArray, int>> routes;
+        };
+
+        const Route* matchNode(int nodeIndex, const char* path, const char* method, Parameters& parameters) const;
+        const Route* routeOf(const Node& node, const char* method) const;
+        int child(int nodeIndex, int Node::* link, const QByteArray& parameterName, const QByteArray& pattern);
+
+        std::vector<Node> _nodes;
+        std::vector<Route> _routes;
+    };
+}
@@ -3,77 +3,292 @@
 
 #include <mongoose.h>
 #include <common/Exception.h>
-
-void *serve(void *param) {
-    auto server = static_cast<mg_server*>(param);
-    while (true)
-    {
-        mg_poll_server(server, 1000);
-    }
-}
+#include <common/Tracer.h>
+#include <cstring>
 
 int ev_handler(mg_connection *connection, enum mg_event event) {
-    auto webServerPtr = static_cast<core::WebServer**>(connection->server_param);
-    if (*webServerPtr == nullptr)
+    auto webServer = static_cast<std::atomic<core::WebServer*>*>(connection->server_param)->load();
+    if (webServer == nullptr)
     {
         return MG_FALSE;
     }
 
-    auto webServer = *webServerPtr;
-    auto handlers = webServer->handlers();
+    auto& handlers = webServer->handlers();
     switch (event) {
     case MG_AUTH:
         return MG_TRUE;
-    case MG_REQUEST:
-        sLogger.info(QString("New connection to '%1'.").arg(connection->uri));
-        for (auto& handler : handlers)
+    case MG_WS_CONNECT:
+    case MG_CLOSE:
+        if (event == MG_CLOSE)
         {
-            handler->connection(connection);
-            if (handler->match())
+            webServer->handleClose(connection);
+        }
+        if (connection->is_websocket)
+        {
+            core::WebRequest request(connection);
+            core::WebServerActionHandler::RequestScope scope(request, nullptr);
+            for (auto& handler : handlers)
             {
-                sLogger.info(QString("Found handler '%1' -> '%2'.").arg(connection->uri).arg(handler->name()));
-                try
-                {
-                    handler->execute();
-                }
-                catch (common::Exception& ex)
+                handler->connection(connection);
+                if (handler->match())
                 {
-                    sLogger.error(QString("Handler error (common::Exception): %1").arg(ex.what()));
+                    if (event == MG_WS_CONNECT)
+                    {
+                        sLogger.info(QString("New websocket connection to '%1' -> '%2'.").arg(connection->uri).arg(handler->name()));
+                        handler->websocketConnected();
+                    }
+                    else
+                    {
+                        handler->websocketClosed();
+                    }
+                    break;
                 }
-                catch (std::exception& ex)
+            }
+        }
+        return MG_FALSE;
+    case MG_REQUEST:
+        if (connection->is_websocket)
+        {
+            core::WebRequest request(connection);
+            core::WebServerActionHandler::RequestScope scope(request, nullptr);
+            for (auto& handler : handlers)
+            {
+                handler->connection(connection);
+                if (handler->match())
                 {
-                    sLogger.error(QString("Handler error (std::exception): %1").arg(ex.what()));
+                    return handler->websocketFrame() ? MG_TRUE : MG_FALSE;
                 }
-                return MG_TRUE;
             }
+            return MG_FALSE;
         }
-        sLogger.info(QString("No handlers found for url '%1'.").arg(connection->uri));
-        return MG_FALSE;
+        return webServer->handleRequest(connection);
+    case MG_POLL:
+        return webServer->handleResponse(connection);
     default:
         return MG_FALSE;
     }
 }
 
-core::WebServer::WebServer()
+core::WebServer::WebServer() : _workerThreads(4), _maxConnections(256), _self(this), _server(nullptr), _wakeupPending(false),
+    _stopping(false)
 {
     _port = 8000;
-    _thisRef = new WebServer*;
-    *_thisRef = this;
 }
 
 core::WebServer::~WebServer()
 {
-    *_thisRef = nullptr;
+    _self.store(nullptr);
+    {
+        // workers blocked on a slow client would never return otherwise
+        std::lock_guard<std::mutex> lock(_activeMutex);
+        for (auto response : _activeResponses)
+        {
+            response->cancel();
+        }
+    }
+    // the workers may ask for a wakeup until they are joined, the server is still there for them
+    _workers.reset();
+    _stopping = true;
+    auto server = _server.exchange(nullptr);
+    if (server != nullptr)
+    {
+        mg_wakeup_server_async(server);
+        _thread.join();
+        // closes the connections, their events find _self cleared
+        mg_destroy_server(&server);
+    }
 }
 
 void core::WebServer::addActionHandler(WebServerActionHandler::SharedPtr_t handler)
 {
+    handler->server(this);
+    handler->registerRoutes(_router);
+    _handlerDurations.insert(handler.get(), &WebRouter::durationMetric(handler->name().toLatin1()));
     _handlers.push_back(handler);
 }
 
+void core::WebServer::addUriAlias(const QByteArray& prefix, const QByteArray& replacement)
+{
+    _uriAliases.push_back(qMakePair(prefix, replacement));
+}
+
 void core::WebServer::runAsync()
 {
-    mg_server* server = mg_create_server(_thisRef, ev_handler);
+    mg_server* server = mg_create_server(&_self, ev_handler);
     mg_set_option(server, "listening_port", QString::number(_port).toLatin1().data());
-    mg_start_thread(serve, server);
-}
\ No newline at end of file
+    if (_maxConnections > 0)
+    {
+        mg_set_option(server, "max_connections", QString::number(_maxConnections).toLatin1().data());
+    }
+    _workers = std::make_shared<WebWorkerPool>(qMax(1, _workerThreads));
+    // a thread that sees the server also sees it configured
+    _server.store(server, std::memory_order_release);
+    _thread = std::thread([this, server]() { serve(server); });
+}
+
+void core::WebServer::serve(mg_server* server)
+{
+    TRACE_THREAD_NAME("web server");
+    while (!_stopping.load())
+    {
+        mg_poll_server(server, 1000);
+        if (_self.load() != nullptr)
+        {
+            handlePoll();
+        }
+    }
+}
+
+void core::WebServer::wakeup()
+{
+    auto server = _server.load(std::memory_order_acquire);
+    if (server != nullptr && !_wakeupPending.exchange(true))
+    {
+        mg_wakeup_server_async(server);
+    }
+}
+
+void core::WebServer::handlePoll()
+{
+    // cleared before the handlers run, so that data produced meanwhile requests another wakeup
+    _wakeupPending = false;
+    for (auto& handler : _handlers)
+    {
+        try
+        {
+            handler->poll();
+        }
+        catch (common::Exception& ex)
+        {
+            sLogger.error(QString("Handler poll error (common::Exception): %1").arg(ex.what()));
+        }
+        catch (std::exception& ex)
+        {
+            sLogger.error(QString("Handler poll error (std::exception): %1").arg(ex.what()));
+        }
+    }
+}
+int core::WebServer::handleRequest(mg_connection* connection)
+{
+    if (connection->connection_param != nullptr)
+    {
+        // more data has arrived while the request is being executed
+        return MG_MORE;
+    }
+
+    auto accepted = std::chrono::steady_clock::now();
+    sLogger.info(QString("New connection to '%1'.").arg(connection->uri));
+    QByteArray uri(connection->uri);
+    for (auto& alias : _uriAliases)
+    {
+        if (uri.startsWith(alias.first))
+        {
+            uri = alias.second + uri.mid(alias.first.size());
+            break;
+        }
+    }
+    auto request = std::make_shared<WebRequest>(connection, uri.constData());
+    WebServerActionHandler::SharedPtr_t handler;
+    WebRouter::Parameters parameters;
+    const WebRouter::Route* route = _router.match(request->method(), request->uri(), parameters);
+    if (route != nullptr)
+    {
+        request->routeParameters(parameters);
+        sLogger.info(QString("Found route '%1' -> '%2 %3'.").arg(connection->uri).arg(route->handler->name()).arg(QString(route->pattern)));
+    }
+    else
+    {
+        WebServerActionHandler::RequestScope scope(*request, nullptr);
+        for (auto& candidate : _handlers)
+        {
+            if (candidate->match())
+            {
+                handler = candidate;
+                break;
+            }
+        }
+        if (!handler)
+        {
+            sLogger.info(QString("No handlers found for url '%1'.").arg(connection->uri));
+            return MG_FALSE;
+        }
+        sLogger.info(QString("Found handler '%1' -> '%2'.").arg(connection->uri).arg(handler->name()));
+    }
+
+    auto response = std::make_shared<WebResponse>(std::strcmp(request->httpVersion(), "1.0") != 0, [this]()
+    {
+        wakeup();
+    });
+    {
+        std::lock_guard<std::mutex> lock(_activeMutex);
+        _activeResponses.insert(response.get());
+    }
+    connection->connection_param = new WebResponse::SharedPtr_t(response);
+    _workers->submit([this, handler, route, request, response, accepted]()
+    {
+        execute(handler, route, *request, *response, accepted);
+    });
+    return MG_MORE;
+}
+
+void core::WebServer::execute(WebServerActionHandler::SharedPtr_t handler, const WebRouter::Route* route, const WebRequest& request, WebResponse& response,
+    std::chrono::steady_clock::time_point accepted)
+{
+    TRACE_SPAN("WebServer::execute");
+    {
+        WebServerActionHandler::RequestScope scope(request, &response);
+        try
+        {
+            if (route != nullptr)
+            {
+                route->action();
+            }
+            else
+            {
+                handler->execute();
+            }
+        }
+        catch (common::Exception& ex)
+        {
+            sLogger.error(QString("Handler error (common::Exception): %1").arg(ex.what()));
+            response.fail();
+        }
+        catch (std::exception& ex)
+        {
+            sLogger.error(QString("Handler error (std::exception): %1").arg(ex.what()));
+            response.fail();
+        }
+    }
+    response.finish();
+    auto duration = route != nullptr ? route->duration : _handlerDurations.value(handler.get());
+    duration->record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - accepted).count());
+    std::lock_guard<std::mutex> lock(_activeMutex);
+    _activeResponses.erase(&response);
+}
+
+int core::WebServer::handleResponse(mg_connection* connection)
+{
+    auto response = static_cast<WebResponse::SharedPtr_t*>(connection->connection_param);
+    if (response == nullptr || connection->is_websocket || !(*response)->transfer(connection))
+    {
+        return MG_FALSE;
+    }
+    bool fileHandedOver = (*response)->fileHandedOver();
+    delete response;
+    connection->connection_param = nullptr;
+    // a file body is still being sent by mongoose, it completes the request itself
+    return fileHandedOver ? MG_FALSE : MG_TRUE;
+}
+
+void core::WebServer::handleClose(mg_connection* connection)
+{
+    auto response = static_cast<WebResponse::SharedPtr_t*>(connection->connection_param);
+    if (response == nullptr || connection->is_websocket)
+    {
+        return;
+    }
+    // the worker may still be writing, it keeps its own reference
+    (*response)->cancel();
+    delete response;
+    connection->connection_param = nullptr;
+}
@@ -11,10 +11,21 @@
 
 #include <common/SmartPtr.h>
 #include "WebServerActionHandler.h"
+#include "WebWorkerPool.h"
 #include <QtCore>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+struct mg_server;
 
 namespace core
 {
+    // The server thread accepts connections and parses requests, then matched requests are executed on a pool
+    // of worker threads, so that a slow request does not hold up the other clients. Websocket events and the
+    // handlers' poll() stay on the server thread.
     class WebServer
     {
     public:
@@ -26,14 +37,63 @@ namespace core
         int port() const { return _port; }
         void port(const int& port) { _port = port; }
 
+        int workerThreads() const { return _workerThreads; }
+        void workerThreads(const int& workerThreads) { _workerThreads = workerThreads; }
+
+        // Connections accepted above the limit get 503 Service Unavailable and are closed, 0 means no limit.
+        int maxConnections() const { return _maxConnections; }
+        void maxConnections(const int& maxConnections) { _maxConnections = maxConnections; }
+
         const QList<WebServerActionHandler::SharedPtr_t>& handlers() const { return _handlers; }
 
+        const WebRouter& router() const { return _router; }
+
+        // Registers the routes of the handler, handlers are added before runAsync().
         void addActionHandler(WebServerActionHandler::SharedPtr_t handler);
 
+        // Requests with uri starting with prefix are handled as if it started with replacement instead,
+        // e.g. the dashboard urls that used to be proxied by the Node application.
+        void addUriAlias(const QByteArray& prefix, const QByteArray& replacement);
+
         void runAsync();
+
+        // Thread-safe and never blocks: makes the server thread leave its poll wait and call the handlers' poll().
+        // Wakeups requested while one is pending are coalesced.
+        void wakeup();
+
+        // Server thread only.
+        void handlePoll();
+        // Starts the matching handler on a worker, returns the mongoose result for MG_REQUEST.
+        int handleRequest(mg_connection* connection);
+        // Writes the response produced so far, returns the mongoose result for MG_POLL.
+        int handleResponse(mg_connection* connection);
+        void handleClose(mg_connection* connection);
     private:
+        // The server thread: polls until the server is destroyed.
+        void serve(mg_server* server);
+        // Runs the route action, or handler->execute() if the request was matched by the handler itself.
+        void execute(WebServerActionHandler::SharedPtr_t handler, const WebRouter::Route* route, const WebRequest& request, WebResponse& response,
+            std::chrono::steady_clock::time_point accepted);
+
         int _port;
-        WebServer** _thisRef;
+        int _workerThreads;
+        int _maxConnections;
+        // the mongoose server parameter, cleared first when the server is destroyed so that the events
+        // still handled on the server thread leave the handlers alone
+        std::atomic<WebServer*> _self;
+        // set by runAsync(), read by wakeup() on the worker and runner threads
+        std::atomic<mg_server*> _server;
+        std::atomic<bool> _wakeupPending;
+        std::atomic<bool> _stopping;
+        std::thread _thread;
         QList<WebServerActionHandler::SharedPtr_t> _handlers;
+        WebRouter _router;
+        // request durations of the requests matched by the handlers themselves
+        QHash<WebServerActionHandler*, common::MetricHistogram*> _handlerDurations;
+        QList<QPair<QByteArray, QByteArray>> _uriAliases;
+        WebWorkerPool::SharedPtr_t _workers;
+        // responses being produced, cancelled when the server is destroyed
+        std::mutex _activeMutex;
+        std::set<WebResponse*> _activeResponses;
     };
 }
@@ -1,10 +1,101 @@
 ﻿#include "WebServerActionHandler.h"
 
 #include <mongoose.h>
+#include <common/Exception.h>
+
+namespace
+{
+    thread_local const core::WebRequest* currentRequest = nullptr;
+    thread_local core::WebResponse* currentResponse = nullptr;
+
+    QList<QByteArray> headerTokens(const char* header)
+    {
+        QList<QByteArray> result;
+        for (auto& token : QByteArray(header).split(','))
+        {
+            result.push_back(token.trimmed());
+        }
+        return result;
+    }
+
+    bool acceptsEncoding(const char* acceptEncoding, const char* encoding)
+    {
+        if (acceptEncoding == nullptr)
+        {
+            return false;
+        }
+        for (auto& token : headerTokens(acceptEncoding))
+        {
+            auto parameters = token.split(';');
+            if (parameters.first().trimmed() != encoding)
+            {
+                continue;
+            }
+            for (int i = 1; i < parameters.size(); i++)
+            {
+                // "gzip;q=0" means not acceptable
+                auto parameter = parameters[i].trimmed();
+                if (parameter.startsWith("q=") && parameter.mid(2).toDouble() == 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool etagMatches(const char* ifNoneMatch, const QByteArray& etag)
+    {
+        if (ifNoneMatch == nullptr)
+        {
+            return false;
+        }
+        for (auto& token : headerTokens(ifNoneMatch))
+        {
+            if (token == "*" || token == etag || (token.startsWith("W/") && token.mid(2) == etag))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+core::WebServerActionHandler::RequestScope::RequestScope(const WebRequest& request, WebResponse* response)
+: _previousRequest(currentRequest), _previousResponse(currentResponse)
+{
+    currentRequest = &request;
+    currentResponse = response;
+}
+
+core::WebServerActionHandler::RequestScope::~RequestScope()
+{
+    currentRequest = _previousRequest;
+    currentResponse = _previousResponse;
+}
+
+const core::WebRequest& core::WebServerActionHandler::request() const
+{
+    if (currentRequest == nullptr)
+    {
+        throw common::InvalidOperationException("No request is bound to the current thread.");
+    }
+    return *currentRequest;
+}
+
+core::WebResponse& core::WebServerActionHandler::response() const
+{
+    if (currentResponse == nullptr)
+    {
+        throw common::InvalidOperationException("No response is bound to the current thread.");
+    }
+    return *currentResponse;
+}
 
 bool core::WebServerActionHandler::methodMatch(const QString& requestMethod)
 {
-    return QString(connection()->request_method) == requestMethod;
+    return QString(request().method()) == requestMethod;
 }
 
 bool core::WebServerActionHandler::exactMatch(const QString& testUrl)
@@ -14,7 +105,7 @@ bool core::WebServerActionHandler::exactMatch(const QString& testUrl)
     {
         urlTrimmed = testUrl.mid(1);
     }
-    auto actualUrl = QString(connection()->uri);
+    auto actualUrl = QString(request().uri());
     if (actualUrl.length() > 0 && actualUrl.at(0) == '/')
     {
         actualUrl = actualUrl.mid(1);
@@ -24,5 +115,83 @@ bool core::WebServerActionHandler::exactMatch(const QString& testUrl)
 
 bool core::WebServerActionHandler::regexMatch(const QRegularExpression& pattern)
 {
-    return pattern.match(connection()->uri).hasMatch();
+    return pattern.match(request().uri()).hasMatch();
+}
+
+bool core::WebServerActionHandler::websocketFrame()
+{
+    return (connection()->wsbits & 0x0F) != WEBSOCKET_OPCODE_CONNECTION_CLOSE;
+}
+
+bool core::WebServerActionHandler::queryVariable(const QString& name, QString& value)
+{
+    char buffer[1024];
+    int length = mg_get_var(request().connection(), name.toLatin1().data(), buffer, sizeof(buffer));
+    if (length < 0)
+    {
+        return false;
+    }
+    value = QString::fromUtf8(buffer, length);
+    return true;
+}
+
+bool core::WebServerActionHandler::sendNotModified(const QByteArray& etag)
+{
+    if (etag.isEmpty() || !etagMatches(request().header("If-None-Match"), etag))
+    {
+        return false;
+    }
+    response().status(304);
+    response().header("ETag", etag);
+    response().end(QByteArray());
+    return true;
+}
+
+void core::WebServerActionHandler::sendResponse(const CachedResponse& cached)
+{
+    if (sendNotModified(cached.etag))
+    {
+        return;
+    }
+
+    const char* acceptEncoding = request().header("Accept-Encoding");
+    const QByteArray* body = &cached.body;
+    const char* contentEncoding = nullptr;
+    if (!cached.gzipped.isEmpty() && acceptsEncoding(acceptEncoding, "gzip"))
+    {
+        body = &cached.gzipped;
+        contentEncoding = "gzip";
+    }
+    else if (!cached.deflated.isEmpty() && acceptsEncoding(acceptEncoding, "deflate"))
+    {
+        body = &cached.deflated;
+        contentEncoding = "deflate";
+    }
+
+    auto& out = response();
+    out.status(200);
+    out.header("Content-Type", cached.contentType);
+    out.header("Vary", "Accept-Encoding");
+    out.header("Cache-Control", cached.cacheControl);
+    if (!cached.etag.isEmpty())
+    {
+        out.header("ETag", cached.etag);
+    }
+    if (contentEncoding != nullptr)
+    {
+        out.header("Content-Encoding", contentEncoding);
+    }
+    out.end(*body);
+}
+
+QByteArray& core::WebServerActionHandler::responseBuffer()
+{
+    static const int InitialCapacity = 64 * 1024;
+    static thread_local QByteArray buffer;
+    buffer.resize(0);
+    if (buffer.capacity() < InitialCapacity)
+    {
+        buffer.reserve(InitialCapacity);
+    }
+    return buffer;
 }
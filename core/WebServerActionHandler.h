@@ -10,33 +10,105 @@
 #pragma once
 
 #include <common/SmartPtr.h>
+#include "CachedResponse.h"
+#include "WebRequest.h"
+#include "WebResponse.h"
+#include "WebRouter.h"
 #include <QtCore>
+#include <boost/utility.hpp>
 
 struct mg_connection;
 
 namespace core
 {
+    class WebServer;
+
     class WebServerActionHandler
     {
     private:
         mg_connection* _connection;
+        WebServer* _server;
     protected:
         virtual ~WebServerActionHandler()
         {
         }
 
+        // The request being matched or executed on the current thread.
+        const WebRequest& request() const;
+        // The response being produced on the current thread, only available in execute().
+        WebResponse& response() const;
+
         bool methodMatch(const QString& requestMethod /* GET, POST, PUT, DELETE */);
         bool exactMatch(const QString& url);
         bool regexMatch(const QRegularExpression& pattern);
+        // Looks the variable up in the query string, then in the url-encoded body. Returns false if it is absent.
+        bool queryVariable(const QString& name, QString& value);
+
+        // Sends 304 Not Modified and returns true if the request If-None-Match contains the given quoted entity tag.
+        bool sendNotModified(const QByteArray& etag);
+        // Sends the response with Content-Length, compressed if the client accepts gzip or deflate.
+        // If the response has an ETag matching the request If-None-Match, only 304 Not Modified is sent.
+        void sendResponse(const CachedResponse& cached);
+
+        // Scratch buffer of the current thread for serializing a response, empty on every call.
+        // It keeps its capacity between requests unless a cached response still shares its data.
+        static QByteArray& responseBuffer();
 
     public:
         SMART_PTR_T(WebServerActionHandler);
 
+        // Binds the request (and the response for execute()) to the current thread while it is alive.
+        class RequestScope : boost::noncopyable
+        {
+        public:
+            RequestScope(const WebRequest& request, WebResponse* response);
+            ~RequestScope();
+        private:
+            const WebRequest* _previousRequest;
+            WebResponse* _previousResponse;
+        };
+
+        WebServerActionHandler() : _connection(nullptr), _server(nullptr)
+        {
+        }
+
+        // The websocket connection of the current event, server thread only. Plain HTTP handlers use request() and response().
         mg_connection* connection() const { return _connection; }
         void connection(mg_connection* connection) { _connection = connection; }
 
+        WebServer* server() const { return _server; }
+        void server(WebServer* server) { _server = server; }
+
         virtual QString name() const { return "Undefined"; }
-        virtual bool match() = 0;
-        virtual void execute() = 0;
+
+        // Called once by WebServer::addActionHandler. A request matching one of the routes runs the route action
+        // on a worker thread, match() and execute() are only used for the requests no route matches.
+        virtual void registerRoutes(WebRouter& router)
+        {
+        }
+
+        // Called on the server thread, then execute() runs on a worker thread, possibly for several requests at once.
+        virtual bool match()
+        {
+            return false;
+        }
+        virtual void execute()
+        {
+        }
+
+        // WebSocket endpoints are selected by match() as well, then these are called instead of execute().
+        virtual void websocketConnected()
+        {
+        }
+        // An incoming frame (connection()->wsbits, content). Return false to close the connection.
+        virtual bool websocketFrame();
+        virtual void websocketClosed()
+        {
+        }
+
+        // Called on the web server thread after every poll iteration or wakeup.
+        virtual void poll()
+        {
+        }
     };
 }
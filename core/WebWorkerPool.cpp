@@ -0,0 +1,62 @@
+#include "WebWorkerPool.h"
+#include <common/Tracer.h>
+
+core::WebWorkerPool::WebWorkerPool(int threadsCount) : _runningCount(0), _stopping(false)
+{
+    for (int i = 0; i < threadsCount; i++)
+    {
+        _threads.emplace_back([this]() { work(); });
+    }
+}
+
+core::WebWorkerPool::~WebWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        _tasks.clear();
+    }
+    _hasTasks.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void core::WebWorkerPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _hasTasks.notify_one();
+}
+
+int core::WebWorkerPool::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return int(_tasks.size()) + _runningCount;
+}
+
+void core::WebWorkerPool::work()
+{
+    TRACE_THREAD_NAME("web worker");
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _hasTasks.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+            if (_stopping)
+            {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+            _runningCount++;
+        }
+        task();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _runningCount--;
+    }
+}
@@ -0,0 +1,47 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   WebWorkerPool.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/SmartPtr.h>
+#include <boost/utility.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+    // Fixed set of threads executing web requests in the order they were submitted.
+    class WebWorkerPool : boost::noncopyable
+    {
+    public:
+        SMART_PTR_T(WebWorkerPool);
+
+        explicit WebWorkerPool(int threadsCount);
+        // Waits for the running tasks, the queued ones are dropped.
+        ~WebWorkerPool();
+
+        void submit(std::function<void()> task);
+
+        // Tasks submitted and not finished yet.
+        int pendingCount() const;
+    private:
+        void work();
+
+        mutable std::mutex _mutex;
+        std::condition_variable _hasTasks;
+        std::deque<std::function<void()>> _tasks;
+        std::vector<std::thread> _threads;
+        int _runningCount;
+        bool _stopping;
+    };
+}
@@ -0,0 +1,37 @@
+#include "BenchData.h"
+#include <SyntheticDevice.h>
+#include <common/BitConverterT.h>
+
+QVector<core::EbDevice::Sample> core::bench::createSamples(int count)
+{
+    SyntheticDeviceSettings settings;
+    settings.rateHz = SyntheticDevice::MaxRateHz;
+    SyntheticDevice device(settings);
+    device.sendAuto(-5);
+    auto due = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<qint64>(count * 1e6 / settings.rateHz));
+    QVector<EbDevice::Sample> result;
+    result.reserve(count);
+    while (result.size() < count)
+    {
+        for (auto& sample : device.readSamplesDue(due))
+        {
+            result.push_back(sample);
+        }
+    }
+    result.resize(count);
+    return result;
+}
+
+QByteArray core::bench::encodeSampleFrame(const EbDevice::Sample& sample)
+{
+    QByteArray frame(12, Qt::Uninitialized);
+    char* data = frame.data();
+    qint64 timeMs = sample.time.toMSecsSinceEpoch();
+    common::BigEndianConverter::ToByteArray(sample.field, data);
+    common::BigEndianConverter::ToByteArray(sample.qmc, data + 4);
+    common::BigEndianConverter::ToByteArray(static_cast<uint8_t>(sample.state), data + 6);
+    common::BigEndianConverter::ToByteArray(static_cast<int32_t>(timeMs / 1000), data + 7);
+    // hundredths of a second
+    common::BigEndianConverter::ToByteArray(static_cast<uint8_t>(timeMs % 1000 / 10), data + 11);
+    return frame;
+}
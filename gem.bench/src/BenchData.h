@@ -0,0 +1,49 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   BenchData.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <EbDevice.h>
+#include <IBinaryStream.h>
+
+namespace core
+{
+    namespace bench
+    {
+        // Samples of the synthetic device at 10 kHz with its default noise and invalid share, the same on every run.
+        QVector<EbDevice::Sample> createSamples(int count);
+
+        // Binary frame of the sample as the GSM-19 sends it, before escaping.
+        QByteArray encodeSampleFrame(const EbDevice::Sample& sample);
+
+        // Output stream that only counts the bytes, so that the benchmarks do not measure the disk.
+        class NullBinaryStream : public IBinaryStream
+        {
+        public:
+            SMART_PTR_T(NullBinaryStream);
+
+            NullBinaryStream() : _size(0)
+            {
+            }
+
+            qint64 size() const { return _size; }
+
+            void close() override {}
+            void write(QByteArray data) override { _size += data.size(); }
+            void write(const char* data, qint64 len) override { _size += len; }
+            QByteArray read(qint64 maxlen) override { return QByteArray(); }
+            qint64 read(char * data, qint64 maxSize) override { return 0; }
+            QByteArray peek(qint64 maxlen) override { return QByteArray(); }
+            qint64 peek(char * data, qint64 maxSize) override { return 0; }
+            bool flush() override { return true; }
+        private:
+            qint64 _size;
+        };
+    }
+}
@@ -0,0 +1,79 @@
+#include "BenchData.h"
+#include <EbFrameCodec.h>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace core;
+
+namespace
+{
+    // Serial input of back-to-back frames, specialPercent of the bytes need escaping
+    QByteArray createFrameData(int size, int specialPercent)
+    {
+        std::mt19937 random(42);
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; i++)
+        {
+            uint8_t c = static_cast<uint8_t>(random());
+            if (int(random() % 100) < specialPercent)
+            {
+                c = c % 0x20;
+            }
+            else if (c < 0x20)
+            {
+                c += 0x20;
+            }
+            data[i] = c;
+        }
+        return data;
+    }
+
+    void BM_ParseSample(benchmark::State& state)
+    {
+        EbDevice device;
+        auto samples = bench::createSamples(1024);
+        QVector<QByteArray> frames;
+        for (auto& sample : samples)
+        {
+            frames.push_back(bench::encodeSampleFrame(sample));
+        }
+        int index = 0;
+        for (auto _ : state)
+        {
+            auto sample = device.parseSample(frames[index].data());
+            benchmark::DoNotOptimize(sample);
+            index = (index + 1) % frames.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ParseSample);
+
+    void BM_EscapeFrame(benchmark::State& state)
+    {
+        auto data = createFrameData(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+        QByteArray escaped(EbFrameCodec::maxEscapedSize(data.size()), Qt::Uninitialized);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(EbFrameCodec::escape(data.constData(), data.size(), escaped.data()));
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * data.size());
+    }
+    BENCHMARK(BM_EscapeFrame)->ArgNames({ "bytes", "specialPercent" })->Args({ 12, 0 })->Args({ 4096, 0 })->Args({ 4096, 5 })->Args({ 4096, 50 });
+
+    void BM_UnescapeFrame(benchmark::State& state)
+    {
+        auto data = createFrameData(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+        QByteArray escaped(EbFrameCodec::maxEscapedSize(data.size()), Qt::Uninitialized);
+        escaped.resize(EbFrameCodec::escape(data.constData(), data.size(), escaped.data()));
+        QByteArray unescaped(escaped.size(), Qt::Uninitialized);
+        for (auto _ : state)
+        {
+            int errors = 0;
+            benchmark::DoNotOptimize(EbFrameCodec::unescape(escaped.constData(), escaped.size(), unescaped.data(), errors));
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * escaped.size());
+    }
+    BENCHMARK(BM_UnescapeFrame)->ArgNames({ "bytes", "specialPercent" })->Args({ 12, 0 })->Args({ 4096, 0 })->Args({ 4096, 5 })->Args({ 4096, 50 });
+}
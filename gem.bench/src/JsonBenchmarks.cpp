@@ -0,0 +1,82 @@
+#include "BenchData.h"
+#include <RunnerActionHandler.h>
+#include <benchmark/benchmark.h>
+
+using namespace core;
+
+namespace
+{
+    // as much as the api/data list keeps
+    const int DataSamplesCount = 100;
+
+    void BM_StatusJson(benchmark::State& state)
+    {
+        RunnerStatus status;
+        status.about = "GSM-19 v7.0 s/n 4061387";
+        status.enq = "GSM-19";
+        status.time = QDateTime::currentDateTimeUtc();
+        status.timeUpdated = status.time;
+        status.updated = status.time;
+        status.isRunning = true;
+        status.samplingIntervalMs = 200;
+        status.range.minField = 45000000;
+        status.range.maxField = 55000000;
+        status.mseedSettings.fileName = "data.mseed";
+        status.mseedSettings.network = "RU";
+        status.mseedSettings.station = "IFZ";
+        status.mseedSettings.location = "SK";
+        status.mseedSettings.samplesInRecord = 100;
+        QByteArray buffer;
+        buffer.reserve(64 * 1024);
+        for (auto _ : state)
+        {
+            buffer.resize(0);
+            RunnerActionHandler::writeStatusJson(buffer, status, 0);
+            benchmark::DoNotOptimize(buffer.constData());
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_StatusJson);
+
+    void BM_DataJson(benchmark::State& state)
+    {
+        RunnerDataSnapshot data;
+        data.samples = bench::createSamples(DataSamplesCount);
+        data.lastSampleId = 1000000;
+        // a client that polls with a cursor gets the newest samples only
+        quint64 since = data.lastSampleId - state.range(0);
+        QByteArray buffer;
+        buffer.reserve(64 * 1024);
+        for (auto _ : state)
+        {
+            buffer.resize(0);
+            RunnerActionHandler::writeDataJson(buffer, data, since);
+            benchmark::DoNotOptimize(buffer.constData());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_DataJson)->ArgName("samples")->Arg(5)->Arg(DataSamplesCount);
+
+    void BM_LogJson(benchmark::State& state)
+    {
+        BufferedLogger logger;
+        auto samples = bench::createSamples(static_cast<int>(state.range(0)));
+        for (auto& sample : samples)
+        {
+            // distinct messages, repeated ones would be collapsed
+            logger.info(QString("Received another sample: field: %1, time: %2, state: 0x%3, qmc: %4")
+                .arg(sample.field).arg(sample.time.toString(Qt::ISODate)).arg(sample.state, 2, 16).arg(sample.qmc));
+        }
+        QByteArray buffer;
+        buffer.reserve(64 * 1024);
+        for (auto _ : state)
+        {
+            buffer.resize(0);
+            benchmark::DoNotOptimize(RunnerActionHandler::writeLogJson(buffer, logger, 0));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_LogJson)->ArgName("messages")->Arg(10)->Arg(1000);
+}
@@ -0,0 +1,110 @@
+#include "BenchData.h"
+#include <MSeedReader.h>
+#include <MSeedWriter.h>
+#include <Runner.h>
+#include <SyntheticDevice.h>
+#include <FileBinaryStream.h>
+#include <benchmark/benchmark.h>
+
+using namespace core;
+
+namespace
+{
+    RunnerConfig createConfig()
+    {
+        RunnerConfig config;
+        config.msRecordLocation = "SK";
+        config.msRecordNetwork = "RU";
+        config.msRecordStation = "IFZ";
+        return config;
+    }
+
+    IntegerMSeedRecord::SharedPtr_t createRecord(const QVector<EbDevice::Sample>& samples, bool quality)
+    {
+        auto record = std::make_shared<IntegerMSeedRecord>();
+        record->channelName(quality ? "QMC" : "FLD");
+        record->location("SK");
+        record->network("RU");
+        record->station("IFZ");
+        record->samplingRateHz(SyntheticDevice::MaxRateHz);
+        record->startTime(samples.first().time);
+        for (auto& sample : samples)
+        {
+            record->data().push_back(quality ? sample.qmc : sample.field);
+        }
+        return record;
+    }
+
+    // The samples cache of the Runner written with the default Steim2 encoding.
+    void BM_FlushSamplesCache(benchmark::State& state)
+    {
+        auto samples = bench::createSamples(static_cast<int>(state.range(0)));
+        auto config = createConfig();
+        auto stream = std::make_shared<bench::NullBinaryStream>();
+        MSeedWriter writer(stream);
+        writer.verbose(MSeedPackVerbose::None);
+        for (auto _ : state)
+        {
+            Runner::writeSamples(writer, config, samples, SyntheticDevice::MaxRateHz);
+        }
+        state.SetItemsProcessed(state.iterations() * samples.size());
+        state.counters["bytesPerSample"] = double(stream->size()) / (state.iterations() * samples.size());
+    }
+    BENCHMARK(BM_FlushSamplesCache)->ArgName("samples")->Arg(2)->Arg(100)->Arg(1000)->Arg(10000);
+
+    // Integer encodings only, the writer packs 32-bit integers. Int16 gets the QMC column, the field does not fit.
+    void BM_MSeedWrite(benchmark::State& state)
+    {
+        auto encoding = static_cast<MSeedDataEncoding>(state.range(0));
+        auto samples = bench::createSamples(10000);
+        auto record = createRecord(samples, encoding == Int16);
+        auto stream = std::make_shared<bench::NullBinaryStream>();
+        MSeedWriter writer(stream);
+        writer.verbose(MSeedPackVerbose::None);
+        writer.encoding(encoding);
+        for (auto _ : state)
+        {
+            if (!writer.write(record))
+            {
+                state.SkipWithError("msr_pack() failed.");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * samples.size());
+        state.counters["bytesPerSample"] = double(stream->size()) / (state.iterations() * samples.size());
+    }
+    BENCHMARK(BM_MSeedWrite)->ArgName("encoding")->Arg(Int16)->Arg(Int32)->Arg(Steim1)->Arg(Steim2);
+
+    void BM_MSeedReadAll(benchmark::State& state)
+    {
+        QTemporaryDir directory;
+        QString fileName = directory.filePath("bench.mseed");
+        auto samples = bench::createSamples(10000);
+        {
+            auto stream = std::make_shared<FileBinaryStream>(fileName, true);
+            MSeedWriter writer(stream);
+            writer.verbose(MSeedPackVerbose::None);
+            for (int i = 0; i < static_cast<int>(state.range(0)); i++)
+            {
+                Runner::writeSamples(writer, createConfig(), samples, SyntheticDevice::MaxRateHz);
+            }
+            writer.close();
+        }
+        MSeedReader reader(fileName);
+        reader.verbose(MSeedPackVerbose::None);
+        for (auto _ : state)
+        {
+            bool success = false;
+            auto records = reader.readAll(&success);
+            if (!success)
+            {
+                state.SkipWithError("The file could not be read.");
+                break;
+            }
+            benchmark::DoNotOptimize(records);
+        }
+        // every flush writes three channels
+        state.SetItemsProcessed(state.iterations() * state.range(0) * samples.size() * 3);
+    }
+    BENCHMARK(BM_MSeedReadAll)->ArgName("flushes")->Arg(1)->Arg(10);
+}
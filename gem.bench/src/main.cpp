@@ -0,0 +1,52 @@
+#include <QtCore/QtCore>
+#include <benchmark/benchmark.h>
+#include <libmseed.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "common/Logger.h"
+
+using namespace common;
+
+namespace
+{
+    // libmseed reports every packed and read record
+    void discardMSeedLog(char*)
+    {
+    }
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication a(argc, argv);
+
+    sLogger.initialize(LogLevel::Warn);
+    ms_loginit(&discardMSeedLog, nullptr, nullptr, nullptr);
+
+    // The results are also written as JSON to be compared across releases, unless another output is given.
+    std::vector<char*> args(argv, argv + argc);
+    std::string outArg = "--benchmark_out=gem.bench.json";
+    std::string outFormatArg = "--benchmark_out_format=json";
+    bool hasOut = false;
+    for (int i = 1; i < argc; i++)
+    {
+        hasOut = hasOut || std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+    }
+    if (!hasOut)
+    {
+        args.push_back(&outArg[0]);
+        args.push_back(&outFormatArg[0]);
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+    {
+        return 1;
+    }
+    benchmark::AddCustomContext("gem_log_min_level", std::to_string(GEM_LOG_MIN_LEVEL));
+#ifdef GEM_ENABLE_TRACING
+    benchmark::AddCustomContext("gem_tracing", "on");
+#endif
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include "LoadGenerator.h"
+#include <common/InvalidOperationException.h>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    // pause after a failed connect, so that a server that is down is not hammered by every thread
+    const int ReconnectDelayMs = 10;
+
+    double toMilliseconds(uint64_t microseconds)
+    {
+        return microseconds / 1000.0;
+    }
+
+    void writeReportLine(FILE* out, const char* path, uint64_t requests, uint64_t errors, double elapsedSeconds, const common::MetricHistogram& latency)
+    {
+        uint64_t count = latency.count();
+        std::fprintf(out, "%-32s %10llu %8llu %10.1f %9.2f %9.2f %9.2f %9.2f\n", path, static_cast<unsigned long long>(requests),
+            static_cast<unsigned long long>(errors), elapsedSeconds > 0 ? requests / elapsedSeconds : 0.0,
+            toMilliseconds(latency.quantile(0.5)), toMilliseconds(latency.quantile(0.99)), toMilliseconds(latency.quantile(0.999)),
+            count > 0 ? toMilliseconds(latency.sum()) / count : 0.0);
+    }
+
+    QJsonObject latencyJson(const common::MetricHistogram& latency)
+    {
+        QJsonObject json;
+        json["p50Ms"] = toMilliseconds(latency.quantile(0.5));
+        json["p99Ms"] = toMilliseconds(latency.quantile(0.99));
+        json["p999Ms"] = toMilliseconds(latency.quantile(0.999));
+        json["meanMs"] = latency.count() > 0 ? toMilliseconds(latency.sum()) / latency.count() : 0.0;
+        return json;
+    }
+}
+
+core::loadtest::LoadGenerator::LoadGenerator(const LoadSettings& settings) : _settings(settings), _elapsedSeconds(0)
+{
+    if (settings.connections < 1 || settings.durationSeconds < 1 || settings.timeoutMs < 1)
+    {
+        throw common::InvalidOperationException("Load test needs at least one connection, a duration and a timeout.");
+    }
+    if (settings.endpoints.isEmpty())
+    {
+        throw common::InvalidOperationException("Load test needs at least one endpoint.");
+    }
+    for (auto& path : settings.endpoints)
+    {
+        _endpoints.push_back(std::unique_ptr<EndpointStats>(new EndpointStats(path)));
+    }
+}
+
+void core::loadtest::LoadGenerator::run()
+{
+    auto started = Clock::now();
+    auto deadline = started + std::chrono::seconds(_settings.durationSeconds);
+    std::vector<std::thread> threads;
+    threads.reserve(_settings.connections);
+    for (int i = 0; i < _settings.connections; i++)
+    {
+        threads.push_back(std::thread([this, i, deadline]() { runConnection(i, deadline); }));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    // the requests in flight at the deadline are counted, so is the time they took
+    _elapsedSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+int core::loadtest::LoadGenerator::requestOnce(const QByteArray& method, const QByteArray& path, const QByteArray& body, QByteArray& responseBody)
+{
+    QTcpSocket socket;
+    if (!connect(socket))
+    {
+        return 0;
+    }
+    QByteArray buffer;
+    qint64 bodySize = 0;
+    return request(socket, buffer, method, path, body, &responseBody, bodySize);
+}
+
+void core::loadtest::LoadGenerator::runConnection(int index, Clock::time_point deadline)
+{
+    // the socket lives on this thread, its blocking API needs no event loop
+    QTcpSocket socket;
+    QByteArray buffer;
+    // connections start at different endpoints, so that every endpoint is loaded from the first request on
+    size_t next = index % _endpoints.size();
+    while (Clock::now() < deadline)
+    {
+        auto& endpoint = *_endpoints[next];
+        next = (next + 1) % _endpoints.size();
+        if (socket.state() != QAbstractSocket::ConnectedState)
+        {
+            buffer.clear();
+            if (!connect(socket))
+            {
+                endpoint.errors.add();
+                std::this_thread::sleep_for(std::chrono::milliseconds(ReconnectDelayMs));
+                continue;
+            }
+            _connectionsOpened.add();
+        }
+
+        auto requestStarted = Clock::now();
+        qint64 bodySize = 0;
+        int status = request(socket, buffer, "GET", endpoint.path, QByteArray(), nullptr, bodySize);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - requestStarted).count();
+        if (status >= 200 && status < 400)
+        {
+            endpoint.latency.record(static_cast<uint64_t>(elapsed));
+            _totalLatency.record(static_cast<uint64_t>(elapsed));
+            endpoint.bodyBytes.add(static_cast<uint64_t>(bodySize));
+        }
+        else
+        {
+            endpoint.errors.add();
+            if (status == 0)
+            {
+                // the rest of a broken response must not be read as the next one
+                socket.abort();
+            }
+        }
+    }
+    socket.abort();
+}
+
+bool core::loadtest::LoadGenerator::connect(QTcpSocket& socket)
+{
+    socket.abort();
+    socket.connectToHost(_settings.host, static_cast<quint16>(_settings.port));
+    if (!socket.waitForConnected(_settings.timeoutMs))
+    {
+        return false;
+    }
+    socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    return true;
+}
+
+bool core::loadtest::LoadGenerator::readMore(QTcpSocket& socket, QByteArray& buffer)
+{
+    if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(_settings.timeoutMs))
+    {
+        return false;
+    }
+    buffer.append(socket.readAll());
+    return true;
+}
+
+int core::loadtest::LoadGenerator::request(QTcpSocket& socket, QByteArray& buffer, const QByteArray& method, const QByteArray& path,
+    const QByteArray& body, QByteArray* responseBody, qint64& bodySize)
+{
+    QByteArray text;
+    text.reserve(128 + path.size() + body.size());
+    text.append(method).append(" /").append(path).append(" HTTP/1.1\r\n");
+    text.append("Host: ").append(_settings.host.toLatin1()).append(':').append(QByteArray::number(_settings.port)).append("\r\n");
+    if (!body.isEmpty())
+    {
+        text.append("Content-Type: application/json\r\n");
+        text.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    }
+    text.append("\r\n").append(body);
+    if (socket.write(text) != text.size() || !socket.waitForBytesWritten(_settings.timeoutMs))
+    {
+        return 0;
+    }
+
+    int headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) < 0)
+    {
+        if (!readMore(socket, buffer))
+        {
+            return 0;
+        }
+    }
+    // "HTTP/1.1 200 OK"
+    if (!buffer.startsWith("HTTP/1.") || headerEnd < 12)
+    {
+        return 0;
+    }
+    int status = buffer.mid(9, 3).toInt();
+    qint64 contentLength = -1;
+    bool chunked = false;
+    bool close = false;
+    auto lines = buffer.left(headerEnd).split('\n');
+    for (int i = 1; i < lines.size(); i++)
+    {
+        auto& line = lines[i];
+        int colon = line.indexOf(':');
+        if (colon < 0)
+        {
+            continue;
+        }
+        auto name = line.left(colon).trimmed().toLower();
+        auto value = line.mid(colon + 1).trimmed().toLower();
+        if (name == "content-length")
+        {
+            contentLength = value.toLongLong();
+        }
+        else if (name == "transfer-encoding")
+        {
+            chunked = value.contains("chunked");
+        }
+        else if (name == "connection")
+        {
+            close = value == "close";
+        }
+    }
+    buffer.remove(0, headerEnd + 4);
+
+    if (chunked)
+    {
+        while (true)
+        {
+            int lineEnd;
+            while ((lineEnd = buffer.indexOf("\r\n")) < 0)
+            {
+                if (!readMore(socket, buffer))
+                {
+                    return 0;
+                }
+            }
+            bool ok;
+            qint64 chunkSize = buffer.left(lineEnd).trimmed().toLongLong(&ok, 16);
+            if (!ok || chunkSize < 0)
+            {
+                return 0;
+            }
+            // the chunk and its CRLF, the server sends no trailers after the last one
+            while (buffer.size() < lineEnd + 2 + chunkSize + 2)
+            {
+                if (!readMore(socket, buffer))
+                {
+                    return 0;
+                }
+            }
+            if (responseBody != nullptr)
+            {
+                responseBody->append(buffer.constData() + lineEnd + 2, static_cast<int>(chunkSize));
+            }
+            bodySize += chunkSize;
+            buffer.remove(0, lineEnd + 2 + static_cast<int>(chunkSize) + 2);
+            if (chunkSize == 0)
+            {
+                break;
+            }
+        }
+    }
+    else if (contentLength >= 0 || status == 204 || status == 304 || status < 200)
+    {
+        contentLength = qMax<qint64>(0, contentLength);
+        while (buffer.size() < contentLength)
+        {
+            if (!readMore(socket, buffer))
+            {
+                return 0;
+            }
+        }
+        if (responseBody != nullptr)
+        {
+            responseBody->append(buffer.constData(), static_cast<int>(contentLength));
+        }
+        bodySize = contentLength;
+        buffer.remove(0, static_cast<int>(contentLength));
+    }
+    else
+    {
+        // the body ends with the connection
+        while (socket.state() == QAbstractSocket::ConnectedState && readMore(socket, buffer))
+        {
+        }
+        if (responseBody != nullptr)
+        {
+            responseBody->append(buffer);
+        }
+        bodySize = buffer.size();
+        buffer.clear();
+        close = true;
+    }
+
+    if (close)
+    {
+        socket.abort();
+    }
+    return status;
+}
+
+void core::loadtest::LoadGenerator::writeReport(FILE* out) const
+{
+    std::fprintf(out, "%d connections, %.1f s, %llu connections opened, latencies in ms (bucket upper bounds, within 12.5%%)\n",
+        _settings.connections, _elapsedSeconds, static_cast<unsigned long long>(connectionsOpened()));
+    std::fprintf(out, "%-32s %10s %8s %10s %9s %9s %9s %9s\n", "endpoint", "requests", "errors", "req/s", "p50", "p99", "p99.9", "mean");
+    uint64_t totalRequests = 0;
+    uint64_t totalErrors = 0;
+    for (auto& endpoint : _endpoints)
+    {
+        auto& latency = endpoint->latency;
+        uint64_t errors = endpoint->errors.value();
+        writeReportLine(out, endpoint->path.constData(), latency.count() + errors, errors, _elapsedSeconds, latency);
+        totalRequests += latency.count() + errors;
+        totalErrors += errors;
+    }
+    writeReportLine(out, "total", totalRequests, totalErrors, _elapsedSeconds, _totalLatency);
+}
+
+QJsonObject core::loadtest::LoadGenerator::reportJson() const
+{
+    QJsonObject json;
+    json["connections"] = _settings.connections;
+    json["elapsedSeconds"] = _elapsedSeconds;
+    json["connectionsOpened"] = static_cast<double>(connectionsOpened());
+    json["total"] = latencyJson(_totalLatency);
+    QJsonArray endpoints;
+    for (auto& endpoint : _endpoints)
+    {
+        auto& latency = endpoint->latency;
+        uint64_t errors = endpoint->errors.value();
+        uint64_t requests = latency.count() + errors;
+        auto item = latencyJson(latency);
+        item["path"] = QString(endpoint->path);
+        item["requests"] = static_cast<double>(requests);
+        item["errors"] = static_cast<double>(errors);
+        item["requestsPerSecond"] = _elapsedSeconds > 0 ? requests / _elapsedSeconds : 0.0;
+        item["bodyBytes"] = static_cast<double>(endpoint->bodyBytes.value());
+        endpoints.append(item);
+    }
+    json["endpoints"] = endpoints;
+    return json;
+}
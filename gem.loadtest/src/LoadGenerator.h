@@ -0,0 +1,94 @@
+// ***********************************************************************
+// <author>Stephan Burguchev</author>
+// <copyright company="Stephan Burguchev">
+//   Copyright (c) Stephan Burguchev 2012-2015. All rights reserved.
+// </copyright>
+// <summary>
+//   LoadGenerator.h
+// </summary>
+// ***********************************************************************
+#pragma once
+
+#include <common/Metrics.h>
+#include <QtCore>
+#include <QtNetwork/QTcpSocket>
+#include <boost/utility.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace core
+{
+    namespace loadtest
+    {
+        struct LoadSettings
+        {
+            LoadSettings() : host("127.0.0.1"), port(8000), connections(64), durationSeconds(10), timeoutMs(5000)
+            {
+            }
+
+            QString host;
+            int port;
+            // keep-alive connections, each one sends its next request as soon as the previous response is read
+            int connections;
+            int durationSeconds;
+            // a request that takes longer is an error and its connection is reopened
+            int timeoutMs;
+            // paths with the query, requested in turn by every connection
+            QList<QByteArray> endpoints;
+        };
+
+        struct EndpointStats : boost::noncopyable
+        {
+            explicit EndpointStats(const QByteArray& path) : path(path)
+            {
+            }
+
+            QByteArray path;
+            // microseconds from sending the request until the whole response is read, 2xx and 3xx only
+            common::MetricHistogram latency;
+            // failed connects, timeouts, broken responses and statuses >= 400
+            common::MetricCounter errors;
+            common::MetricCounter bodyBytes;
+        };
+
+        // Closed-loop HTTP/1.1 load: every connection runs on its own thread with the blocking QTcpSocket API,
+        // so the numbers are the server's and not those of an event loop shared with the generator.
+        class LoadGenerator : boost::noncopyable
+        {
+        public:
+            explicit LoadGenerator(const LoadSettings& settings);
+
+            // Blocks for the duration of the run.
+            void run();
+
+            // One request on a new connection, to prepare the server. Returns the status, 0 if there was no response.
+            int requestOnce(const QByteArray& method, const QByteArray& path, const QByteArray& body, QByteArray& responseBody);
+
+            double elapsedSeconds() const { return _elapsedSeconds; }
+            // connections opened during the run, more than the settings ask for if the server closed some
+            uint64_t connectionsOpened() const { return _connectionsOpened.value(); }
+            const std::vector<std::unique_ptr<EndpointStats>>& endpoints() const { return _endpoints; }
+
+            // Table with a line per endpoint and the total, latencies in milliseconds.
+            void writeReport(FILE* out) const;
+            QJsonObject reportJson() const;
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            void runConnection(int index, Clock::time_point deadline);
+            bool connect(QTcpSocket& socket);
+            // Sends the request and reads the whole response, returns its status or 0 if the connection failed.
+            int request(QTcpSocket& socket, QByteArray& buffer, const QByteArray& method, const QByteArray& path, const QByteArray& body,
+                QByteArray* responseBody, qint64& bodySize);
+            bool readMore(QTcpSocket& socket, QByteArray& buffer);
+
+            LoadSettings _settings;
+            std::vector<std::unique_ptr<EndpointStats>> _endpoints;
+            // of all the endpoints
+            common::MetricHistogram _totalLatency;
+            common::MetricCounter _connectionsOpened;
+            double _elapsedSeconds;
+        };
+    }
+}
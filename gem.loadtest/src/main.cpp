@@ -0,0 +1,163 @@
+#include <QtCore/QtCore>
+#include <cstdio>
+#include <thread>
+#include "common/Logger.h"
+#include <Runner.h>
+#include "LoadGenerator.h"
+
+using namespace common;
+
+namespace
+{
+    const char* DefaultEndpoints[] = { "api/status", "api/data", "api/log", "api/aggregates?level=1s", "api/metrics" };
+
+    // Longest time the web server of the runner may take to start listening.
+    const int StartupTimeoutMs = 5000;
+    const int StartupRetryMs = 50;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Closed-loop HTTP load on the API of an in-process runner with a synthetic device.\n"
+        "Exits with 2 if any request failed.");
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Web server port.", "port", "18000");
+    QCommandLineOption connectionsOption("connections", "Concurrent keep-alive connections.", "count", "64");
+    QCommandLineOption durationOption("duration", "Seconds of load.", "seconds", "10");
+    QCommandLineOption warmupOption("warmup", "Seconds of logging before the load, so that the data endpoints have something to return.", "seconds", "2");
+    QCommandLineOption timeoutOption("timeout", "Milliseconds a request may take before it counts as an error.", "ms", "5000");
+    QCommandLineOption workersOption("workers", "Web server worker threads.", "count", "4");
+    QCommandLineOption rateOption("rate", "Synthetic samples per second.", "hz", "10");
+    QCommandLineOption endpointOption("endpoint", "Path with the query to request, can be repeated (default: the API the dashboard polls).", "path");
+    QCommandLineOption outOption("out", "Also write the results as JSON to the file.", "file");
+    for (auto& option : { portOption, connectionsOption, durationOption, warmupOption, timeoutOption, workersOption, rateOption, endpointOption, outOption })
+    {
+        parser.addOption(option);
+    }
+    parser.process(a);
+
+    sLogger.initialize(LogLevel::Warn);
+
+    core::loadtest::LoadSettings settings;
+    settings.port = parser.value(portOption).toInt();
+    settings.connections = parser.value(connectionsOption).toInt();
+    settings.durationSeconds = parser.value(durationOption).toInt();
+    settings.timeoutMs = parser.value(timeoutOption).toInt();
+    for (auto endpoint : parser.values(endpointOption))
+    {
+        // the generator adds the leading slash
+        while (endpoint.startsWith('/'))
+        {
+            endpoint.remove(0, 1);
+        }
+        settings.endpoints.append(endpoint.toLatin1());
+    }
+    if (settings.endpoints.isEmpty())
+    {
+        for (auto endpoint : DefaultEndpoints)
+        {
+            settings.endpoints.append(endpoint);
+        }
+    }
+
+    try
+    {
+        QTemporaryDir dataDir;
+        if (!dataDir.isValid())
+        {
+            std::fprintf(stderr, "Failed to create a temporary directory for the miniSEED file.\n");
+            return 1;
+        }
+
+        core::RunnerConfig config;
+        config.webServerPort = settings.port;
+        config.webServerWorkerThreads = parser.value(workersOption).toInt();
+        // the load must not be turned away by the connections limit
+        config.webServerMaxConnections = settings.connections + 16;
+        config.webServerStaticMaxAgeSeconds = 0;
+        config.devicePortName = "synthetic";
+        config.deviceType = "synthetic";
+        config.syntheticDevice.rateHz = parser.value(rateOption).toDouble();
+        config.msRecordNetwork = "XX";
+        config.msRecordStation = "LOAD";
+        config.msFileName = dataDir.filePath("loadtest.mseed");
+        config.samplesCacheMaxSize = 100;
+        config.skipDiagnostics = true;
+        config.historyRetentionDays = 1;
+        config.historyMaxSizeMb = 64;
+        config.webLogLevel = LogLevel::Info;
+
+        core::loadtest::LoadGenerator generator(settings);
+        auto runner = std::make_shared<core::Runner>(config);
+        std::thread runnerThread([runner]()
+        {
+            try
+            {
+                runner->run();
+            }
+            catch (Exception& ex)
+            {
+                sLogger.error(QString("Runner failed: %1").arg(ex.what()));
+            }
+        });
+
+        // the runner starts idle, logging is started as the dashboard does it
+        QByteArray response;
+        int status = 0;
+        QElapsedTimer startup;
+        startup.start();
+        while (status == 0 && startup.elapsed() < StartupTimeoutMs)
+        {
+            status = generator.requestOnce("POST", "api/command?wait=5000", "{ \"command\": \"run\", \"intervalMilliseconds\": 200 }", response);
+            if (status == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(StartupRetryMs));
+            }
+        }
+        if (status != 200)
+        {
+            std::fprintf(stderr, "Failed to start logging (HTTP %d): %s\n", status, response.constData());
+            runner->stop();
+            runnerThread.join();
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(parser.value(warmupOption).toInt()));
+
+        generator.run();
+
+        runner->stop();
+        runnerThread.join();
+
+        generator.writeReport(stdout);
+        if (parser.isSet(outOption))
+        {
+            QFile out(parser.value(outOption));
+            if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                std::fprintf(stderr, "Failed to write %s.\n", qPrintable(out.fileName()));
+                return 1;
+            }
+            auto json = generator.reportJson();
+            json["workerThreads"] = config.webServerWorkerThreads;
+            json["rateHz"] = config.syntheticDevice.rateHz;
+            out.write(QJsonDocument(json).toJson());
+        }
+
+        for (auto& endpoint : generator.endpoints())
+        {
+            if (endpoint->errors.value() > 0)
+            {
+                return 2;
+            }
+        }
+        return 0;
+    }
+    catch (Exception& ex)
+    {
+        sLogger.error(ex.what());
+        return 1;
+    }
+}
@@ -21,30 +21,52 @@ int main(int argc, char** argv)
 
         sIniSettings.Initialize(Path::Combine(Path::ApplicationDirPath(), "config.ini"));
         sLogger.initialize((LogLevel)sIniSettings.value("logLevel", 5).toInt());
+        // an empty logFile keeps logging to stderr
+        auto logFile = sIniSettings.value("logFile").toString();
+        sLogger.startAsync(logFile.isEmpty() ? QString() : QDir(Path::ApplicationDirPath()).absoluteFilePath(logFile),
+            sIniSettings.value("logFileMaxSize", 10485760).toLongLong(), sIniSettings.value("logFileCount", 5).toInt());
 
-        sLogger.debug("The following sqldrivers are available:");
+        LOG_DEBUG("The following sqldrivers are available:");
         auto sqlDrivers = QSqlDatabase::drivers();
         for (auto it = sqlDrivers.begin(); it != sqlDrivers.end(); ++it)
         {
             QString sqlDriverName = *it;
-            sLogger.debug(sqlDriverName);
+            LOG_DEBUG(sqlDriverName);
         }
 
         auto portName = sIniSettings.value("device/portName").toString();
 
         sLogger.info("=== Config ===");
         sLogger.info(QString("device.portName: %1").arg(portName));
+        sLogger.info(QString("device.type: %1").arg(sIniSettings.value("device/type", "gsm19").toString()));
         sLogger.info("==============");
 
         core::RunnerConfig config;
         config.webServerPort = sIniSettings.value("webServer/port", 8000).toInt();
+        config.webServerWorkerThreads = sIniSettings.value("webServer/workerThreads", 4).toInt();
+        config.webServerMaxConnections = sIniSettings.value("webServer/maxConnections", 256).toInt();
+        config.webServerPublicDir = QDir(Path::ApplicationDirPath()).absoluteFilePath(sIniSettings.value("webServer/publicDir", "public").toString());
+        config.webServerStaticMaxAgeSeconds = sIniSettings.value("webServer/staticMaxAgeSeconds", 86400).toInt();
         config.devicePortName = sIniSettings.value("device/portName").toString();
+        config.deviceType = sIniSettings.value("device/type", "gsm19").toString();
+        config.syntheticDevice.rateHz = sIniSettings.value("synthetic/rateHz", config.syntheticDevice.rateHz).toDouble();
+        config.syntheticDevice.field = sIniSettings.value("synthetic/field", config.syntheticDevice.field).toInt();
+        config.syntheticDevice.amplitude = sIniSettings.value("synthetic/amplitude", config.syntheticDevice.amplitude).toInt();
+        config.syntheticDevice.periodSeconds = sIniSettings.value("synthetic/periodSeconds", config.syntheticDevice.periodSeconds).toDouble();
+        config.syntheticDevice.noise = sIniSettings.value("synthetic/noise", config.syntheticDevice.noise).toInt();
+        config.syntheticDevice.invalidShare = sIniSettings.value("synthetic/invalidShare", config.syntheticDevice.invalidShare).toDouble();
+        config.syntheticDevice.gapsPerHour = sIniSettings.value("synthetic/gapsPerHour", config.syntheticDevice.gapsPerHour).toDouble();
+        config.syntheticDevice.gapSeconds = sIniSettings.value("synthetic/gapSeconds", config.syntheticDevice.gapSeconds).toDouble();
+        config.syntheticDevice.seed = sIniSettings.value("synthetic/seed", config.syntheticDevice.seed).toUInt();
         config.msRecordLocation = sIniSettings.value("mseed/location").toString();
         config.msRecordNetwork = sIniSettings.value("mseed/network").toString();
         config.msRecordStation = sIniSettings.value("mseed/station").toString();
         config.msFileName = sIniSettings.value("mseed/fileName").toString();
         config.samplesCacheMaxSize = sIniSettings.value("runner/samplesCacheMaxSize", 100).toInt();
         config.skipDiagnostics = sIniSettings.value("runner/skipDiagnostics", false).toBool();
+        config.historyRetentionDays = sIniSettings.value("history/retentionDays", 7).toInt();
+        config.historyMaxSizeMb = sIniSettings.value("history/maxSizeMb", 256).toInt();
+        config.webLogLevel = sIniSettings.value("webServer/logLevel", 5).toInt();
 
         auto runner = std::make_shared<core::Runner>(config);
         runner->run();
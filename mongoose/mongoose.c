@@ -125,6 +125,12 @@ typedef struct _stati64 ns_stat_t;
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#ifdef NS_ENABLE_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef MONGOOSE_USE_SENDFILE
+#include <sys/sendfile.h>
+#endif
 #define closesocket(x) close(x)
 #ifndef __OS2__
 #define __cdecl
@@ -211,6 +217,9 @@ struct ns_mgr {
   const char *hexdump_file;         // Debug hexdump file path
   sock_t ctl[2];                    // Socketpair for mg_wakeup()
   void *user_data;                  // User data
+#ifdef NS_ENABLE_EPOLL
+  int epoll_fd;                     // Kernel interest set of all sockets
+#endif
 };
 
 
@@ -229,6 +238,10 @@ struct ns_connection {
   void *proto_data;           // Application protocol-specific data
   time_t last_io_time;        // Timestamp of the last socket IO
   ns_callback_t callback;     // Event handler function
+#ifdef NS_ENABLE_EPOLL
+  unsigned int epoll_events;  // Interest registered with epoll_ctl()
+#define NS_EPOLL_REGISTERED         (1u << 31)
+#endif
 
   unsigned int flags;
 #define NSF_FINISHED_SENDING_DATA   (1 << 0)
@@ -240,6 +253,7 @@ struct ns_connection {
 #define NSF_WANT_WRITE              (1 << 6)
 #define NSF_LISTENING               (1 << 7)
 #define NSF_UDP                     (1 << 8)
+#define NSF_WANT_WRITABLE           (1 << 9)  // Poll for POLLOUT with no data
 
 #define NSF_USER_1                  (1 << 20)
 #define NSF_USER_2                  (1 << 21)
@@ -253,6 +267,7 @@ void ns_mgr_init(struct ns_mgr *, void *user_data);
 void ns_mgr_free(struct ns_mgr *);
 time_t ns_mgr_poll(struct ns_mgr *, int milli);
 void ns_broadcast(struct ns_mgr *, ns_callback_t, void *, size_t);
+void ns_wakeup(struct ns_mgr *);
 
 struct ns_connection *ns_next(struct ns_mgr *, struct ns_connection *);
 struct ns_connection *ns_add_sock(struct ns_mgr *, sock_t,
@@ -543,6 +558,13 @@ static void ns_close_conn(struct ns_connection *conn) {
   DBG(("%p %d", conn, conn->flags));
   ns_call(conn, NS_CLOSE, NULL);
   ns_remove_conn(conn);
+#ifdef NS_ENABLE_EPOLL
+  if (conn->epoll_events & NS_EPOLL_REGISTERED) {
+    // A descriptor duplicated by fork() would keep it in the interest set
+    struct epoll_event ev;
+    epoll_ctl(conn->mgr->epoll_fd, EPOLL_CTL_DEL, conn->sock, &ev);
+  }
+#endif
   ns_destroy_conn(conn);
 }
 
@@ -1047,6 +1069,138 @@ static void ns_handle_udp(struct ns_connection *ls) {
   }
 }
 
+static void ns_handle_ctl(struct ns_mgr *mgr) {
+  struct ctl_msg ctl_msg;
+  int len = (int) recv(mgr->ctl[1], (char *) &ctl_msg, sizeof(ctl_msg), 0);
+  // Empty datagrams come from ns_wakeup(), nobody waits for a reply
+  if (len > 0) {
+    send(mgr->ctl[1], ctl_msg.message, 1, 0);
+  }
+  if (len >= (int) sizeof(ctl_msg.callback) && ctl_msg.callback != NULL) {
+    struct ns_connection *c;
+    for (c = ns_next(mgr, NULL); c != NULL; c = ns_next(mgr, c)) {
+      ctl_msg.callback(c, NS_POLL, ctl_msg.message);
+    }
+  }
+}
+
+static void ns_handle_io(struct ns_connection *conn, int readable,
+                         int writable, time_t current_time) {
+  if (readable) {
+    if (conn->flags & NSF_LISTENING) {
+      if (conn->flags & NSF_UDP) {
+        ns_handle_udp(conn);
+      } else {
+        // We're not looping here, and accepting just one connection at
+        // a time. The reason is that eCos does not respect non-blocking
+        // flag on a listening socket and hangs in a loop.
+        accept_conn(conn);
+      }
+    } else {
+      conn->last_io_time = current_time;
+      ns_read_from_socket(conn);
+    }
+  }
+
+  if (writable) {
+    if (conn->flags & NSF_CONNECTING) {
+      ns_read_from_socket(conn);
+    } else if (!(conn->flags & NSF_BUFFER_BUT_DONT_SEND)) {
+      conn->last_io_time = current_time;
+      // NSF_WANT_WRITABLE is a one-shot request, the owner writes itself
+      conn->flags &= ~NSF_WANT_WRITABLE;
+      if (conn->send_iobuf.len > 0) {
+        ns_write_to_socket(conn);
+      }
+    }
+  }
+}
+
+static int ns_wants_write(const struct ns_connection *conn) {
+  return ((conn->flags & NSF_CONNECTING) && !(conn->flags & NSF_WANT_READ)) ||
+    (conn->flags & NSF_WANT_WRITABLE) ||
+    (conn->send_iobuf.len > 0 && !(conn->flags & NSF_CONNECTING) &&
+     !(conn->flags & NSF_BUFFER_BUT_DONT_SEND));
+}
+
+static void ns_close_finished_conns(struct ns_mgr *mgr) {
+  struct ns_connection *conn, *tmp_conn;
+
+  for (conn = mgr->active_connections; conn != NULL; conn = tmp_conn) {
+    tmp_conn = conn->next;
+    if ((conn->flags & NSF_CLOSE_IMMEDIATELY) ||
+        (conn->send_iobuf.len == 0 &&
+          (conn->flags & NSF_FINISHED_SENDING_DATA))) {
+      ns_close_conn(conn);
+    }
+  }
+}
+
+#ifdef NS_ENABLE_EPOLL
+// epoll(7) backend: the interest set lives in the kernel and is only updated
+// when a connection's read/write interest changes, so an iteration costs
+// O(active sockets) instead of O(max descriptor).
+#define NS_EPOLL_MAX_EVENTS 64
+
+static void ns_epoll_update(struct ns_mgr *mgr, struct ns_connection *conn,
+                            unsigned int events) {
+  struct epoll_event ev;
+  if (conn->epoll_events == (events | NS_EPOLL_REGISTERED)) return;
+  ev.events = events;
+  ev.data.ptr = conn;
+  if (epoll_ctl(mgr->epoll_fd, conn->epoll_events & NS_EPOLL_REGISTERED ?
+                EPOLL_CTL_MOD : EPOLL_CTL_ADD, conn->sock, &ev) == 0) {
+    conn->epoll_events = events | NS_EPOLL_REGISTERED;
+  }
+}
+
+time_t ns_mgr_poll(struct ns_mgr *mgr, int milli) {
+  struct ns_connection *conn, *tmp_conn;
+  struct epoll_event events[NS_EPOLL_MAX_EVENTS];
+  time_t current_time = time(NULL);
+  int i, n;
+
+  for (conn = mgr->active_connections; conn != NULL; conn = tmp_conn) {
+    tmp_conn = conn->next;
+    if (!(conn->flags & (NSF_LISTENING | NSF_CONNECTING))) {
+      ns_call(conn, NS_POLL, &current_time);
+    }
+    if (conn->flags & NSF_CLOSE_IMMEDIATELY) {
+      ns_close_conn(conn);
+    } else if (conn->sock != INVALID_SOCKET) {
+      ns_epoll_update(mgr, conn,
+                      (conn->flags & NSF_WANT_WRITE ? 0 : EPOLLIN) |
+                      (ns_wants_write(conn) ? EPOLLOUT : 0));
+    }
+  }
+
+  n = epoll_wait(mgr->epoll_fd, events, NS_EPOLL_MAX_EVENTS, milli);
+  if (n > 0) {
+    // epoll_wait() might have been waiting for a long time, reset
+    // current_time now to prevent last_io_time being set to the past.
+    current_time = time(NULL);
+
+    for (i = 0; i < n; i++) {
+      conn = (struct ns_connection *) events[i].data.ptr;
+      if (conn == NULL) {
+        ns_handle_ctl(mgr);
+      } else {
+        // select() reports errors and hangups as readable and writable
+        ns_handle_io(conn,
+                     (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) &&
+                       (conn->epoll_events & EPOLLIN),
+                     (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) &&
+                       (conn->epoll_events & EPOLLOUT),
+                     current_time);
+      }
+    }
+  }
+
+  ns_close_finished_conns(mgr);
+
+  return current_time;
+}
+#else
 static void ns_add_to_set(sock_t sock, fd_set *set, sock_t *max_fd) {
   if (sock != INVALID_SOCKET) {
     FD_SET(sock, set);
@@ -1079,9 +1233,7 @@ time_t ns_mgr_poll(struct ns_mgr *mgr, int milli) {
         //DBG(("%p read_set", conn));
         ns_add_to_set(conn->sock, &read_set, &max_fd);
       }
-      if (((conn->flags & NSF_CONNECTING) && !(conn->flags & NSF_WANT_READ)) ||
-          (conn->send_iobuf.len > 0 && !(conn->flags & NSF_CONNECTING) &&
-           !(conn->flags & NSF_BUFFER_BUT_DONT_SEND))) {
+      if (ns_wants_write(conn)) {
         //DBG(("%p write_set", conn));
         ns_add_to_set(conn->sock, &write_set, &max_fd);
       }
@@ -1099,57 +1251,21 @@ time_t ns_mgr_poll(struct ns_mgr *mgr, int milli) {
     // Read wakeup messages
     if (mgr->ctl[1] != INVALID_SOCKET &&
         FD_ISSET(mgr->ctl[1], &read_set)) {
-      struct ctl_msg ctl_msg;
-      int len = (int) recv(mgr->ctl[1], (char *) &ctl_msg, sizeof(ctl_msg), 0);
-      send(mgr->ctl[1], ctl_msg.message, 1, 0);
-      if (len >= (int) sizeof(ctl_msg.callback) && ctl_msg.callback != NULL) {
-        struct ns_connection *c;
-        for (c = ns_next(mgr, NULL); c != NULL; c = ns_next(mgr, c)) {
-          ctl_msg.callback(c, NS_POLL, ctl_msg.message);
-        }
-      }
+      ns_handle_ctl(mgr);
     }
 
     for (conn = mgr->active_connections; conn != NULL; conn = tmp_conn) {
       tmp_conn = conn->next;
-      if (FD_ISSET(conn->sock, &read_set)) {
-        if (conn->flags & NSF_LISTENING) {
-          if (conn->flags & NSF_UDP) {
-            ns_handle_udp(conn);
-          } else {
-            // We're not looping here, and accepting just one connection at
-            // a time. The reason is that eCos does not respect non-blocking
-            // flag on a listening socket and hangs in a loop.
-            accept_conn(conn);
-          }
-        } else {
-          conn->last_io_time = current_time;
-          ns_read_from_socket(conn);
-        }
-      }
-
-      if (FD_ISSET(conn->sock, &write_set)) {
-        if (conn->flags & NSF_CONNECTING) {
-          ns_read_from_socket(conn);
-        } else if (!(conn->flags & NSF_BUFFER_BUT_DONT_SEND)) {
-          conn->last_io_time = current_time;
-          ns_write_to_socket(conn);
-        }
-      }
+      ns_handle_io(conn, FD_ISSET(conn->sock, &read_set),
+                   FD_ISSET(conn->sock, &write_set), current_time);
     }
   }
 
-  for (conn = mgr->active_connections; conn != NULL; conn = tmp_conn) {
-    tmp_conn = conn->next;
-    if ((conn->flags & NSF_CLOSE_IMMEDIATELY) ||
-        (conn->send_iobuf.len == 0 &&
-          (conn->flags & NSF_FINISHED_SENDING_DATA))) {
-      ns_close_conn(conn);
-    }
-  }
+  ns_close_finished_conns(mgr);
 
   return current_time;
 }
+#endif  // NS_ENABLE_EPOLL
 
 struct ns_connection *ns_connect(struct ns_mgr *mgr, const char *address,
                                  ns_callback_t callback, void *user_data) {
@@ -1228,6 +1344,14 @@ void ns_broadcast(struct ns_mgr *mgr, ns_callback_t cb,void *data, size_t len) {
   }
 }
 
+// Unlike ns_broadcast(), never blocks: it only makes a pending ns_mgr_poll()
+// return early. Safe to call from any thread.
+void ns_wakeup(struct ns_mgr *mgr) {
+  if (mgr->ctl[0] != INVALID_SOCKET) {
+    send(mgr->ctl[0], "", 0, 0);
+  }
+}
+
 void ns_mgr_init(struct ns_mgr *s, void *user_data) {
   memset(s, 0, sizeof(*s));
   s->ctl[0] = s->ctl[1] = INVALID_SOCKET;
@@ -1247,6 +1371,16 @@ void ns_mgr_init(struct ns_mgr *s, void *user_data) {
   } while (s->ctl[0] == INVALID_SOCKET);
 #endif
 
+#ifdef NS_ENABLE_EPOLL
+  s->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (s->ctl[1] != INVALID_SOCKET) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->ctl[1], &ev);
+  }
+#endif
+
 #ifdef NS_ENABLE_SSL
   {static int init_done; if (!init_done) { SSL_library_init(); init_done++; }}
 #endif
@@ -1268,6 +1402,11 @@ void ns_mgr_free(struct ns_mgr *s) {
     tmp_conn = conn->next;
     ns_close_conn(conn);
   }
+
+#ifdef NS_ENABLE_EPOLL
+  close(s->epoll_fd);
+  s->epoll_fd = -1;
+#endif
 }
 // net_skeleton end
 #endif  // NOEMBED_NET_SKELETON
@@ -1421,6 +1560,7 @@ enum {
   INDEX_FILES,
 #endif
   LISTENING_PORT,
+  MAX_CONNECTIONS,
 #ifndef _WIN32
   RUN_AS_USER,
 #endif
@@ -1460,6 +1600,7 @@ static const char *static_config_options[] = {
   "index_files","index.html,index.htm,index.shtml,index.cgi,index.php",
 #endif
   "listening_port", NULL,
+  "max_connections", NULL,
 #ifndef _WIN32
   "run_as_user", NULL,
 #endif
@@ -1565,6 +1706,11 @@ static const struct {
   {".avi", 4, "video/x-msvideo"},
   {".bmp", 4, "image/bmp"},
   {".ttf", 4, "application/x-font-ttf"},
+  {".otf", 4, "font/opentype"},
+  {".eot", 4, "application/vnd.ms-fontobject"},
+  {".woff", 5, "application/font-woff"},
+  {".woff2", 6, "font/woff2"},
+  {".map", 4, "application/json"},
   {NULL,  0, NULL}
 };
 
@@ -3381,6 +3527,12 @@ void mg_send_file_data(struct mg_connection *c, int fd) {
   conn->endpoint.fd = fd;
   ns_set_close_on_exec(conn->endpoint.fd);
 }
+
+void mg_send_file_range(struct mg_connection *c, int fd, long long length) {
+  struct connection *conn = MG_CONN_2_CONN(c);
+  mg_send_file_data(c, fd);
+  conn->cl = length;
+}
 #endif  // MONGOOSE_NO_FILESYSTEM
 
 static void call_request_handler_if_data_is_buffered(struct connection *conn) {
@@ -4899,7 +5051,8 @@ static void close_local_endpoint(struct connection *conn) {
   conn->cl = conn->num_bytes_recv = conn->request_len = 0;
   conn->ns_conn->flags &= ~(NSF_FINISHED_SENDING_DATA |
                             NSF_BUFFER_BUT_DONT_SEND | NSF_CLOSE_IMMEDIATELY |
-                            MG_HEADERS_SENT | MG_USING_CHUNKED_API);
+                            MG_HEADERS_SENT | MG_USING_CHUNKED_API |
+                            NSF_WANT_WRITABLE);
 
   // Do not memset() the whole structure, as some of the fields
   // (IP addresses & ports, server_param) must survive. Nullify the rest.
@@ -4919,6 +5072,37 @@ static void transfer_file_data(struct connection *conn) {
   char buf[IOBUF_SIZE];
   size_t n;
 
+#ifdef MONGOOSE_USE_SENDFILE
+#ifdef NS_ENABLE_SSL
+  if (conn->ns_conn->ssl == NULL)
+#endif
+  {
+    ssize_t sent;
+
+    // Headers and other buffered data go first
+    if (conn->ns_conn->send_iobuf.len > 0) return;
+
+    sent = sendfile(conn->ns_conn->sock, conn->endpoint.fd, NULL,
+                    conn->cl < (int64_t) (1024 * 1024) ?
+                    (size_t) conn->cl : (size_t) (1024 * 1024));
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // Come back when the socket is writable again
+      conn->ns_conn->flags |= NSF_WANT_WRITABLE;
+    } else if (sent <= 0) {
+      close_local_endpoint(conn);
+      conn->ns_conn->flags |= NSF_CLOSE_IMMEDIATELY;
+    } else {
+      conn->cl -= sent;
+      conn->ns_conn->last_io_time = time(NULL);
+      conn->ns_conn->flags |= NSF_WANT_WRITABLE;
+      if (conn->cl <= 0) {
+        close_local_endpoint(conn);
+      }
+    }
+    return;
+  }
+#endif
+
   // If output buffer is too big, don't send anything. Wait until
   // mongoose drains already buffered data to the client.
   if (conn->ns_conn->send_iobuf.len > sizeof(buf) * 2) return;
@@ -5198,11 +5382,29 @@ static void set_ips(struct ns_connection *nc, int is_rem) {
   //DBG(("%p %s %s", conn, is_rem ? "rem" : "loc", buf));
 }
 
+static int count_accepted_connections(struct mg_server *server) {
+  struct ns_connection *nc;
+  int count = 0;
+  for (nc = ns_next(&server->ns_mgr, NULL); nc != NULL;
+       nc = ns_next(&server->ns_mgr, nc)) {
+    if (nc->listener != NULL && nc->user_data != NULL) count++;
+  }
+  return count;
+}
+
 static void on_accept(struct ns_connection *nc, union socket_address *sa) {
   struct mg_server *server = (struct mg_server *) nc->mgr;
+  const char *max_connections = server->config_options[MAX_CONNECTIONS];
   struct connection *conn;
 
-  if (!check_acl(server->config_options[ACCESS_CONTROL_LIST],
+  if (max_connections != NULL &&
+      count_accepted_connections(server) >= atoi(max_connections)) {
+    // Best effort: the reply fits into the socket buffer of a new connection
+    static const char reply[] = "HTTP/1.1 503 Service Unavailable\r\n"
+      "Retry-After: 1\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    send(nc->sock, reply, sizeof(reply) - 1, 0);
+    nc->flags |= NSF_CLOSE_IMMEDIATELY;
+  } else if (!check_acl(server->config_options[ACCESS_CONTROL_LIST],
                  ntohl(* (uint32_t *) &sa->sin.sin_addr)) ||
       (conn = (struct connection *) NS_CALLOC(1, sizeof(*conn))) == NULL) {
     nc->flags |= NSF_CLOSE_IMMEDIATELY;
@@ -5389,6 +5591,18 @@ void mg_wakeup_server(struct mg_server *server) {
   ns_broadcast(&server->ns_mgr, NULL, (void *) "", 0);
 }
 
+void mg_wakeup_server_async(struct mg_server *server) {
+  ns_wakeup(&server->ns_mgr);
+}
+
+void mg_close_connection(struct mg_connection *c) {
+  MG_CONN_2_CONN(c)->ns_conn->flags |= NSF_CLOSE_IMMEDIATELY;
+}
+
+void *mg_get_server_param(struct mg_server *server) {
+  return server->ns_mgr.user_data;
+}
+
 const char *mg_get_option(const struct mg_server *server, const char *name) {
   const char **opts = (const char **) server->config_options;
   int i = get_option_index(name);
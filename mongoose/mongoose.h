@@ -96,6 +96,8 @@ void mg_copy_listeners(struct mg_server *from, struct mg_server *to);
 struct mg_connection *mg_next(struct mg_server *, struct mg_connection *);
 void mg_wakeup_server(struct mg_server *);
 void mg_wakeup_server_ex(struct mg_server *, mg_handler_t, const char *, ...);
+void mg_wakeup_server_async(struct mg_server *);  // Does not wait for ack
+void *mg_get_server_param(struct mg_server *);
 struct mg_connection *mg_connect(struct mg_server *, const char *);
 
 // Connection management functions
@@ -113,6 +115,8 @@ size_t mg_websocket_printf(struct mg_connection* conn, int opcode,
 
 void mg_send_file(struct mg_connection *, const char *path, const char *);
 void mg_send_file_data(struct mg_connection *, int fd);
+void mg_send_file_range(struct mg_connection *, int fd, long long length);
+void mg_close_connection(struct mg_connection *);  // Closed on the next poll
 
 const char *mg_get_header(const struct mg_connection *, const char *name);
 const char *mg_get_mime_type(const char *name, const char *default_mime_type);
@@ -69,10 +69,16 @@
                 }
             }
         });
+        grunt.registerTask('development', [ 'sass', 'postcss' ]);
+        grunt.registerTask('production', [ 'requirejs', 'sass', 'postcss', 'index' ]);
+        // public/index.html for gemlogd, which serves the compiled application without Node
+        grunt.registerTask('index', function () {
+            var handlebars = require('hbs').handlebars;
+            var template = handlebars.compile(grunt.file.read('./views/index.hbs'));
+            grunt.file.write('./public/index.html', template({ compiled: true }));
+        });
 
         grunt.registerTask('update', [ 'bower' ]);
-        grunt.registerTask('development', [ 'sass', 'postcss' ]);
-        grunt.registerTask('production', [ 'requirejs', 'sass', 'postcss' ]);
 
         grunt.registerTask('default', [ 'watch' ]);
     };
@@ -18,7 +18,9 @@ define([
     'use strict';
 
     var config = {
-        UPDATER_INTERVAL: 1500
+        UPDATER_INTERVAL: 1500,
+        COMMAND_WAIT_MS: 10000,
+        LOG_MAX_SIZE: 1000
     };
 
     return Marionette.Controller.extend({
@@ -131,9 +133,24 @@ define([
         },
 
         __updateDiagnosticsLog: function () {
-            return core.services.AjaxService.get('api/dashboard/eb-device/log').then(function (data) {
+            var url = 'api/dashboard/eb-device/log';
+            if (this.logCursor !== undefined) {
+                url += '?sinceId=' + this.logCursor;
+            }
+            return core.services.AjaxService.get(url).then(function (data) {
+                var logList = this.diagnosticsModel.get('logList');
                 //noinspection JSUnresolvedVariable
-                this.diagnosticsModel.get('logList').reset(data.messages);
+                if (this.logCursor === undefined || data.lastId < this.logCursor) {
+                    // first request or the device has been restarted
+                    logList.reset(data.messages);
+                } else if (data.messages.length > 0) {
+                    logList.add(data.messages);
+                    while (logList.length > config.LOG_MAX_SIZE) {
+                        logList.shift();
+                    }
+                }
+                //noinspection JSUnresolvedVariable
+                this.logCursor = data.lastId;
             }.bind(this));
         },
 
@@ -203,7 +220,19 @@ define([
         __sendCommand: function (data) {
             this.commandSendLock = true;
             this.view.setEnabled(false);
-            return core.services.AjaxService.post('api/dashboard/eb-device/command', data);
+            // the device answers once the command has finished, so the status is refreshed right away instead of
+            // waiting for the command queue to drain
+            var url = 'api/dashboard/eb-device/command?wait=' + config.COMMAND_WAIT_MS;
+            return core.services.AjaxService.post(url, data).then(function (result) {
+                return this.__updateStatus().then(function () {
+                    var finished = result.result === 'completed' || result.result === 'failed';
+                    if (!this.isDestroyed && finished && this.model.get('commandQueueSize') === 0) {
+                        this.commandSendLock = false;
+                        this.view.setEnabled(true);
+                    }
+                    return result;
+                }.bind(this));
+            }.bind(this));
         }
     });
 });
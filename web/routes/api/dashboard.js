@@ -29,6 +29,7 @@ router.get('/eb-device/status', function(req, res) {
 router.get('/eb-device/log', function(req, res) {
     request.get({
         url: appConfig.ebDeviceUrl + '/api/log',
+        qs: req.query,
         json: true,
         timeout: 50000
     }, function (error, response, body) {
@@ -44,6 +45,56 @@ router.get('/eb-device/log', function(req, res) {
 router.get('/eb-device/data', function(req, res) {
     request.get({
         url: appConfig.ebDeviceUrl + '/api/data',
+        qs: req.query,
+        json: true,
+        timeout: 50000
+    }, function (error, response, body) {
+        if (!error && response.statusCode === 200) {
+            res.json(body);
+        } else {
+            res.status(500);
+            res.send('Device has failed to process the data.');
+        }
+    });
+});
+
+router.get('/eb-device/data/binary', function(req, res) {
+    request.get({
+        url: appConfig.ebDeviceUrl + '/api/data/binary',
+        qs: req.query,
+        encoding: null,
+        timeout: 50000
+    }, function (error, response, body) {
+        if (!error && response.statusCode === 200) {
+            res.type('application/octet-stream');
+            res.send(body);
+        } else {
+            res.status(500);
+            res.send('Device has failed to process the data.');
+        }
+    });
+});
+
+router.get('/eb-device/history', function(req, res) {
+    request.get({
+        url: appConfig.ebDeviceUrl + '/api/history',
+        qs: req.query,
+        json: true,
+        timeout: 50000
+    }, function (error, response, body) {
+        if (!error && response.statusCode === 200) {
+            res.json(body);
+        } else {
+            res.status(500);
+            res.send('Device has failed to process the data.');
+        }
+    });
+});
+
+router.get('/eb-device/aggregates', function(req, res) {
+    request.get({
+        url: appConfig.ebDeviceUrl + '/api/aggregates',
+        qs: req.query,
         json: true,
         timeout: 50000
     }, function (error, response, body) {
@@ -58,13 +109,14 @@ router.get('/eb-device/data', function(req, res) {
 
 router.post('/eb-device/command', function (req, res) {
     request.post({
-        url: appConfig.ebDeviceUrl + '/api/command',
+        url: appConfig.ebDeviceUrl + '/api/command' + (req.query.wait ? '?wait=' + Number(req.query.wait) : ''),
         json: true,
         body: req.body,
         timeout: 50000
     }, function (error, response, body) {
-        if (!error && response.statusCode === 200) {
-            res.json(body);
+        // 202: other requests are waiting for commands already, this one is queued without waiting
+        if (!error && (response.statusCode === 200 || response.statusCode === 202)) {
+            res.status(response.statusCode).json(body);
         } else {
             res.status(500);
             res.send('Device has failed to process the data.');